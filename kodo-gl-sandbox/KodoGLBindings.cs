@@ -3,6 +3,7 @@ using System.Collections.Generic;
 using System.Diagnostics;
 using System.Runtime.InteropServices;
 using System.Security;
+using System.Text;
 
 namespace kodo_gl_sandbox
 {
@@ -172,12 +173,366 @@ namespace kodo_gl_sandbox
         }
     }
 
+    class TextureBrush : Brush
+    {
+        public TextureBrush(Texture texture)
+        {
+            handle = KodoGLBindings.KodoGLBrushCreateTexture((IntPtr)texture);
+        }
+    }
+
+    class TextureMaskBrush : Brush
+    {
+        public TextureMaskBrush(Texture mask, Color color)
+        {
+            handle = KodoGLBindings.KodoGLBrushCreateTextureMask((IntPtr)mask, color);
+        }
+    }
+
     public class Texture
     {
+        readonly IntPtr handle;
+
+        public static explicit operator IntPtr(Texture texture)
+            => texture.handle;
+
         public Texture(string filename, bool opacityOnly)
         {
-            KodoGLBindings.KodoGLTextureCreate(filename, opacityOnly);
+            handle = KodoGLBindings.KodoGLTextureCreate(filename, opacityOnly);
+        }
+
+        /// <summary>
+        /// Creates a texture from a PNG image in memory, e.g. an embedded resource or part of a mapped pack.
+        /// </summary>
+        public Texture(byte[] png, bool opacityOnly)
+        {
+            handle = KodoGLBindings.KodoGLTextureCreateFromMemory(png, png.Length, opacityOnly);
+        }
+
+        public Texture(IntPtr png, int size, bool opacityOnly)
+        {
+            handle = KodoGLBindings.KodoGLTextureCreateFromMemory(png, size, opacityOnly);
         }
+
+        Texture(IntPtr handle)
+        {
+            this.handle = handle;
+        }
+
+        /// <summary>
+        /// Whether the texture was created; one that can't be decoded is reported through the error callback and isn't.
+        /// </summary>
+        public bool IsValid
+            => KodoGLBindings.KodoGLIsValid(handle);
+
+        /// <summary>
+        /// Block compresses textures created from now on, caching the results in a directory.
+        /// An empty directory compresses without caching; null turns compression off.
+        /// </summary>
+        public static void SetCompression(string cacheDirectory)
+            => KodoGLBindings.KodoGLTextureSetCompression(cacheDirectory);
+
+        /// <summary>
+        /// Limits the GPU memory used by textures; the least recently drawn are evicted and reloaded when drawn again.
+        /// </summary>
+        /// <param name="bytes">Budget in bytes, 0 for no limit.</param>
+        public static void SetBudget(long bytes)
+            => KodoGLBindings.KodoGLTextureSetBudget(bytes);
+
+        public static long ResidentSize
+            => KodoGLBindings.KodoGLTextureGetResidentSize();
+
+        /// <summary>
+        /// Starts loading a texture in the background. It is drawn as a placeholder until <see cref="IsReady"/>.
+        /// Null if the load can't be queued.
+        /// </summary>
+        public static Texture CreateAsync(string filename, bool opacityOnly)
+        {
+            var texture = KodoGLBindings.KodoGLTextureCreateAsync(filename, opacityOnly);
+            return texture != IntPtr.Zero ? new Texture(texture) : null;
+        }
+
+        public bool IsReady
+            => KodoGLBindings.KodoGLTextureIsReady(handle) > 0;
+
+        public bool IsFailed
+            => KodoGLBindings.KodoGLTextureIsReady(handle) < 0;
+
+        /// <summary>
+        /// Destroys the texture. Brushes using it must not be drawn afterwards.
+        /// </summary>
+        public void Destroy()
+            => KodoGLBindings.KodoGLTextureDestroy(handle);
+    }
+
+    /// <summary>
+    /// The cache of laid out text, which lets labels drawn every frame be laid out once.
+    /// </summary>
+    static class TextCache
+    {
+        /// <summary>
+        /// Limits the number of laid out runs kept; those drawn least recently are dropped.
+        /// </summary>
+        public static void SetCapacity(int runs)
+            => KodoGLBindings.KodoGLTextCacheSetCapacity(runs);
+
+        public static long Hits
+            => KodoGLBindings.KodoGLTextCacheGetHits();
+
+        public static long Misses
+            => KodoGLBindings.KodoGLTextCacheGetMisses();
+    }
+
+    /// <summary>
+    /// Alignment of text within its bounds, one horizontal and one vertical value combined.
+    /// </summary>
+    [Flags]
+    public enum TextAlignment : int
+    {
+        Left = 0,
+        Center = 1,
+        Right = 2,
+        Top = 0,
+        Middle = 4,
+        Bottom = 8
+    }
+
+    public enum NumberFormat : int
+    {
+        /// <summary>Digits after the decimal mark, e.g. 1234.50.</summary>
+        Fixed = 0,
+        /// <summary>One digit before the decimal mark and an exponent, e.g. 1.23e+03.</summary>
+        Scientific = 1,
+        /// <summary>One to three digits before the decimal mark and an exponent that is a multiple of three, e.g. 12.3e-06.</summary>
+        Engineering = 2
+    }
+
+    /// <summary>
+    /// A font within a <see cref="FontAtlas"/>.
+    /// </summary>
+    class Font
+    {
+        readonly IntPtr handle;
+
+        public static explicit operator IntPtr(Font font)
+            => font.handle;
+
+        internal Font(IntPtr handle)
+        {
+            this.handle = handle;
+        }
+    }
+
+    /// <summary>
+    /// The glyphs of fonts, rasterized into the pages of a texture as they're drawn.
+    /// </summary>
+    class FontAtlas
+    {
+        readonly IntPtr handle;
+
+        internal FontAtlas(IntPtr handle)
+        {
+            this.handle = handle;
+        }
+
+        /// <summary>
+        /// Gets a font by the name <see cref="FontAtlasLoader.Load"/> returned for it. Null if the atlas has no such font.
+        /// </summary>
+        public Font GetFont(int name)
+        {
+            var font = KodoGLBindings.KodoGLAtlasGetFont(handle, name);
+            return font != IntPtr.Zero ? new Font(font) : null;
+        }
+
+        /// <summary>
+        /// Limits the memory used by the pages of the atlas; those drawn least recently are cleared.
+        /// </summary>
+        /// <param name="bytes">Budget in bytes, 0 for no limit.</param>
+        public void SetBudget(long bytes)
+            => KodoGLBindings.KodoGLAtlasSetBudget(handle, bytes);
+    }
+
+    /// <summary>
+    /// Loads fonts into a new <see cref="FontAtlas"/>.
+    /// </summary>
+    class FontAtlasLoader
+    {
+        readonly IntPtr handle;
+
+        /// <summary>
+        /// Creates a loader of an atlas with pages of the specified size.
+        /// </summary>
+        /// <param name="cacheDirectory">Directory the rasterized atlas is cached in, null for none.</param>
+        public FontAtlasLoader(int width, int height, string cacheDirectory = null)
+        {
+            handle = KodoGLBindings.KodoGLAtlasLoaderCreate(width, height, cacheDirectory);
+        }
+
+        /// <summary>
+        /// Loads a font, returning its name within the atlas, or -1 if it can't be loaded.
+        /// </summary>
+        /// <param name="filename">Font file, null for the embedded Patua One.</param>
+        /// <param name="size">Size in pixels.</param>
+        /// <param name="charset">Characters rasterized up front; others are rasterized when first drawn.</param>
+        /// <param name="distanceField">Whether to rasterize signed distance fields, sharp at any size.</param>
+        public int Load(string filename, float size, string charset = null, bool distanceField = false)
+            => KodoGLBindings.KodoGLAtlasLoaderLoadFont(handle, filename, size, charset != null ? Encoding.UTF8.GetBytes(charset + "\0") : null, distanceField);
+
+        /// <summary>
+        /// Finishes the atlas; the loader can't be used afterwards.
+        /// </summary>
+        public FontAtlas Finish()
+        {
+            var atlas = KodoGLBindings.KodoGLAtlasLoaderFinish(handle);
+            return atlas != IntPtr.Zero ? new FontAtlas(atlas) : null;
+        }
+    }
+
+    class Series
+    {
+        readonly IntPtr handle;
+
+        public static explicit operator IntPtr(Series s)
+            => s.handle;
+
+        /// <summary>
+        /// Creates a new <see cref="Series"/> from a copy of the values.
+        /// </summary>
+        /// <param name="values">Values.</param>
+        public Series(float[] values)
+        {
+            handle = KodoGLBindings.KodoGLSeriesCreate(values, values.Length);
+        }
+
+        /// <summary>
+        /// Replaces the values of the <see cref="Series"/>.
+        /// </summary>
+        /// <param name="values">Values.</param>
+        public void Update(float[] values)
+        {
+            KodoGLBindings.KodoGLSeriesUpdate(handle, values, values.Length);
+        }
+    }
+
+    /// <summary>
+    /// A view of a UTF-8 text file too large to lay out, e.g. a log. Its lines are indexed in the background, and only those drawn are laid out.
+    /// </summary>
+    class TextView
+    {
+        readonly IntPtr handle;
+
+        public static explicit operator IntPtr(TextView view)
+            => view.handle;
+
+        TextView(IntPtr handle)
+        {
+            this.handle = handle;
+        }
+
+        /// <summary>
+        /// Opens a file in a <see cref="TextView"/>. Null if the file can't be opened, or is empty.
+        /// </summary>
+        /// <param name="filename">Filename.</param>
+        /// <param name="font">Font.</param>
+        /// <param name="size">Size to draw the text at, 0 for the size of the font.</param>
+        public static TextView Open(string filename, Font font, float size = 0)
+        {
+            var view = KodoGLBindings.KodoGLTextViewCreate(filename, (IntPtr)font, size);
+            return view != IntPtr.Zero ? new TextView(view) : null;
+        }
+
+        /// <summary>
+        /// Number of lines indexed so far, all of them once <see cref="IsIndexed"/>.
+        /// </summary>
+        public long CountOfLines
+            => KodoGLBindings.KodoGLTextViewCountOfLines(handle);
+
+        public bool IsIndexed
+            => KodoGLBindings.KodoGLTextViewIndexed(handle) > 0;
+
+        public float LineHeight
+            => KodoGLBindings.KodoGLTextViewLineHeight(handle);
+
+        /// <summary>
+        /// Closes the file. The view must not be drawn afterwards.
+        /// </summary>
+        public void Close()
+            => KodoGLBindings.KodoGLTextViewDestroy(handle);
+    }
+
+    /// <summary>
+    /// The glyphs numbers are drawn with in a <see cref="Font"/>, so numbers that change every frame, like axis labels and readouts,
+    /// are drawn without strings or text layout.
+    /// </summary>
+    class NumberGlyphs
+    {
+        readonly IntPtr handle;
+
+        public static explicit operator IntPtr(NumberGlyphs glyphs)
+            => glyphs.handle;
+
+        public NumberGlyphs(Font font)
+        {
+            handle = KodoGLBindings.KodoGLNumberGlyphsCreate((IntPtr)font);
+        }
+
+        /// <summary>
+        /// Releases the glyphs. They must not be drawn afterwards.
+        /// </summary>
+        public void Destroy()
+            => KodoGLBindings.KodoGLNumberGlyphsDestroy(handle);
+    }
+
+    /// <summary>
+    /// Text laid out line by line for editing, e.g. an editor or a log. An edit lays out only the lines it changes,
+    /// and a frame uploads only the glyphs edited since the last one. Columns are in UTF-16 code units.
+    /// </summary>
+    class LineLayout
+    {
+        readonly IntPtr handle;
+
+        public static explicit operator IntPtr(LineLayout layout)
+            => layout.handle;
+
+        /// <summary>
+        /// Lays out text, the pen starting at (<paramref name="x"/>, <paramref name="y"/>) within the area it's drawn in.
+        /// </summary>
+        /// <param name="font">Font.</param>
+        /// <param name="text">Text, its lines separated by line feeds.</param>
+        /// <param name="x">Left of the lines.</param>
+        /// <param name="y">Baseline of the first line.</param>
+        /// <param name="size">Size to draw the text at, 0 for the size of the font.</param>
+        public LineLayout(Font font, string text, float x, float y, float size = 0)
+        {
+            handle = KodoGLBindings.KodoGLLineLayoutCreate((IntPtr)font, text, text.Length, x, y, size);
+        }
+
+        public int CountOfLines
+            => KodoGLBindings.KodoGLLineLayoutCountOfLines(handle);
+
+        /// <summary>
+        /// Inserts text at a column of a line; line feeds in the text split the line.
+        /// </summary>
+        public void Insert(int line, int column, string text)
+            => KodoGLBindings.KodoGLLineLayoutInsert(handle, line, column, text, text.Length);
+
+        /// <summary>
+        /// Appends text to the end of the last line.
+        /// </summary>
+        public void Append(string text)
+            => KodoGLBindings.KodoGLLineLayoutAppend(handle, text, text.Length);
+
+        /// <summary>
+        /// Erases the text from a column of a line up to one of the same or a later line, joining the lines.
+        /// </summary>
+        public void Erase(int line, int column, int endLine, int endColumn)
+            => KodoGLBindings.KodoGLLineLayoutErase(handle, line, column, endLine, endColumn);
+
+        /// <summary>
+        /// Releases the layout. It must not be drawn afterwards.
+        /// </summary>
+        public void Destroy()
+            => KodoGLBindings.KodoGLLineLayoutDestroy(handle);
     }
 
     [Flags]
@@ -287,6 +642,149 @@ namespace kodo_gl_sandbox
 
         public void DrawQuads(Rectangle[] quads, Brush brush)
             => KodoGLBindings.KodoGLDrawingContextDrawQuads(handle, Marshal.UnsafeAddrOfPinnedArrayElement(quads, 0), quads.Length, (IntPtr)brush);
+
+        /// <summary>
+        /// Draws a joined line strip through the points, stored as interleaved x, y pairs.
+        /// </summary>
+        /// <param name="points">Points (x0, y0, x1, y1, ...).</param>
+        /// <param name="width">Width of the line.</param>
+        /// <param name="brush">Brush.</param>
+        public void DrawLineStrip(float[] points, float width, Brush brush)
+            => KodoGLBindings.KodoGLDrawingContextDrawLineStrip(handle, Marshal.UnsafeAddrOfPinnedArrayElement(points, 0), points.Length / 2, width, (IntPtr)brush);
+
+        /// <summary>
+        /// Draws the values of a <see cref="Series"/> within range as a line, decimated to the pixels of the area.
+        /// </summary>
+        /// <param name="series">Series.</param>
+        /// <param name="range">Range, horizontally in value indices and vertically in values.</param>
+        /// <param name="width">Width of the line.</param>
+        /// <param name="brush">Brush.</param>
+        public void DrawSeries(Series series, Rectangle range, float width, Brush brush)
+            => DrawSeries(series, range.Left, range.Right, range.Top, range.Bottom, width, brush);
+
+        /// <summary>
+        /// Draws the values of a <see cref="Series"/> within range as a line, decimated to the pixels of the area.
+        /// The horizontal range is in double, so indices of long series stay apart.
+        /// </summary>
+        /// <param name="series">Series.</param>
+        /// <param name="xFrom">First value index of the range.</param>
+        /// <param name="xTo">Last value index of the range.</param>
+        /// <param name="yFrom">Value at the bottom of the area.</param>
+        /// <param name="yTo">Value at the top of the area.</param>
+        /// <param name="width">Width of the line.</param>
+        /// <param name="brush">Brush.</param>
+        public void DrawSeries(Series series, double xFrom, double xTo, float yFrom, float yTo, float width, Brush brush)
+            => KodoGLBindings.KodoGLDrawingContextDrawSeries(handle, (IntPtr)series, xFrom, xTo, yFrom, yTo, width, (IntPtr)brush);
+
+        /// <summary>
+        /// Draws the lines of a <see cref="TextView"/> within the area, which shows the text from a scroll position on.
+        /// </summary>
+        /// <param name="view">Text view.</param>
+        /// <param name="scrollX">Pixels scrolled to the right.</param>
+        /// <param name="scrollY">Pixels scrolled down, <see cref="TextView.LineHeight"/> per line.</param>
+        /// <param name="brush">Brush.</param>
+        public void DrawTextView(TextView view, double scrollX, double scrollY, Brush brush)
+            => KodoGLBindings.KodoGLDrawingContextDrawTextView(handle, (IntPtr)view, scrollX, scrollY, (IntPtr)brush);
+
+        /// <summary>
+        /// Draws a number within bounds with the color of a brush, formatted and laid out without strings.
+        /// </summary>
+        /// <param name="glyphs">Glyphs of the font to draw the number with.</param>
+        /// <param name="value">Value.</param>
+        /// <param name="format">Format.</param>
+        /// <param name="precision">Digits after the decimal mark, up to 15.</param>
+        /// <param name="bounds">Bounds, relative to the area.</param>
+        /// <param name="alignment">Alignment within the bounds.</param>
+        /// <param name="brush">Brush.</param>
+        /// <param name="size">Size to draw the number at, 0 for the size of the font.</param>
+        /// <param name="decimalMark">Decimal mark, '.' or ','; others are reported and the number isn't drawn.</param>
+        public void DrawNumber(NumberGlyphs glyphs, double value, NumberFormat format, int precision, Rectangle bounds, TextAlignment alignment, Brush brush, float size = 0, char decimalMark = '.')
+            => KodoGLBindings.KodoGLDrawingContextDrawNumber(handle, (IntPtr)glyphs, value, format, precision, decimalMark, bounds, alignment, size, (IntPtr)brush);
+
+        /// <summary>
+        /// Draws a whole number within bounds with all its digits, e.g. a count or an index.
+        /// </summary>
+        /// <param name="glyphs">Glyphs of the font to draw the number with.</param>
+        /// <param name="value">Number.</param>
+        /// <param name="bounds">Bounds, relative to the area.</param>
+        /// <param name="alignment">Alignment within the bounds.</param>
+        /// <param name="brush">Brush.</param>
+        /// <param name="size">Size to draw the number at, 0 for the size of the font.</param>
+        public void DrawNumber(NumberGlyphs glyphs, long value, Rectangle bounds, TextAlignment alignment, Brush brush, float size = 0)
+            => KodoGLBindings.KodoGLDrawingContextDrawInteger(handle, (IntPtr)glyphs, value, bounds, alignment, size, (IntPtr)brush);
+
+        /// <summary>
+        /// Draws a <see cref="LineLayout"/> at its position within the area. A gradient brush lends a single color.
+        /// </summary>
+        /// <param name="layout">Line layout.</param>
+        /// <param name="brush">Brush.</param>
+        public void DrawLineLayout(LineLayout layout, Brush brush)
+            => KodoGLBindings.KodoGLDrawingContextDrawLineLayout(handle, (IntPtr)layout, (IntPtr)brush);
+
+        /// <summary>
+        /// Maps a native region for <paramref name="quadsLength"/> quads, which are drawn with <paramref name="brush"/> on <see cref="CommitQuads"/>.
+        /// Returns <see cref="IntPtr.Zero"/> when <paramref name="quadsLength"/> isn't positive, or when a region is mapped and not committed yet.
+        /// </summary>
+        /// <param name="quadsLength">Number of quads to be written.</param>
+        /// <param name="brush">Brush.</param>
+        public IntPtr MapQuads(int quadsLength, Brush brush)
+            => KodoGLBindings.KodoGLDrawingContextMapQuads(handle, quadsLength, (IntPtr)brush);
+
+        /// <summary>
+        /// Draws the quads written to the region returned by <see cref="MapQuads"/>.
+        /// </summary>
+        public void CommitQuads()
+            => KodoGLBindings.KodoGLDrawingContextCommitQuads(handle);
+
+        /// <summary>
+        /// Draws text within bounds with the color of a brush. Text drawn again is not laid out again.
+        /// </summary>
+        /// <param name="font">Font.</param>
+        /// <param name="text">Text.</param>
+        /// <param name="bounds">Bounds, relative to the area.</param>
+        /// <param name="alignment">Alignment within the bounds.</param>
+        /// <param name="brush">Brush.</param>
+        public void DrawText(Font font, string text, Rectangle bounds, TextAlignment alignment, Brush brush)
+            => KodoGLBindings.KodoGLDrawingContextDrawText(handle, (IntPtr)font, text, text.Length, bounds, alignment, (IntPtr)brush);
+
+        /// <summary>
+        /// Draws texts at once, each within its bounds.
+        /// </summary>
+        /// <param name="font">Font.</param>
+        /// <param name="texts">The texts, one after another.</param>
+        /// <param name="lengths">Length of each text.</param>
+        /// <param name="bounds">Bounds of each text, relative to the area.</param>
+        /// <param name="alignment">Alignment within the bounds.</param>
+        /// <param name="brush">Brush.</param>
+        public void DrawTexts(Font font, string texts, int[] lengths, Rectangle[] bounds, TextAlignment alignment, Brush brush)
+        {
+            Debug.Assert(lengths.Length == bounds.Length, "Each text must have bounds");
+
+            KodoGLBindings.KodoGLDrawingContextDrawTexts(handle, (IntPtr)font, texts, lengths, bounds, lengths.Length, alignment, (IntPtr)brush);
+        }
+    }
+
+    /// <summary>
+    /// Benchmarks of the native library, run by the sandbox with --bench.
+    /// </summary>
+    static class Benchmarks
+    {
+        /// <summary>
+        /// Packs glyphs of random sizes, 4-24 by 6-30 pixels, into a square atlas page, tallest first when sorted.
+        /// Returns the number of glyphs packed, or -1 on failure.
+        /// </summary>
+        /// <param name="seconds">Time taken to pack.</param>
+        /// <param name="efficiency">Area of the packed glyphs over the area of the page below the highest of them.</param>
+        /// <param name="mostNodes">Nodes of the skyline at most.</param>
+        public static int Packing(int countOfGlyphs, int sizeOfPage, bool sortedByHeight, out double seconds, out double efficiency, out int mostNodes)
+            => KodoGLBindings.KodoGLBenchmarkPacking(countOfGlyphs, sizeOfPage, sortedByHeight ? 1 : 0, out seconds, out efficiency, out mostNodes);
+
+        /// <summary>
+        /// Converts an image of random pixels with 1 to 4 channels to its opacity or to RGBA, as textures are loaded.
+        /// Returns the seconds per image on average, or -1 on failure.
+        /// </summary>
+        public static double Conversion(int width, int height, int channels, bool onlyOpacity, int repeats)
+            => KodoGLBindings.KodoGLBenchmarkConversion(width, height, channels, onlyOpacity ? 1 : 0, repeats);
     }
 
     [SuppressUnmanagedCodeSecurity]
@@ -395,6 +893,38 @@ namespace kodo_gl_sandbox
         [DllImport(KodoGL, CallingConvention = KodoGLConvention)]
         public static extern void KodoGLDrawingContextDrawQuads(IntPtr context, IntPtr quads, int quadsLength, IntPtr brush);
 
+        [DllImport(KodoGL, CallingConvention = KodoGLConvention)]
+        public static extern void KodoGLDrawingContextDrawLineStrip(IntPtr context, IntPtr points, int pointsLength, float width, IntPtr brush);
+
+        [DllImport(KodoGL, CallingConvention = KodoGLConvention)]
+        public static extern void KodoGLDrawingContextDrawSeries(IntPtr context, IntPtr series, double xFrom, double xTo, float yFrom, float yTo, float width, IntPtr brush);
+
+        [DllImport(KodoGL, CallingConvention = KodoGLConvention)]
+        public static extern void KodoGLDrawingContextDrawTextView(IntPtr context, IntPtr view, double scrollX, double scrollY, IntPtr brush);
+
+        // The decimal mark is passed as a UTF-16 code unit.
+        [DllImport(KodoGL, CallingConvention = KodoGLConvention, CharSet = CharSet.Unicode)]
+        public static extern void KodoGLDrawingContextDrawNumber(IntPtr context, IntPtr glyphs, double value, NumberFormat format, int precision, char decimalMark, Rectangle bounds, TextAlignment alignment, float size, IntPtr brush);
+
+        [DllImport(KodoGL, CallingConvention = KodoGLConvention)]
+        public static extern void KodoGLDrawingContextDrawInteger(IntPtr context, IntPtr glyphs, long value, Rectangle bounds, TextAlignment alignment, float size, IntPtr brush);
+
+        [DllImport(KodoGL, CallingConvention = KodoGLConvention)]
+        public static extern void KodoGLDrawingContextDrawLineLayout(IntPtr context, IntPtr layout, IntPtr brush);
+
+        [DllImport(KodoGL, CallingConvention = KodoGLConvention)]
+        public static extern IntPtr KodoGLDrawingContextMapQuads(IntPtr context, int quadsLength, IntPtr brush);
+
+        [DllImport(KodoGL, CallingConvention = KodoGLConvention)]
+        public static extern void KodoGLDrawingContextCommitQuads(IntPtr context);
+
+        // Strings are passed as the UTF-16 they're stored in, without being converted.
+        [DllImport(KodoGL, CallingConvention = KodoGLConvention, CharSet = CharSet.Unicode)]
+        public static extern void KodoGLDrawingContextDrawText(IntPtr context, IntPtr font, string text, int textLength, Rectangle bounds, TextAlignment alignment, IntPtr brush);
+
+        [DllImport(KodoGL, CallingConvention = KodoGLConvention, CharSet = CharSet.Unicode)]
+        public static extern void KodoGLDrawingContextDrawTexts(IntPtr context, IntPtr font, string text, int[] textLengths, Rectangle[] bounds, int textsLength, TextAlignment alignment, IntPtr brush);
+
         //
         // Texture
         //
@@ -402,6 +932,123 @@ namespace kodo_gl_sandbox
         [DllImport(KodoGL, CallingConvention = KodoGLConvention)]
         public static extern IntPtr KodoGLTextureCreate(string filename, bool opacityOnly);
 
+        [DllImport(KodoGL, CallingConvention = KodoGLConvention)]
+        public static extern IntPtr KodoGLTextureCreateFromMemory(IntPtr data, int size, bool opacityOnly);
+
+        [DllImport(KodoGL, CallingConvention = KodoGLConvention)]
+        public static extern IntPtr KodoGLTextureCreateFromMemory(byte[] data, int size, bool opacityOnly);
+
+        [DllImport(KodoGL, CallingConvention = KodoGLConvention)]
+        public static extern void KodoGLTextureSetCompression(string cacheDirectory);
+
+        [DllImport(KodoGL, CallingConvention = KodoGLConvention)]
+        public static extern IntPtr KodoGLTextureCreateAsync(string filename, bool opacityOnly);
+
+        [DllImport(KodoGL, CallingConvention = KodoGLConvention)]
+        public static extern int KodoGLTextureIsReady(IntPtr texture);
+
+        [DllImport(KodoGL, CallingConvention = KodoGLConvention)]
+        public static extern void KodoGLTextureDestroy(IntPtr texture);
+
+        [DllImport(KodoGL, CallingConvention = KodoGLConvention)]
+        public static extern void KodoGLTextureSetBudget(long bytes);
+
+        [DllImport(KodoGL, CallingConvention = KodoGLConvention)]
+        public static extern long KodoGLTextureGetResidentSize();
+
+        //
+        // Text
+        //
+
+        [DllImport(KodoGL, CallingConvention = KodoGLConvention)]
+        public static extern void KodoGLTextCacheSetCapacity(int runs);
+
+        [DllImport(KodoGL, CallingConvention = KodoGLConvention)]
+        public static extern long KodoGLTextCacheGetHits();
+
+        [DllImport(KodoGL, CallingConvention = KodoGLConvention)]
+        public static extern long KodoGLTextCacheGetMisses();
+
+        //
+        // Atlas
+        //
+
+        [DllImport(KodoGL, CallingConvention = KodoGLConvention)]
+        public static extern IntPtr KodoGLAtlasLoaderCreate(int width, int height, string cacheDirectory);
+
+        [DllImport(KodoGL, CallingConvention = KodoGLConvention)]
+        public static extern int KodoGLAtlasLoaderLoadFont(IntPtr loader, string filename, float size, byte[] charset, bool distanceField);
+
+        [DllImport(KodoGL, CallingConvention = KodoGLConvention)]
+        public static extern IntPtr KodoGLAtlasLoaderFinish(IntPtr loader);
+
+        [DllImport(KodoGL, CallingConvention = KodoGLConvention)]
+        public static extern IntPtr KodoGLAtlasGetFont(IntPtr atlas, int font);
+
+        [DllImport(KodoGL, CallingConvention = KodoGLConvention)]
+        public static extern void KodoGLAtlasSetBudget(IntPtr atlas, long bytes);
+
+        //
+        // Series
+        //
+
+        [DllImport(KodoGL, CallingConvention = KodoGLConvention)]
+        public static extern IntPtr KodoGLSeriesCreate(float[] values, int valuesLength);
+
+        [DllImport(KodoGL, CallingConvention = KodoGLConvention)]
+        public static extern void KodoGLSeriesUpdate(IntPtr series, float[] values, int valuesLength);
+
+        //
+        // Text view
+        //
+
+        [DllImport(KodoGL, CallingConvention = KodoGLConvention)]
+        public static extern IntPtr KodoGLTextViewCreate(string filename, IntPtr font, float size);
+
+        [DllImport(KodoGL, CallingConvention = KodoGLConvention)]
+        public static extern void KodoGLTextViewDestroy(IntPtr view);
+
+        [DllImport(KodoGL, CallingConvention = KodoGLConvention)]
+        public static extern long KodoGLTextViewCountOfLines(IntPtr view);
+
+        [DllImport(KodoGL, CallingConvention = KodoGLConvention)]
+        public static extern int KodoGLTextViewIndexed(IntPtr view);
+
+        [DllImport(KodoGL, CallingConvention = KodoGLConvention)]
+        public static extern float KodoGLTextViewLineHeight(IntPtr view);
+
+        //
+        // Number glyphs
+        //
+
+        [DllImport(KodoGL, CallingConvention = KodoGLConvention)]
+        public static extern IntPtr KodoGLNumberGlyphsCreate(IntPtr font);
+
+        [DllImport(KodoGL, CallingConvention = KodoGLConvention)]
+        public static extern void KodoGLNumberGlyphsDestroy(IntPtr glyphs);
+
+        //
+        // Line layout
+        //
+
+        [DllImport(KodoGL, CallingConvention = KodoGLConvention, CharSet = CharSet.Unicode)]
+        public static extern IntPtr KodoGLLineLayoutCreate(IntPtr font, string text, int textLength, float x, float y, float size);
+
+        [DllImport(KodoGL, CallingConvention = KodoGLConvention)]
+        public static extern void KodoGLLineLayoutDestroy(IntPtr layout);
+
+        [DllImport(KodoGL, CallingConvention = KodoGLConvention)]
+        public static extern int KodoGLLineLayoutCountOfLines(IntPtr layout);
+
+        [DllImport(KodoGL, CallingConvention = KodoGLConvention, CharSet = CharSet.Unicode)]
+        public static extern void KodoGLLineLayoutInsert(IntPtr layout, int line, int column, string text, int textLength);
+
+        [DllImport(KodoGL, CallingConvention = KodoGLConvention, CharSet = CharSet.Unicode)]
+        public static extern void KodoGLLineLayoutAppend(IntPtr layout, string text, int textLength);
+
+        [DllImport(KodoGL, CallingConvention = KodoGLConvention)]
+        public static extern void KodoGLLineLayoutErase(IntPtr layout, int line, int column, int endLine, int endColumn);
+
         //
         // Brush
         //
@@ -411,5 +1058,21 @@ namespace kodo_gl_sandbox
 
         [DllImport(KodoGL, CallingConvention = KodoGLConvention)]
         public static extern IntPtr KodoGLBrushCreateGradient(Color color0, Color color1);
+
+        [DllImport(KodoGL, CallingConvention = KodoGLConvention)]
+        public static extern IntPtr KodoGLBrushCreateTexture(IntPtr texture);
+
+        [DllImport(KodoGL, CallingConvention = KodoGLConvention)]
+        public static extern IntPtr KodoGLBrushCreateTextureMask(IntPtr mask, Color color);
+
+        //
+        // Benchmarks
+        //
+
+        [DllImport(KodoGL, CallingConvention = KodoGLConvention)]
+        public static extern int KodoGLBenchmarkPacking(int countOfGlyphs, int sizeOfPage, int sortedByHeight, out double seconds, out double efficiency, out int mostNodes);
+
+        [DllImport(KodoGL, CallingConvention = KodoGLConvention)]
+        public static extern double KodoGLBenchmarkConversion(int width, int height, int channels, int onlyOpacity, int repeats);
     }
 }
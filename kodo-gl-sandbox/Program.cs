@@ -9,8 +9,38 @@ namespace kodo_gl_sandbox
             Console.WriteLine(message);
         }
 
+        static void RunBenchmarks()
+        {
+            foreach (var sorted in new[] { false, true })
+            {
+                double seconds, efficiency;
+                int mostNodes;
+                var packed = Benchmarks.Packing(10000, 2048, sorted, out seconds, out efficiency, out mostNodes);
+
+                Console.WriteLine($"Packing 10000 glyphs{(sorted ? " by height" : "")}: {packed} packed in {seconds * 1000:F2} ms, {efficiency:P1} efficiency, {mostNodes} skyline nodes at most");
+            }
+
+            string[] channelNames = { "Gray", "Gray+alpha", "RGB", "RGBA" };
+
+            foreach (var onlyOpacity in new[] { true, false })
+            {
+                for (var channels = 1; channels <= 4; channels++)
+                {
+                    var seconds = Benchmarks.Conversion(3840, 2160, channels, onlyOpacity, 10);
+
+                    Console.WriteLine($"Converting 3840x2160 {channelNames[channels - 1]} to {(onlyOpacity ? "R8" : "RGBA8")}: {seconds * 1000:F2} ms");
+                }
+            }
+        }
+
         static void Main(string[] args)
         {
+            if (Array.IndexOf(args, "--bench") >= 0)
+            {
+                RunBenchmarks();
+                return;
+            }
+
             using (var windowManager = new WindowManager(ErrorCallback))
             {
                 var window = new Window("kodogl-sandbox", 1280, 720, WindowHints.Decorated | WindowHints.Resizable | WindowHints.Visible);
@@ -22,6 +52,10 @@ namespace kodo_gl_sandbox
 
                 var baseBrush = new ColorBrush(Color.LightSteelBlue);
 
+                var atlasLoader = new FontAtlasLoader(512, 512);
+                var labelFontName = atlasLoader.Load(null, 14, "0123456789.,e+- ms");
+                var labelFont = atlasLoader.Finish().GetFont(labelFontName);
+
                 const int SpectrumSize = 512;
                 const int SpectrumStart = 2;
                 const int SpectrumEnd = 130;
@@ -49,7 +83,6 @@ namespace kodo_gl_sandbox
                 }
 
                 var peaks = new float[barCount];
-                var quads = new Rectangle[barCount * 3 * 2];
 
                 for (var i = 0; i < peaks.Length; i++)
                     peaks[i] = areaHalfHeight;
@@ -58,6 +91,7 @@ namespace kodo_gl_sandbox
 
                 var frameBeginTime = 0.0;
                 var frameEndTime = 0.0;
+                var frameLabel = "0 ms";
 
                 while (!window.ShouldClose)
                 {
@@ -72,55 +106,70 @@ namespace kodo_gl_sandbox
                         audioData[i] = (float)(random.NextDouble());
                     }
 
-                    var quadCounter = 0;
-                    var lastBarHeight = BarMinimum;
-                    // Calculate the initial horizontal coordinates.
-                    var barX0 = areaHalfWidth - (BarSpacer / 2f);
-                    var barX1 = areaHalfWidth + (BarSpacer / 2f);
+                    //
+                    // The bars are written straight into the region the context maps for them, without a managed array.
+                    //
+                    var mapped = context.MapQuads(barCount * 6, baseBrush);
 
-                    for (var i = 0; i < barCount; i++)
+                    if (mapped != IntPtr.Zero)
                     {
-                        var barHeight = 0f;
-
-                        // Grab a "bucket" of audio data.
-                        for (var j = 0; j < dataPerBar; j++)
-                            barHeight += audioData[SpectrumStart + (i * dataPerBar) + j];
-
-                        // Averaging the audio data "bucket".
-                        barHeight /= dataPerBar;
-                        // Actual pixel height calculation.
-                        barHeight = BarMinimum + (barHeight * contextArea.Height);
-                        // Averaging with the last bar.
-                        barHeight = lastBarHeight = (barHeight + lastBarHeight) / 2;
-
-                        // Calculate vertical coordinates for the bar.
-                        var barY0 = areaHalfHeight - barHeight / 2f;
-                        var barY1 = areaHalfHeight + barHeight / 2f;
-                        var peakY = peaks[i] = Math.Min(peaks[i] + PeakDrop, barY0);
-
-                        //
-                        // Calculating the actual bar and peak rectangles, note the increment operator.
-                        //
-                        quads[quadCounter++] = new Rectangle(barX0 - barWidth, barY0, barX0, barY1);
-                        quads[quadCounter++] = Rectangle.FromXYWH(barX0 - barWidth, peakY, barWidth, barWidth);
-                        quads[quadCounter++] = Rectangle.FromXYWH(barX0 - barWidth, areaHeight - peakY, barWidth, barWidth);
-                        // Mirrored
-                        quads[quadCounter++] = new Rectangle(barX1, barY0, barX1 + barWidth, barY1);
-                        quads[quadCounter++] = Rectangle.FromXYWH(barX1, peakY, barWidth, barWidth);
-                        quads[quadCounter++] = Rectangle.FromXYWH(barX1, areaHeight - peakY, barWidth, barWidth);
-
-                        // Advance the horizontal coordinates.
-                        barX0 -= barWidth + BarSpacer;
-                        barX1 += barWidth + BarSpacer;
+                        unsafe
+                        {
+                            var quads = (Rectangle*)mapped;
+                            var quadCounter = 0;
+                            var lastBarHeight = BarMinimum;
+                            // Calculate the initial horizontal coordinates.
+                            var barX0 = areaHalfWidth - (BarSpacer / 2f);
+                            var barX1 = areaHalfWidth + (BarSpacer / 2f);
+
+                            for (var i = 0; i < barCount; i++)
+                            {
+                                var barHeight = 0f;
+
+                                // Grab a "bucket" of audio data.
+                                for (var j = 0; j < dataPerBar; j++)
+                                    barHeight += audioData[SpectrumStart + (i * dataPerBar) + j];
+
+                                // Averaging the audio data "bucket".
+                                barHeight /= dataPerBar;
+                                // Actual pixel height calculation.
+                                barHeight = BarMinimum + (barHeight * contextArea.Height);
+                                // Averaging with the last bar.
+                                barHeight = lastBarHeight = (barHeight + lastBarHeight) / 2;
+
+                                // Calculate vertical coordinates for the bar.
+                                var barY0 = areaHalfHeight - barHeight / 2f;
+                                var barY1 = areaHalfHeight + barHeight / 2f;
+                                var peakY = peaks[i] = Math.Min(peaks[i] + PeakDrop, barY0);
+
+                                //
+                                // Calculating the actual bar and peak rectangles, note the increment operator.
+                                //
+                                quads[quadCounter++] = new Rectangle(barX0 - barWidth, barY0, barX0, barY1);
+                                quads[quadCounter++] = Rectangle.FromXYWH(barX0 - barWidth, peakY, barWidth, barWidth);
+                                quads[quadCounter++] = Rectangle.FromXYWH(barX0 - barWidth, areaHeight - peakY, barWidth, barWidth);
+                                // Mirrored
+                                quads[quadCounter++] = new Rectangle(barX1, barY0, barX1 + barWidth, barY1);
+                                quads[quadCounter++] = Rectangle.FromXYWH(barX1, peakY, barWidth, barWidth);
+                                quads[quadCounter++] = Rectangle.FromXYWH(barX1, areaHeight - peakY, barWidth, barWidth);
+
+                                // Advance the horizontal coordinates.
+                                barX0 -= barWidth + BarSpacer;
+                                barX1 += barWidth + BarSpacer;
+                            }
+                        }
+
+                        context.CommitQuads();
                     }
 
-                    context.DrawQuads(quads, baseBrush);
+                    context.DrawText(labelFont, frameLabel, Rectangle.FromXYWH(0, 0, areaWidth - 4, areaHeight), TextAlignment.Right | TextAlignment.Top, baseBrush);
 
                     window.EndFrame();
 
                     frameEndTime = windowManager.GetTime();
                     var frameTime = frameEndTime - frameBeginTime;
                     var ms = Math.Round(frameTime * 1000);
+                    frameLabel = ms + " ms";
                     //Console.Write( ms );
                     //Console.WriteLine( " ms" );
                 }
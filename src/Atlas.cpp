@@ -1,35 +1,798 @@
 #include "Atlas.hpp"
 #include "AtlasFont.hpp"
+#include "MappedFile.hpp"
+
+#include FT_ADVANCES_H
+
+#include <thread>
 
 namespace kodogl
 {
+	static constexpr glm::uint32 CacheMagic = 0x5441474B; // "KGAT"
+	static constexpr glm::uint32 CacheVersion = 2;
+
+	//
+	// A glyph as stored in a cache file.
+	//
+	struct CachedGlyph
+	{
+		glm::uint32 Codepoint;
+		float_t Width, Height;
+		float_t OffsetX, OffsetY;
+		float_t AdvanceX, AdvanceY;
+		float_t L, T, R, B;
+		glm::uint32 Page;
+	};
+
+	// 64-bit FNV-1a, continuing from hash.
+	static glm::uint64 Fnv1a( glm::uint64 hash, const void* data, size_t size )
+	{
+		const auto* bytes = static_cast<const uint8_t*>(data);
+
+		for (size_t i = 0; i < size; i++)
+		{
+			hash ^= bytes[i];
+			hash *= 0x100000001B3ull;
+		}
+
+		return hash;
+	}
+
+	static constexpr glm::uint64 Fnv1aBasis = 0xCBF29CE484222325ull;
+
+	Atlas::Atlas( size_t width, size_t height, size_t maximumPages ) :
+		library( AtlasLoader::LoadFT_Library() ),
+		widthOfTexture( width ), heightOfTexture( height ),
+		maximumPages( maximumPages ),
+		nameOfTexture( 0 ), capacity( 0 ),
+		frame( 0 ), generation( 0 )
+	{
+	}
+
+	Atlas::~Atlas()
+	{
+		// The faces go before the library.
+		fonts.clear();
+
+		if (nameOfTexture != 0)
+		{
+			gl::DeleteTextures( 1, &nameOfTexture );
+			nameOfTexture = 0;
+		}
+	}
+
 	void Atlas::emplace_back( AtlasLoaderFont&& font )
 	{
 		fonts.emplace_back( *this, std::move( font ) );
 	}
 
-	std::unique_ptr<Atlas> AtlasLoader::Finish()
+	AtlasBitmap Atlas::Render( FT_Face face, utf8::uint32_t codepoint, bool distanceField )
 	{
-		GLuint idOfTexture;
+		AtlasBitmap bitmap{ codepoint, false, 0, 0, 0, 0, 0.0f };
+
+		auto glyphIndex = FT_Get_Char_Index( face, static_cast<FT_ULong>(codepoint) );
+
+		// The fallback is drawn even when the face doesn't have it, as the face's missing glyph.
+		if (glyphIndex == 0 && codepoint != AtlasFont::FallbackCodepoint)
+			return bitmap;
+
+		//
+		// The advance is the unhinted one, read from the metrics without loading the outline again.
+		// It's in 16.16 at the horizontal resolution of the face, HRES times the final one.
+		//
+		FT_Fixed advance;
+		if (FT_Get_Advance( face, glyphIndex, FT_LOAD_NO_HINTING, &advance ))
+			throw AtlasException( "FT_Get_Advance failed." );
+
+		if (FT_Load_Glyph( face, glyphIndex, FT_LOAD_RENDER | FT_LOAD_FORCE_AUTOHINT ))
+			throw AtlasException( "FT_Load_Glyph failed." );
+
+		const auto& ft_bitmap = face->glyph->bitmap;
+
+		bitmap.Present = true;
+		bitmap.Width = static_cast<int32_t>(ft_bitmap.width);
+		bitmap.Height = static_cast<int32_t>(ft_bitmap.rows);
+		bitmap.Left = face->glyph->bitmap_left;
+		bitmap.Top = face->glyph->bitmap_top;
+		bitmap.AdvanceX = static_cast<float_t>(advance) / (65536.0f * HRES);
+
+		bitmap.Pixels.resize( static_cast<size_t>(bitmap.Width) * bitmap.Height );
+
+		for (auto i = 0; i < bitmap.Height; ++i)
+			memcpy( bitmap.Pixels.data() + i * bitmap.Width, ft_bitmap.buffer + i * ft_bitmap.pitch, bitmap.Width );
+
+		if (distanceField)
+			DistanceField( bitmap );
+
+		return bitmap;
+	}
+
+	//
+	// Squared distance transform of a row or column (Felzenszwalb and Huttenlocher), in place.
+	// f holds 0 at the seeds, their squared offset from the pixel center at the edges, and a large value elsewhere.
+	//
+	static void DistanceTransform( float_t* f, size_t stride, size_t length, std::vector<float_t>& d, std::vector<size_t>& v, std::vector<float_t>& z )
+	{
+		const auto infinity = 1e20f;
+
+		d.resize( length );
+		v.resize( length );
+		z.resize( length + 1 );
+
+		v[0] = 0;
+		z[0] = -infinity;
+		z[1] = infinity;
+
+		size_t k = 0;
+
+		for (size_t q = 1; q < length; q++)
+		{
+			float_t s;
+
+			for (;;)
+			{
+				auto r = v[k];
+				s = ((f[q * stride] + q * q) - (f[r * stride] + r * r)) / (2.0f * q - 2.0f * r);
+
+				if (s > z[k] || k == 0)
+					break;
+
+				k--;
+			}
+
+			if (s <= z[k])
+				s = z[k];
+
+			k++;
+			v[k] = q;
+			z[k] = s;
+			z[k + 1] = infinity;
+		}
+
+		k = 0;
+
+		for (size_t q = 0; q < length; q++)
+		{
+			while (z[k + 1] < q)
+				k++;
+
+			auto r = v[k];
+			d[q] = (static_cast<float_t>(q) - r) * (static_cast<float_t>(q) - r) + f[r * stride];
+		}
+
+		for (size_t q = 0; q < length; q++)
+			f[q * stride] = d[q];
+	}
+
+	static void DistanceTransform( std::vector<float_t>& grid, size_t width, size_t height )
+	{
+		std::vector<float_t> d;
+		std::vector<size_t> v;
+		std::vector<float_t> z;
+
+		for (size_t x = 0; x < width; x++)
+			DistanceTransform( grid.data() + x, width, height, d, v, z );
+
+		for (size_t y = 0; y < height; y++)
+			DistanceTransform( grid.data() + y * width, 1, width, d, v, z );
+	}
+
+	void Atlas::DistanceField( AtlasBitmap& bitmap )
+	{
+		const auto infinity = 1e20f;
+		const auto spread = DistanceFieldSpread;
+
+		auto width = static_cast<size_t>(bitmap.Width + spread * 2);
+		auto height = static_cast<size_t>(bitmap.Height + spread * 2);
+
+		//
+		// Squared distances to the glyph and to the background. Partly covered pixels place the outline
+		// within the pixel, by how much they're covered, which keeps the field smooth at small sizes.
+		//
+		std::vector<float_t> toGlyph( width * height, infinity );
+		std::vector<float_t> toBackground( width * height, 0.0f );
 
+		for (auto y = 0; y < bitmap.Height; y++)
+		{
+			for (auto x = 0; x < bitmap.Width; x++)
+			{
+				auto coverage = bitmap.Pixels[y * bitmap.Width + x] / 255.0f;
+				auto i = (y + spread) * width + x + spread;
+
+				if (coverage >= 1.0f)
+				{
+					toGlyph[i] = 0.0f;
+					toBackground[i] = infinity;
+				}
+				else if (coverage > 0.0f)
+				{
+					auto offset = 0.5f - coverage;
+					toGlyph[i] = offset > 0.0f ? offset * offset : 0.0f;
+					toBackground[i] = offset < 0.0f ? offset * offset : 0.0f;
+				}
+			}
+		}
+
+		DistanceTransform( toGlyph, width, height );
+		DistanceTransform( toBackground, width, height );
+
+		std::vector<uint8_t> field( width * height );
+
+		for (size_t i = 0; i < field.size(); i++)
+		{
+			// Positive inside the glyph.
+			auto distance = std::sqrt( toBackground[i] ) - std::sqrt( toGlyph[i] );
+			field[i] = static_cast<uint8_t>(glm::clamp( 0.5f + distance / (2.0f * spread), 0.0f, 1.0f ) * 255.0f + 0.5f);
+		}
+
+		bitmap.Width = static_cast<int32_t>(width);
+		bitmap.Height = static_cast<int32_t>(height);
+		bitmap.Left -= spread;
+		bitmap.Top += spread;
+		bitmap.Pixels.swap( field );
+	}
+
+	uint32_t Atlas::Place( const AtlasBitmap& bitmap, GlyphTable& glyphs )
+	{
+		if (!bitmap.Present)
+		{
+			glyphs.AddMissing( bitmap.Codepoint );
+			return GlyphTable::NoSlot;
+		}
+
+		Region atlasRegion;
+
+		// We want each glyph to be separated by at least one black pixel.
+		auto page = Allocate( bitmap.Width + 1, bitmap.Height + 1, atlasRegion );
+
+		Region glyphRegion{ atlasRegion.X, atlasRegion.Y, bitmap.Width, bitmap.Height };
+
+		SetRegion( pages[page], glyphRegion, bitmap.Pixels.data(), bitmap.Width );
+
+		AtlasGlyph glyph{
+			bitmap.Codepoint,
+			static_cast<float_t>(bitmap.Width),
+			static_cast<float_t>(bitmap.Height),
+			static_cast<float_t>(bitmap.Left),
+			static_cast<float_t>(bitmap.Top),
+			bitmap.AdvanceX,
+			0.0f,
+			Normalize( glyphRegion ),
+			page
+		};
+
+		return glyphs.Add( glyph );
+	}
+
+	uint32_t Atlas::Allocate( int32_t width, int32_t height, Region& region )
+	{
+		for (uint32_t i = 0; i < pages.size(); i++)
+		{
+			if (pages[i].Packer.GetRegion( width, height, region ))
+			{
+				Touch( i );
+				return i;
+			}
+		}
+
+		//
+		// Past the budget, clear the page used least recently, unless every page is used by the current frame.
+		//
+		if (maximumPages != 0 && pages.size() >= maximumPages)
+		{
+			auto coldest = std::min_element( pages.begin(), pages.end(), []( const AtlasPage& a, const AtlasPage& b ) { return a.LastUsedFrame < b.LastUsedFrame; } );
+
+			if (coldest->LastUsedFrame < frame)
+			{
+				auto page = static_cast<uint32_t>(coldest - pages.begin());
+				Evict( page );
+
+				if (pages[page].Packer.GetRegion( width, height, region ))
+				{
+					Touch( page );
+					return page;
+				}
+			}
+		}
+
+		pages.emplace_back( widthOfTexture, heightOfTexture );
+		pages.back().Dirty.push_back( Region{ 0, 0, static_cast<int32_t>(widthOfTexture), static_cast<int32_t>(heightOfTexture) } );
+
+		auto page = static_cast<uint32_t>(pages.size() - 1);
+
+		if (!pages[page].Packer.GetRegion( width, height, region ))
+			throw AtlasException( "Glyph is larger than an atlas page." );
+
+		Touch( page );
+		return page;
+	}
+
+	void Atlas::Evict( uint32_t page )
+	{
+		for (auto& font : fonts)
+			font.glyphs.RemovePage( page );
+
+		auto& evicted = pages[page];
+		evicted.Packer = SkylinePacker( widthOfTexture, heightOfTexture );
+		std::fill( evicted.Data.begin(), evicted.Data.end(), uint8_t( 0 ) );
+
+		// The whole page is uploaded again, so no trace of the old glyphs is left between the new ones.
+		evicted.Dirty.clear();
+		evicted.Dirty.push_back( Region{ 0, 0, static_cast<int32_t>(widthOfTexture), static_cast<int32_t>(heightOfTexture) } );
+
+		generation++;
+	}
+
+	void Atlas::Reserve( size_t countOfPages )
+	{
+		if (countOfPages <= capacity)
+			return;
+
+		GLint maximumLayers;
+		gl::GetIntegerv( gl::MAX_ARRAY_TEXTURE_LAYERS, &maximumLayers );
+
+		if (countOfPages > static_cast<size_t>(maximumLayers))
+			throw AtlasException( "Atlas has more pages than a texture array has layers." );
+
+		auto newCapacity = glm::min( glm::max( countOfPages, capacity * 2 ), static_cast<size_t>(maximumLayers) );
+
+		GLuint idOfTexture;
 		gl::GenTextures( 1, &idOfTexture );
 
-		gl::BindTexture( gl::TEXTURE_2D, idOfTexture );
-		gl::TexParameteri( gl::TEXTURE_2D, gl::TEXTURE_WRAP_S, gl::CLAMP_TO_EDGE );
-		gl::TexParameteri( gl::TEXTURE_2D, gl::TEXTURE_WRAP_T, gl::CLAMP_TO_EDGE );
-		gl::TexParameteri( gl::TEXTURE_2D, gl::TEXTURE_MAG_FILTER, gl::LINEAR );
-		gl::TexParameteri( gl::TEXTURE_2D, gl::TEXTURE_MIN_FILTER, gl::LINEAR );
+		// An array, so glyphs are drawn by the same texture array shaders as any other texture.
+		gl::BindTexture( gl::TEXTURE_2D_ARRAY, idOfTexture );
+		gl::TexParameteri( gl::TEXTURE_2D_ARRAY, gl::TEXTURE_WRAP_S, gl::CLAMP_TO_EDGE );
+		gl::TexParameteri( gl::TEXTURE_2D_ARRAY, gl::TEXTURE_WRAP_T, gl::CLAMP_TO_EDGE );
+		gl::TexParameteri( gl::TEXTURE_2D_ARRAY, gl::TEXTURE_MAG_FILTER, gl::LINEAR );
+		gl::TexParameteri( gl::TEXTURE_2D_ARRAY, gl::TEXTURE_MIN_FILTER, gl::LINEAR );
+		gl::TexStorage3D( gl::TEXTURE_2D_ARRAY, 1, gl::R8, widthOfTexture, heightOfTexture, newCapacity );
 
-		gl::TexStorage2D( gl::TEXTURE_2D, 1, gl::R8, widthOfTexture, heightOfTexture );
-		gl::TexSubImage2D( gl::TEXTURE_2D, 0, 0, 0, widthOfTexture, heightOfTexture, gl::RED, gl::UNSIGNED_BYTE, data.data() );
+		//
+		// Keep the uploaded pages, copying them on the GPU.
+		//
+		if (nameOfTexture != 0)
+		{
+			gl::CopyImageSubData( nameOfTexture, gl::TEXTURE_2D_ARRAY, 0, 0, 0, 0, idOfTexture, gl::TEXTURE_2D_ARRAY, 0, 0, 0, 0, widthOfTexture, heightOfTexture, capacity );
+			gl::DeleteTextures( 1, &nameOfTexture );
+		}
+
+		nameOfTexture = idOfTexture;
+		capacity = newCapacity;
+	}
 
-		auto atlas = std::make_unique<Atlas>( idOfTexture );
+	void Atlas::Upload()
+	{
+		Reserve( glm::max<size_t>( 1, pages.size() ) );
+
+		//
+		// Upload each region straight from the CPU copy of its page, which rows are widthOfTexture apart.
+		//
+		gl::BindTexture( gl::TEXTURE_2D_ARRAY, nameOfTexture );
+		gl::PixelStorei( gl::UNPACK_ALIGNMENT, 1 );
+		gl::PixelStorei( gl::UNPACK_ROW_LENGTH, static_cast<GLint>(widthOfTexture) );
 
-		for (auto&& loaderFont : fonts)
+		for (size_t i = 0; i < pages.size(); i++)
 		{
-			atlas->emplace_back( std::move( loaderFont ) );
+			auto& page = pages[i];
+
+			for (const auto& region : page.Dirty)
+			{
+				if (region.W == 0 || region.H == 0)
+					continue;
+
+				const auto* pixels = page.Data.data() + region.Y * widthOfTexture + region.X;
+				gl::TexSubImage3D( gl::TEXTURE_2D_ARRAY, 0, region.X, region.Y, static_cast<GLint>(i), region.W, region.H, 1, gl::RED, gl::UNSIGNED_BYTE, pixels );
+			}
+
+			page.Dirty.clear();
+		}
+
+		gl::PixelStorei( gl::UNPACK_ROW_LENGTH, 0 );
+		frame++;
+	}
+
+	void Atlas::Write( const std::string& path, glm::uint64 key ) const
+	{
+		//
+		// Write to a file of this thread's own, then move it in place, as the texture cache does.
+		//
+		auto temporaryPath = path + "." + std::to_string( std::hash<std::thread::id>()(std::this_thread::get_id()) );
+
+		FILE* fp = nullptr;
+		fopen_s( &fp, temporaryPath.c_str(), "wb" );
+		if (fp == nullptr)
+			return;
+
+		auto write = [fp]( const void* data, size_t size ) { return fwrite( data, 1, size, fp ) == size; };
+
+		//
+		// Header: magic, version, width and height of a page, number of pages and of fonts, then the key.
+		//
+		glm::uint32 header[6] = {
+			CacheMagic, CacheVersion,
+			static_cast<glm::uint32>(widthOfTexture), static_cast<glm::uint32>(heightOfTexture),
+			static_cast<glm::uint32>(pages.size()), static_cast<glm::uint32>(fonts.size()) };
+
+		auto written = write( header, sizeof( header ) ) && write( &key, sizeof( key ) );
+
+		//
+		// Each page: the area used, the number of skyline nodes, the nodes and the pixels.
+		//
+		for (const auto& page : pages)
+		{
+			const auto& nodes = page.Packer.Nodes();
+			glm::uint64 used = page.Packer.Used();
+			auto countOfNodes = static_cast<glm::uint32>(nodes.size());
+
+			written = written &&
+				write( &used, sizeof( used ) ) &&
+				write( &countOfNodes, sizeof( countOfNodes ) ) &&
+				write( nodes.data(), nodes.size() * sizeof( AtlasNode ) ) &&
+				write( page.Data.data(), page.Data.size() );
+		}
+
+		//
+		// Each font: the metrics, whether it's a distance field and the number of glyphs, the glyphs,
+		// then the number of kerning pairs and the pairs.
+		//
+		for (const auto& font : fonts)
+		{
+			float_t metrics[8] = {
+				font.Size, font.height, font.linegap, font.ascender, font.descender,
+				font.underlinePosition, font.underlineThickness, font.BaselineToBaseline };
+			glm::uint32 flags[2] = { font.DistanceField ? 1u : 0u, static_cast<glm::uint32>(font.glyphs.size()) };
+
+			written = written && write( metrics, sizeof( metrics ) ) && write( flags, sizeof( flags ) );
+
+			font.glyphs.ForEach( [&]( const AtlasGlyph& glyph )
+			{
+				CachedGlyph cached{
+					glyph.Codepoint,
+					glyph.Width, glyph.Height,
+					glyph.OffsetX, glyph.OffsetY,
+					glyph.AdvanceX, glyph.AdvanceY,
+					glyph.Region.L, glyph.Region.T, glyph.Region.R, glyph.Region.B,
+					glyph.Page };
+
+				written = written && write( &cached, sizeof( cached ) );
+			} );
+
+			auto pairs = font.kerning.Pairs();
+			auto countOfPairs = static_cast<glm::uint32>(pairs.size());
+
+			written = written && write( &countOfPairs, sizeof( countOfPairs ) ) && write( pairs.data(), pairs.size() * sizeof( TextureFontKerning ) );
+		}
+
+		fclose( fp );
+
+		if (!written || std::rename( temporaryPath.c_str(), path.c_str() ) != 0)
+			std::remove( temporaryPath.c_str() );
+	}
+
+	bool Atlas::Read( const std::string& path, glm::uint64 key, const std::vector<AtlasFaceOpener>& openers )
+	{
+		MappedFile file( path );
+
+		if (!file.IsOpen())
+			return false;
+
+		size_t offset = 0;
+
+		auto read = [&file, &offset]( void* data, size_t size )
+		{
+			if (file.Size() - offset < size)
+				return false;
+
+			memcpy( data, file.Data() + offset, size );
+			offset += size;
+			return true;
+		};
+
+		glm::uint32 header[6];
+		glm::uint64 keyOfFile;
+
+		if (!read( header, sizeof( header ) ) || !read( &keyOfFile, sizeof( keyOfFile ) ))
+			return false;
+
+		if (header[0] != CacheMagic || header[1] != CacheVersion || keyOfFile != key ||
+			header[2] != widthOfTexture || header[3] != heightOfTexture || header[5] != openers.size())
+			return false;
+
+		//
+		// Read everything before touching the atlas, which stays empty if the file turns out to be cut short.
+		//
+		std::vector<AtlasPage> readPages;
+
+		for (glm::uint32 i = 0; i < header[4]; i++)
+		{
+			glm::uint64 used;
+			glm::uint32 countOfNodes;
+
+			if (!read( &used, sizeof( used ) ) || !read( &countOfNodes, sizeof( countOfNodes ) ) || countOfNodes > widthOfTexture)
+				return false;
+
+			std::vector<AtlasNode> nodes( countOfNodes );
+			readPages.emplace_back( widthOfTexture, heightOfTexture );
+
+			auto& page = readPages.back();
+
+			if (!read( nodes.data(), nodes.size() * sizeof( AtlasNode ) ) || !read( page.Data.data(), page.Data.size() ))
+				return false;
+
+			page.Packer = SkylinePacker( widthOfTexture, heightOfTexture, std::move( nodes ), static_cast<size_t>(used) );
+			page.Dirty.push_back( Region{ 0, 0, static_cast<int32_t>(widthOfTexture), static_cast<int32_t>(heightOfTexture) } );
+		}
+
+		std::vector<AtlasLoaderFont> readFonts;
+
+		for (const auto& open : openers)
+		{
+			float_t metrics[8];
+			glm::uint32 flags[2];
+
+			if (!read( metrics, sizeof( metrics ) ) || !read( flags, sizeof( flags ) ))
+				return false;
+
+			AtlasLoaderFont font( metrics[0], open, flags[0] != 0 );
+			font.height = metrics[1];
+			font.linegap = metrics[2];
+			font.ascender = metrics[3];
+			font.descender = metrics[4];
+			font.underlinePosition = metrics[5];
+			font.underlineThickness = metrics[6];
+			font.BaselineToBaseline = metrics[7];
+
+			for (glm::uint32 i = 0; i < flags[1]; i++)
+			{
+				CachedGlyph cached;
+
+				if (!read( &cached, sizeof( cached ) ) || cached.Page >= readPages.size())
+					return false;
+
+				font.glyphs.Add( AtlasGlyph{
+					cached.Codepoint,
+					cached.Width, cached.Height,
+					cached.OffsetX, cached.OffsetY,
+					cached.AdvanceX, cached.AdvanceY,
+					NormalizedRegion{ cached.L, cached.T, cached.R, cached.B },
+					cached.Page } );
+			}
+
+			glm::uint32 countOfPairs;
+
+			if (!read( &countOfPairs, sizeof( countOfPairs ) ) || countOfPairs > file.Size() / sizeof( TextureFontKerning ))
+				return false;
+
+			std::vector<TextureFontKerning> pairs( countOfPairs );
+
+			if (!read( pairs.data(), pairs.size() * sizeof( TextureFontKerning ) ))
+				return false;
+
+			font.kerning = KerningTable( pairs );
+
+			readFonts.push_back( std::move( font ) );
+		}
+
+		if (offset != file.Size())
+			return false;
+
+		pages = std::move( readPages );
+
+		for (auto& font : readFonts)
+			emplace_back( std::move( font ) );
+
+		return true;
+	}
+
+	AtlasLoader::AtlasLoader( size_t width, size_t height, bool automaticResize, const std::string& cacheDirectory ) :
+		atlas( std::make_unique<Atlas>( width, height, automaticResize ? 0 : 1 ) ),
+		automaticResize( automaticResize ),
+		cacheDirectory( cacheDirectory ),
+		key( Fnv1aBasis )
+	{
+		glm::uint64 layout[4] = { CacheVersion, width, height, automaticResize ? 1u : 0u };
+		Hash( layout, sizeof( layout ) );
+	}
+
+	void AtlasLoader::Hash( const void* data, size_t size )
+	{
+		key = Fnv1a( key, data, size );
+	}
+
+	glm::uint64 AtlasLoader::KeyOfFile( const std::string& filename ) const
+	{
+		if (cacheDirectory.empty())
+			return 0;
+
+		MappedFile file( filename );
+
+		if (!file.IsOpen())
+			throw AtlasException( "Couldn't read the font file." );
+
+		return Fnv1a( Fnv1aBasis, file.Data(), file.Size() );
+	}
+
+	glm::uint64 AtlasLoader::KeyOfBuffer( const uint8_t* buffer, size_t bufferSize ) const
+	{
+		if (cacheDirectory.empty())
+			return 0;
+
+		return Fnv1a( Fnv1aBasis, buffer, bufferSize );
+	}
+
+	std::string AtlasLoader::CachePath() const
+	{
+		char name[32];
+		snprintf( name, sizeof( name ), "%016llx.kglatlas", static_cast<unsigned long long>(key) );
+
+		return cacheDirectory + "\\" + name;
+	}
+
+	GLuint AtlasLoader::Load( const AtlasFaceOpener& openFace, glm::uint64 keyOfFace, float_t size, const std::string& charset, bool distanceField )
+	{
+		auto nameOfFont = static_cast<GLuint>(requests.size());
+		requests.push_back( FontRequest{ openFace, size, charset, distanceField } );
+
+		if (cacheDirectory.empty())
+		{
+			Generate( requests.back() );
+			return nameOfFont;
+		}
+
+		//
+		// Everything the glyphs of the font depend on goes into the name of the cache file.
+		//
+		glm::uint64 lengthOfCharset = charset.size();
+		glm::uint8 mode = distanceField ? 1 : 0;
+
+		Hash( &keyOfFace, sizeof( keyOfFace ) );
+		Hash( &size, sizeof( size ) );
+		Hash( &mode, sizeof( mode ) );
+		Hash( &lengthOfCharset, sizeof( lengthOfCharset ) );
+		Hash( charset.data(), charset.size() );
+
+		return nameOfFont;
+	}
+
+	void AtlasLoader::Generate( const FontRequest& request )
+	{
+		const auto& openFace = request.Open;
+		const auto& charset = request.Charset;
+		auto size = request.Size;
+		auto distanceField = request.DistanceField;
+
+		AtlasLoaderFont font( size, openFace, distanceField );
+		font.face = openFace( atlas->library.get() );
+
+		auto* ftFace = font.face.get();
+
+		font.underlinePosition = ftFace->underline_position / (Atlas::HRES * Atlas::HRES) * size;
+		font.underlinePosition = glm::min( -2.0f, glm::round( font.underlinePosition ) );
+		font.underlineThickness = ftFace->underline_thickness / (Atlas::HRES * Atlas::HRES) * size;
+		font.underlineThickness = glm::max( 1.0f, glm::round( font.underlineThickness ) );
+
+		auto metrics = ftFace->size->metrics;
+		font.ascender = (metrics.ascender >> 6) / 100.0f;
+		font.descender = (metrics.descender >> 6) / 100.0f;
+		font.height = (metrics.height >> 6) / 100.0f;
+		font.linegap = font.height - font.ascender + font.descender;
+
+		font.BaselineToBaseline = (font.ascender - font.descender + font.linegap) * 100.0f;
+
+		//
+		// The fallback and the charset are rasterized up front, the rest on first use.
+		//
+		std::vector<utf8::uint32_t> codepoints;
+
+		{
+			// The enumerator refers to the string, which must outlive it.
+			auto fallbackAndCharset = u8"?" + charset;
+			CodepointEnumerator enumerator{ fallbackAndCharset };
+
+			while (enumerator)
+			{
+				auto codepoint = enumerator.Next();
+
+				if (std::find( codepoints.begin(), codepoints.end(), codepoint ) == codepoints.end())
+					codepoints.push_back( codepoint );
+			}
+		}
+
+		std::vector<AtlasBitmap> bitmaps( codepoints.size() );
+
+		auto countOfThreads = glm::min( static_cast<size_t>(glm::max( 1u, std::thread::hardware_concurrency() )), codepoints.size() / ParallelThreshold + 1 );
+
+		if (countOfThreads <= 1)
+		{
+			for (size_t i = 0; i < codepoints.size(); i++)
+				bitmaps[i] = Atlas::Render( ftFace, codepoints[i], distanceField );
+		}
+		else
+		{
+			//
+			// FreeType libraries and faces aren't shared between threads, so each thread opens the face again.
+			// Threads take every countOfThreads-th glyph, which spreads the complex scripts further in the charset.
+			//
+			std::vector<std::thread> threads;
+			std::vector<std::exception_ptr> errors( countOfThreads );
+
+			for (size_t t = 0; t < countOfThreads; t++)
+			{
+				threads.emplace_back( [&, t]
+				{
+					try
+					{
+						auto library = LoadFT_Library();
+						auto face = openFace( library.get() );
+
+						for (auto i = t; i < codepoints.size(); i += countOfThreads)
+							bitmaps[i] = Atlas::Render( face.get(), codepoints[i], distanceField );
+					}
+					catch (...)
+					{
+						errors[t] = std::current_exception();
+					}
+				} );
+			}
+
+			for (auto& thread : threads)
+				thread.join();
+
+			for (auto& error : errors)
+			{
+				if (error)
+					std::rethrow_exception( error );
+			}
+		}
+
+		//
+		// Pack the tallest glyphs first, which keeps the skyline flat, and equal heights in charset order,
+		// so the atlas is the same whatever the number of threads.
+		//
+		std::stable_sort( bitmaps.begin(), bitmaps.end(), []( const AtlasBitmap& a, const AtlasBitmap& b ) { return a.Height > b.Height; } );
+
+		for (const auto& bitmap : bitmaps)
+			atlas->Place( bitmap, font.glyphs );
+
+		GenerateKerning( font, ftFace );
+
+		atlas->emplace_back( std::move( font ) );
+	}
+
+	void AtlasLoader::GenerateKerning( AtlasLoaderFont& font, FT_Face face )
+	{
+		auto pairs = LoadKerning( face );
+
+		//
+		// Font units to 26.6 pixels at the resolution of the face, which is HRES times the horizontal one.
+		//
+		for (auto& pair : pairs)
+			pair.Value = FT_MulFix( static_cast<FT_Long>(pair.Value), face->size->metrics.x_scale ) / (64.0f * Atlas::HRES);
+
+		font.kerning = KerningTable( pairs );
+	}
+
+	std::unique_ptr<Atlas> AtlasLoader::Finish()
+	{
+		if (!cacheDirectory.empty())
+		{
+			auto path = CachePath();
+
+			std::vector<AtlasFaceOpener> openers;
+
+			for (const auto& request : requests)
+				openers.push_back( request.Open );
+
+			if (!atlas->Read( path, key, openers ))
+			{
+				for (const auto& request : requests)
+					Generate( request );
+
+				atlas->Write( path, key );
+			}
 		}
 
-		return atlas;
+		atlas->Upload();
+		return std::move( atlas );
 	}
 }
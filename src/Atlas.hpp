@@ -5,6 +5,8 @@
 #include <glm/glm.hpp>
 #include <utf8/utf8.h>
 
+#include <functional>
+
 #include "AtlasFonts.hpp"
 
 namespace kodogl
@@ -17,451 +19,382 @@ namespace kodogl
 		explicit AtlasException(std::string message) : exception(message) {}
 	};
 
-	struct AtlasNode
-	{
-		int32_t X;
-		int32_t Y;
-		int32_t Z;
+	typedef decltype(&FT_Done_FreeType) FT_Library_Deleter;
 
-		explicit AtlasNode() : X(0), Y(0), Z(0) {}
-		explicit AtlasNode(int32_t x, int32_t y, int32_t z) : X(x), Y(y), Z(z) {}
-	};
+	class AtlasLoader;
 
-	class Atlas;
+	//
+	// A rendered glyph, not yet placed in an atlas.
+	//
+	struct AtlasBitmap
+	{
+		utf8::uint32_t Codepoint;
+		// False when the face has no glyph for the codepoint.
+		bool Present;
+
+		int32_t Width;
+		int32_t Height;
+		int32_t Left;
+		int32_t Top;
+		float_t AdvanceX;
+
+		// Rows top first, tightly packed.
+		std::vector<uint8_t> Pixels;
+	};
 
-	class AtlasLoader
+	//
+	// A page of a glyph atlas, a layer of the atlas texture.
+	//
+	struct AtlasPage
 	{
-		static constexpr char* DefaultCharset = u8" -_.:,;<>|*'^?+`!@\"#%&/\\~={}[]()$abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMOPQRSTUVWXYZ0123456789";
-		static constexpr float_t HRES = 64;
-		static constexpr float_t DPI = 96;
+		SkylinePacker Packer;
+		std::vector<uint8_t> Data;
 
-		typedef decltype(&FT_Done_FreeType) FT_Library_Deleter;
-		typedef decltype(&FT_Done_Face) FT_Face_Deleter;
+		// Regions rasterized into since the last upload.
+		std::vector<Region> Dirty;
+
+		// The last frame a glyph of the page was used in.
+		glm::uint64 LastUsedFrame;
+
+		AtlasPage(size_t width, size_t height) : Packer(width, height), Data(width * height, 0), LastUsedFrame(0) {}
+	};
+
+	//
+	// A texture atlas of glyphs, with one page per layer of a texture array.
+	// Glyphs are rasterized on first use from the faces their fonts keep open, and the regions they were drawn into
+	// are uploaded by Upload, which must be called once per frame before drawing text.
+	//
+	// When a page is full another is added, up to the memory budget; past the budget the page used least recently
+	// is cleared and its glyphs are rasterized again on their next use.
+	//
+	class Atlas
+	{
+		friend AtlasLoader;
+		friend AtlasFont;
 
 		std::unique_ptr<FT_LibraryRec_, FT_Library_Deleter> library;
 
 		size_t widthOfTexture;
 		size_t heightOfTexture;
 
-		size_t usedOfTexture;
+		std::vector<AtlasPage> pages;
+		// Number of pages within the budget; 0 for no limit.
+		size_t maximumPages;
 
-		std::vector<uint8_t> data;
-		std::vector<AtlasNode> nodes;
-		std::vector<AtlasLoaderFont> fonts;
+		GLuint nameOfTexture;
+		// Number of layers of the texture.
+		size_t capacity;
 
-		bool automaticResize;
+		glm::uint64 frame;
+		glm::uint64 generation;
 
-	public:
+		std::vector<AtlasFont> fonts;
+
+		void emplace_back(AtlasLoaderFont&& font);
 
 		//
-		// The amount of space used within the GPU texture. (0.0..1.0)
-		//
-		float_t UsedOfTexture() const
+		// Rasterize the glyph of a codepoint into the atlas and add it to glyphs.
+		// Returns its slot, or NoSlot when the face has no glyph for the codepoint.
+		uint32_t Rasterize(FT_Face face, utf8::uint32_t codepoint, bool distanceField, GlyphTable& glyphs)
 		{
-			return static_cast<float_t>(usedOfTexture) / static_cast<float_t>(data.size());
+			return Place(Render(face, codepoint, distanceField), glyphs);
 		}
 
-		static std::unique_ptr<FT_LibraryRec_, FT_Library_Deleter> LoadFT_Library()
-		{
-			FT_Library library;
-
-			if (FT_Init_FreeType(&library))
-				throw AtlasException("FT_Init_FreeType failed.");
-
-			return std::unique_ptr<FT_LibraryRec_, FT_Library_Deleter>(library, FT_Done_FreeType);
-		}
+		//
+		// Render the glyph of a codepoint, as coverage or as a signed distance field.
+		// Only touches the face, so faces of their own let threads render in parallel.
+		static AtlasBitmap Render(FT_Face face, utf8::uint32_t codepoint, bool distanceField);
 
-		static std::unique_ptr<FT_FaceRec_, FT_Face_Deleter> LoadFT_Face(FT_Library library, const uint8_t* data, size_t dataSize, float_t size)
-		{
-			FT_Face face;
+		//
+		// Turn the coverage of a glyph into a signed distance field, padded by DistanceFieldSpread on each side.
+		static void DistanceField(AtlasBitmap& bitmap);
 
-			if (FT_New_Memory_Face(library, data, dataSize, 0, &face))
-				throw AtlasException("FT_New_Face failed.");
+		//
+		// Pack a rendered glyph into the atlas and add it to glyphs.
+		uint32_t Place(const AtlasBitmap& bitmap, GlyphTable& glyphs);
 
-			auto facePtr = std::unique_ptr<FT_FaceRec_, FT_Face_Deleter>(face, FT_Done_Face);
+		//
+		// Find room for a glyph, adding or clearing a page if needed.
+		uint32_t Allocate(int32_t width, int32_t height, Region& region);
 
-			if (FT_Select_Charmap(face, FT_ENCODING_UNICODE))
-				throw AtlasException("FT_Select_Charmap failed.");
-			if (FT_Set_Char_Size(face, static_cast<FT_F26Dot6>(size * HRES), 0, static_cast<FT_UInt>(DPI * HRES), static_cast<FT_UInt>(DPI)))
-				throw AtlasException("FT_Set_Char_Size failed.");
+		//
+		// Clear a page and forget the glyphs it holds.
+		void Evict(uint32_t page);
 
-			FT_Matrix matrix = { static_cast<FT_Fixed>(1.0 / HRES * 0x10000L), 0, 0, 0x10000L };
-			FT_Set_Transform(face, &matrix, nullptr);
+		//
+		// Make room for at least the number of pages, copying the existing layers on the GPU.
+		void Reserve(size_t countOfPages);
 
-			return facePtr;
+		void Touch(uint32_t page)
+		{
+			pages[page].LastUsedFrame = frame;
 		}
 
-		static std::unique_ptr<FT_FaceRec_, FT_Face_Deleter> LoadFT_Face(FT_Library library, const std::string& filename, float_t size)
+		void SetRegion(AtlasPage& page, const Region& region, const uint8_t* const dat, size_t stride)
 		{
-			FT_Face face;
+			auto charsize = sizeof(char);
 
-			if (FT_New_Face(library, filename.c_str(), 0, &face))
-				throw AtlasException("FT_New_Face failed.");
+			for (auto i = 0; i < region.H; ++i)
+			{
+				memcpy(page.Data.data() + ((region.Y + i) * widthOfTexture + region.X) * charsize,
+					   dat + (i * stride) * charsize,
+					   region.W * charsize);
+			}
 
-			auto facePtr = std::unique_ptr<FT_FaceRec_, FT_Face_Deleter>(face, FT_Done_Face);
+			page.Dirty.push_back(region);
+		}
 
-			if (FT_Select_Charmap(face, FT_ENCODING_UNICODE))
-				throw AtlasException("FT_Select_Charmap failed.");
-			if (FT_Set_Char_Size(face, static_cast<FT_F26Dot6>(size * HRES), 0, static_cast<FT_UInt>(DPI * HRES), static_cast<FT_UInt>(DPI)))
-				throw AtlasException("FT_Set_Char_Size failed.");
+		//
+		// Write the pages and the fonts with their glyphs to a cache file.
+		void Write(const std::string& path, glm::uint64 key) const;
 
-			FT_Matrix matrix = { static_cast<FT_Fixed>(1.0 / HRES * 0x10000L), 0, 0, 0x10000L };
-			FT_Set_Transform(face, &matrix, nullptr);
+		//
+		// Read the pages and the fonts of a cache file written for the same key, one font per opener.
+		// Fonts read back open their faces with the openers on their first miss. Returns false when the file can't be used.
+		bool Read(const std::string& path, glm::uint64 key, const std::vector<AtlasFaceOpener>& openers);
 
-			return facePtr;
+		NormalizedRegion Normalize(const Region& region) const
+		{
+			return NormalizedRegion{
+				NormalizeX(region.X),
+				NormalizeY(region.Y),
+				NormalizeX(region.X + region.W),
+				NormalizeY(region.Y + region.H) };
 		}
 
-		AtlasLoader(size_t width, size_t height, bool automaticResize = false) :
-			widthOfTexture(width), heightOfTexture(height), usedOfTexture(0),
-			automaticResize(automaticResize),
-			library(LoadFT_Library())
+		float_t NormalizeX(int32_t x) const
 		{
-			data.resize(width * height, 0);
-			nodes.push_back(AtlasNode{ 1, 1, static_cast<int32_t>(widthOfTexture - 2) });
+			return static_cast<float_t>(x) / static_cast<float_t>(widthOfTexture);
 		}
 
-		std::unique_ptr<Atlas> Finish();
-
-		GLuint Load(const uint8_t* buffer, size_t bufferSize, float_t size, const std::string& charset = DefaultCharset)
+		float_t NormalizeY(int32_t y) const
 		{
-			auto face = LoadFT_Face(library.get(), buffer, bufferSize, size);
+			return static_cast<float_t>(y) / static_cast<float_t>(heightOfTexture);
+		}
 
-			AtlasLoaderFont font(size);
+	public:
 
-			font.underlinePosition = face->underline_position / (HRES * HRES) * size;
-			font.underlinePosition = glm::min(-2.0f, glm::round(font.underlinePosition));
-			font.underlineThickness = face->underline_thickness / (HRES * HRES) * size;
-			font.underlineThickness = glm::max(1.0f, glm::round(font.underlineThickness));
+		static constexpr float_t HRES = 64;
+		static constexpr float_t DPI = 96;
 
-			auto metrics = face->size->metrics;
-			font.ascender = (metrics.ascender >> 6) / 100.0f;
-			font.descender = (metrics.descender >> 6) / 100.0f;
-			font.height = (metrics.height >> 6) / 100.0f;
-			font.linegap = font.height - font.ascender + font.descender;
+		// Distance in pixels covered by distance field glyphs on either side of the outline; 0.5 in the texture is the outline.
+		static constexpr int32_t DistanceFieldSpread = 4;
 
-			font.BaselineToBaseline = (font.ascender - font.descender + font.linegap) * 100.0f;
+		//
+		// The amount of space used within the GPU texture. (0.0..1.0)
+		float_t UsedOfTexture() const
+		{
+			size_t used = 0;
 
-			GenerateGlyphs(font, face.get(), u8"?" + charset);
+			for (const auto& page : pages)
+				used += page.Packer.Used();
 
-			auto nameOfFont = static_cast<GLuint>(fonts.size());
-			fonts.emplace_back(font);
-			return nameOfFont;
+			return static_cast<float_t>(used) / static_cast<float_t>(widthOfTexture * heightOfTexture * glm::max<size_t>(1, pages.size()));
 		}
 
-		GLuint Load(const std::string& filename, float_t size, const std::string& charset = DefaultCharset)
+		//
+		// Limit the memory used by the pages. At least one page is kept, and a frame needing more pages than
+		// the budget allows gets them.
+		void Budget(size_t bytes)
 		{
-			auto face = LoadFT_Face(library.get(), filename, size);
-
-			AtlasLoaderFont font(size);
-
-			font.underlinePosition = face->underline_position / (HRES * HRES) * size;
-			font.underlinePosition = glm::min(-2.0f, glm::round(font.underlinePosition));
-			font.underlineThickness = face->underline_thickness / (HRES * HRES) * size;
-			font.underlineThickness = glm::max(1.0f, glm::round(font.underlineThickness));
-
-			auto metrics = face->size->metrics;
-			font.ascender = (metrics.ascender >> 6) / 100.0f;
-			font.descender = (metrics.descender >> 6) / 100.0f;
-			font.height = (metrics.height >> 6) / 100.0f;
-			font.linegap = font.height - font.ascender + font.descender;
-
-			font.BaselineToBaseline = (font.ascender - font.descender + font.linegap) * 100.0f;
-
-			GenerateGlyphs(font, face.get(), u8"?" + charset);
-
-			auto nameOfFont = static_cast<GLuint>(fonts.size());
-			fonts.emplace_back(font);
-			return nameOfFont;
+			maximumPages = bytes == 0 ? 0 : glm::max<size_t>(1, bytes / (widthOfTexture * heightOfTexture));
 		}
 
-		void GenerateGlyphs(AtlasLoaderFont& font, FT_Face face, const std::string& charset)
+		size_t CountOfPages() const
 		{
-			CodepointEnumerator codepoints{ charset };
-
-			while (codepoints)
-			{
-				auto codepoint = codepoints.Next();
-
-				// Maybe the glyph is already loaded?
-				if (font.glyphs.count(codepoint))
-					continue;
-
-				auto glyphIndex = FT_Get_Char_Index(face, static_cast<FT_ULong>(codepoint));
-
-				if (FT_Load_Glyph(face, glyphIndex, FT_LOAD_RENDER | FT_LOAD_FORCE_AUTOHINT))
-					throw AtlasException("FT_Load_Glyph failed.");
-
-				auto glyphSlot = face->glyph;
-				auto ft_bitmap = glyphSlot->bitmap;
-				auto ft_glyph_top = glyphSlot->bitmap_top;
-				auto ft_glyph_left = glyphSlot->bitmap_left;
-				auto glyphWidth = ft_bitmap.width;
-				auto glyphHeight = ft_bitmap.rows;
-
-				Region atlasRegion;
-
-				// We want each glyph to be separated by at least one black pixel.
-				if (!GetRegion(glyphWidth + 1, glyphHeight + 1, atlasRegion))
-					throw AtlasException("Atlas is full.");
-
-				Region glyphRegion{ atlasRegion.X, atlasRegion.Y, glyphWidth, glyphHeight };
-
-				SetRegion(glyphRegion, ft_bitmap.buffer, ft_bitmap.pitch);
-
-				// Discard hinting to get advance.
-				FT_Load_Glyph(face, glyphIndex, FT_LOAD_RENDER | FT_LOAD_NO_HINTING);
+			return pages.size();
+		}
 
-				AtlasGlyph glyph{
-					codepoint,
-					static_cast<float_t>(glyphWidth),
-					static_cast<float_t>(glyphHeight),
-					static_cast<float_t>(ft_glyph_left),
-					static_cast<float_t>(ft_glyph_top),
-					static_cast<float_t>(face->glyph->advance.x) / HRES,
-					static_cast<float_t>(face->glyph->advance.y) / HRES,
-					Normalize(glyphRegion)
-				};
+		//
+		// Incremented whenever a page is cleared. Text laid out in an earlier generation may refer to evicted glyphs.
+		glm::uint64 Generation() const
+		{
+			return generation;
+		}
 
-				font.glyphs.emplace(codepoint, glyph);
-			}
+		//
+		// Gets the AtlasFont with the specified name.
+		const AtlasFont& Get(GLuint name) const
+		{
+			if (name >= fonts.size())
+				throw AtlasException("Font " + std::to_string(name) + " isn't in the atlas.");
 
-			GenerateKerning(font, face);
+			return fonts[name];
 		}
 
-		void GenerateKerning(AtlasLoaderFont& font, FT_Face face)
+		//
+		// Gets the name of the Atlas texture, 0 until the first upload. The texture is replaced when the atlas grows.
+		GLuint Name() const
 		{
-			//
-			// For each glyph couple combination, check if kerning is necessary.
-			//
-			for (auto& kp : font.glyphs)
-			{
-				auto& glyph = kp.second;
-				auto glyphIndex = FT_Get_Char_Index(face, glyph.Codepoint);
+			return nameOfTexture;
+		}
 
-				// Skip the null glyph.
-				if (glyph.Codepoint == size_t(-1))
-					continue;
+		//
+		// Copying and moving are not allowed; fonts refer to their atlas.
+		Atlas(const Atlas&) = delete;
+		Atlas(Atlas&&) = delete;
 
-				//glyph.Kerning.clear();
+		//
+		// Create a new, empty Atlas with pages of the specified size. With a maximum of 0 pages the atlas grows without limit.
+		explicit Atlas(size_t width, size_t height, size_t maximumPages = 0);
 
-				for (const auto& kpj : font.glyphs)
-				{
-					auto prevGlyph = kpj.second;
-					auto prevIndex = FT_Get_Char_Index(face, prevGlyph.Codepoint);
+		//
+		// Destroy the Atlas.
+		~Atlas();
 
-					FT_Vector kerning;
-					FT_Get_Kerning(face, prevIndex, glyphIndex, FT_KERNING_UNFITTED, &kerning);
+		//
+		// Upload the glyphs rasterized since the last upload, growing the texture for new pages, and start a new frame.
+		void Upload();
 
-					if (kerning.x)
-					{
-						//glyph.Kerning.push_back( TextureFontKerning{ prevGlyph.Codepoint, kerning.x / static_cast<float_t>(HRES * HRES) } );
-					}
-				}
-			}
+		//
+		// glBindTexture
+		void Bind() const
+		{
+			gl::BindTexture(gl::TEXTURE_2D_ARRAY, nameOfTexture);
 		}
+	};
+
+	class AtlasLoader
+	{
+		std::unique_ptr<Atlas> atlas;
+
+		bool automaticResize;
 
 		//
-		// Gets the requested region and indicates whether or not it fits in the atlas.
-		//
-		bool GetRegion(int32_t width, int32_t height, Region& region)
+		// A font to be loaded, kept until Finish when the atlas is cached.
+		struct FontRequest
 		{
-			auto bestHeight = size_t(UINT_MAX);
-			auto bestWidth = size_t(UINT_MAX);
-			auto bestIndex = -1;
-			auto fittedX = 0;
-			auto fittedY = 0;
+			AtlasFaceOpener Open;
+			float_t Size;
+			std::string Charset;
+			bool DistanceField;
+		};
 
-			for (size_t i = 0; i < nodes.size(); ++i)
-			{
-				auto y = Fit(i, width, height);
-
-				if (y >= 0)
-				{
-					auto& node = nodes[i];
-
-					if (static_cast<size_t>(y + height) < bestHeight ||
-						(y + height == bestHeight && (node.Z > 0 && static_cast<size_t>(node.Z) < bestWidth)))
-					{
-						bestHeight = y + height;
-						bestIndex = i;
-						bestWidth = node.Z;
-						fittedX = node.X;
-						fittedY = y;
-					}
-				}
-			}
+		std::vector<FontRequest> requests;
 
-			if (bestIndex == -1)
-			{
-				return false;
-			}
+		// Directory of the cache files; empty for no cache.
+		std::string cacheDirectory;
+		// Hash of the atlas size and of every font requested so far, naming the cache file.
+		glm::uint64 key;
 
-			nodes.insert(nodes.cbegin() + bestIndex, AtlasNode{ fittedX, fittedY + height, width });
+		// Number of glyphs from which a charset is rendered across threads.
+		static constexpr size_t ParallelThreshold = 64;
 
-			for (size_t i = bestIndex + 1; i < nodes.size(); ++i)
-			{
-				auto& node = nodes[i];
-				auto& prev = nodes[i - 1];
+		GLuint Load(const AtlasFaceOpener& openFace, glm::uint64 keyOfFace, float_t size, const std::string& charset, bool distanceField);
 
-				if (node.X >= prev.X + prev.Z)
-					break;
+		//
+		// Rasterize the charset of a font into the atlas, opening the face once per thread rendering it.
+		void Generate(const FontRequest& request);
 
-				auto shrink = prev.X + prev.Z - node.X;
-				node.X += shrink;
-				node.Z -= shrink;
+		void Hash(const void* data, size_t size);
 
-				if (node.Z > 0)
-					break;
+		//
+		// Hash of the font data, 0 without a cache.
+		glm::uint64 KeyOfFile(const std::string& filename) const;
+		glm::uint64 KeyOfBuffer(const uint8_t* buffer, size_t bufferSize) const;
 
-				nodes.erase(nodes.cbegin() + i);
-				--i;
-			}
+		std::string CachePath() const;
 
-			Merge();
-			usedOfTexture += width * height;
-			region = Region{ fittedX, fittedY, width, height };
-			return true;
-		}
+	public:
 
-		void SetRegion(const Region& region, const uint8_t* const dat, size_t stride)
+		//
+		// The amount of space used within the GPU texture. (0.0..1.0)
+		// With a cache directory, nothing is used until Finish.
+		//
+		float_t UsedOfTexture() const
 		{
-			auto charsize = sizeof(char);
-
-			for (auto i = 0; i < region.H; ++i)
-			{
-				memcpy(data.data() + ((region.Y + i) * widthOfTexture + region.X) * charsize,
-					   dat + (i * stride) * charsize,
-					   region.W * charsize);
-			}
+			return atlas->UsedOfTexture();
 		}
 
-		NormalizedRegion Normalize(const Region& region) const
+		static std::unique_ptr<FT_LibraryRec_, FT_Library_Deleter> LoadFT_Library()
 		{
-			return NormalizedRegion{
-				NormalizeX(region.X),
-				NormalizeY(region.Y),
-				NormalizeX(region.X + region.W),
-				NormalizeY(region.Y + region.H) };
-		}
+			FT_Library library;
 
-		float_t NormalizeX(int32_t x) const
-		{
-			return static_cast<float_t>(x) / static_cast<float_t>(widthOfTexture);
-		}
+			if (FT_Init_FreeType(&library))
+				throw AtlasException("FT_Init_FreeType failed.");
 
-		float_t NormalizeY(int32_t y) const
-		{
-			return static_cast<float_t>(y) / static_cast<float_t>(heightOfTexture);
+			return std::unique_ptr<FT_LibraryRec_, FT_Library_Deleter>(library, FT_Done_FreeType);
 		}
 
-	private:
-
-		int32_t Fit(size_t index, size_t width, size_t height)
+		static std::unique_ptr<FT_FaceRec_, FT_Face_Deleter> LoadFT_Face(FT_Library library, const uint8_t* data, size_t dataSize, float_t size)
 		{
-			auto node = nodes[index];
-			auto i = index;
-			auto x = node.X;
-			auto y = node.Y;
-			auto width_left = static_cast<int32_t>(width);
-
-			if (x + width > widthOfTexture - 1)
-				return -1;
+			FT_Face face;
 
-			while (width_left > 0)
-			{
-				node = nodes[i];
+			if (FT_New_Memory_Face(library, data, dataSize, 0, &face))
+				throw AtlasException("FT_New_Face failed.");
 
-				if (node.Y > y)
-					y = node.Y;
+			auto facePtr = std::unique_ptr<FT_FaceRec_, FT_Face_Deleter>(face, FT_Done_Face);
 
-				if (y + height > heightOfTexture - 1)
-					return -1;
+			if (FT_Select_Charmap(face, FT_ENCODING_UNICODE))
+				throw AtlasException("FT_Select_Charmap failed.");
+			if (FT_Set_Char_Size(face, static_cast<FT_F26Dot6>(size * Atlas::HRES), 0, static_cast<FT_UInt>(Atlas::DPI * Atlas::HRES), static_cast<FT_UInt>(Atlas::DPI)))
+				throw AtlasException("FT_Set_Char_Size failed.");
 
-				width_left -= node.Z;
-				++i;
-			}
+			FT_Matrix matrix = { static_cast<FT_Fixed>(1.0 / Atlas::HRES * 0x10000L), 0, 0, 0x10000L };
+			FT_Set_Transform(face, &matrix, nullptr);
 
-			return y;
+			return facePtr;
 		}
 
-		void Merge()
+		static std::unique_ptr<FT_FaceRec_, FT_Face_Deleter> LoadFT_Face(FT_Library library, const std::string& filename, float_t size)
 		{
-			for (size_t i = 0; i < nodes.size() - 1; ++i)
-			{
-				auto& node = nodes[i];
-				auto& next = nodes[i + 1];
-
-				if (node.Y == next.Y)
-				{
-					node.Z += next.Z;
-					nodes.erase(nodes.cbegin() + i + 1);
-					--i;
-				}
-			}
-		}
-	};
-
-	class Atlas
-	{
-		friend AtlasLoader;
+			FT_Face face;
 
-		GLuint nameOfTexture;
+			if (FT_New_Face(library, filename.c_str(), 0, &face))
+				throw AtlasException("FT_New_Face failed.");
 
-		std::vector<AtlasFont> fonts;
+			auto facePtr = std::unique_ptr<FT_FaceRec_, FT_Face_Deleter>(face, FT_Done_Face);
 
-		void emplace_back(AtlasLoaderFont&& font);
+			if (FT_Select_Charmap(face, FT_ENCODING_UNICODE))
+				throw AtlasException("FT_Select_Charmap failed.");
+			if (FT_Set_Char_Size(face, static_cast<FT_F26Dot6>(size * Atlas::HRES), 0, static_cast<FT_UInt>(Atlas::DPI * Atlas::HRES), static_cast<FT_UInt>(Atlas::DPI)))
+				throw AtlasException("FT_Set_Char_Size failed.");
 
-	public:
+			FT_Matrix matrix = { static_cast<FT_Fixed>(1.0 / Atlas::HRES * 0x10000L), 0, 0, 0x10000L };
+			FT_Set_Transform(face, &matrix, nullptr);
 
-		//
-		// Gets the AtlasFont with the specified name.
-		const AtlasFont& Get(GLuint name) const
-		{
-			return fonts.at(name);
+			return facePtr;
 		}
 
 		//
-		// Gets the name of the Atlas texture.
-		GLuint Name() const
-		{
-			return nameOfTexture;
-		}
-
+		// Without automatic resizing the atlas has a single page, which is cleared when full.
 		//
-		// Copying is not allowed.
-		Atlas(const Atlas&) = delete;
+		// With a cache directory the fonts are rasterized by Finish, which writes the atlas to a file of the directory,
+		// named by the fonts, their sizes and charsets. Later loads of the same fonts read that file instead of using FreeType,
+		// until a glyph missing from it is needed.
+		//
+		AtlasLoader(size_t width, size_t height, bool automaticResize = false, const std::string& cacheDirectory = std::string());
+
+		std::unique_ptr<Atlas> Finish();
 
 		//
-		// Create a new Atlas from another Atlas.
-		Atlas(Atlas&& other) :
-			nameOfTexture(other.nameOfTexture)
+		// Load a font from memory. The font data must outlive the atlas, glyphs are rasterized from it on first use.
+		// The charset is rasterized up front, e.g. the characters of labels drawn in the first frame.
+		GLuint Load(const uint8_t* buffer, size_t bufferSize, float_t size, const std::string& charset = std::string())
 		{
-			other.nameOfTexture = 0;
+			return Load([=](FT_Library library) { return LoadFT_Face(library, buffer, bufferSize, size); }, KeyOfBuffer(buffer, bufferSize), size, charset, false);
 		}
 
-		//
-		// Create a new Atlas.
-		explicit Atlas(GLuint nameOfTexture) :
-			nameOfTexture(nameOfTexture)
+		GLuint Load(const std::string& filename, float_t size, const std::string& charset = std::string())
 		{
+			return Load([=](FT_Library library) { return LoadFT_Face(library, filename, size); }, KeyOfFile(filename), size, charset, false);
 		}
 
 		//
-		// Destroy the Atlas.
-		~Atlas()
+		// Load a font as signed distance fields, drawn with the distance field shader at any size.
+		// The size is the one glyphs are rendered at; 32 or more keeps the outlines sharp when magnified.
+		GLuint LoadDistanceField(const uint8_t* buffer, size_t bufferSize, float_t size, const std::string& charset = std::string())
 		{
-			if (nameOfTexture != 0)
-			{
-				gl::DeleteTextures(1, &nameOfTexture);
-				nameOfTexture = 0;
-			}
+			return Load([=](FT_Library library) { return LoadFT_Face(library, buffer, bufferSize, size); }, KeyOfBuffer(buffer, bufferSize), size, charset, true);
 		}
 
-		//
-		// glBindTexture
-		void Bind() const
+		GLuint LoadDistanceField(const std::string& filename, float_t size, const std::string& charset = std::string())
 		{
-			gl::BindTexture(gl::TEXTURE_2D, nameOfTexture);
+			return Load([=](FT_Library library) { return LoadFT_Face(library, filename, size); }, KeyOfFile(filename), size, charset, true);
 		}
+
+		//
+		// Read the kerning pairs of the codepoints of the face, in pixels.
+		static void GenerateKerning(AtlasLoaderFont& font, FT_Face face);
 	};
 }
@@ -7,8 +7,12 @@ namespace kodogl
 {
 	AtlasFont::AtlasFont( AtlasFont&& that ) :
 		Size( that.Size ),
+		DistanceField( that.DistanceField ),
 		atlas( that.atlas ),
 		glyphs( std::move( that.glyphs ) ),
+		kerning( std::move( that.kerning ) ),
+		open( std::move( that.open ) ),
+		face( std::move( that.face ) ),
 		height( that.height ),
 		linegap( that.linegap ), ascender( that.ascender ),
 		descender( that.descender ), underlinePosition( that.underlinePosition ),
@@ -18,8 +22,12 @@ namespace kodogl
 
 	AtlasFont::AtlasFont( Atlas& atlas, AtlasLoaderFont&& font ) :
 		Size( font.Size ),
+		DistanceField( font.distanceField ),
 		atlas( atlas ),
 		glyphs( std::move( font.glyphs ) ),
+		kerning( std::move( font.kerning ) ),
+		open( std::move( font.open ) ),
+		face( std::move( font.face ) ),
 		height( font.height ),
 		linegap( font.linegap ), ascender( font.ascender ),
 		descender( font.descender ), underlinePosition( font.underlinePosition ),
@@ -33,36 +41,62 @@ namespace kodogl
 		return kodogl::GlyphEnumerator( *this, str, fallBack );
 	}
 
-	const AtlasGlyph& AtlasFont::GetGlyph( utf8::uint32_t codepoint, bool fallback ) const
+	uint32_t AtlasFont::FindGlyph( utf8::uint32_t codepoint, bool fallback ) const
 	{
-		if (!glyphs.count( codepoint ))
+		auto slot = glyphs.Find( codepoint );
+
+		if (slot != GlyphTable::NoSlot)
+		{
+			atlas.Touch( glyphs.Page( slot ) );
+			return slot;
+		}
+
+		// Codepoints the face has no glyph for, such as control characters, aren't looked up in it again.
+		if (!glyphs.Missing( codepoint ))
+		{
+			if (!face)
+				face = open( atlas.library.get() );
+
+			slot = atlas.Rasterize( face.get(), codepoint, DistanceField, glyphs );
+		}
+
+		if (slot == GlyphTable::NoSlot)
 		{
 			if (fallback)
 			{
-				return glyphs.at( FallbackCodepoint );
+				return FindGlyph( FallbackCodepoint );
 			}
 
-			throw AtlasException( "Glyph not loaded for codepoint -> " );
+			throw AtlasException( "No glyph for codepoint -> " + std::to_string( codepoint ) );
 		}
 
-		return glyphs.at( codepoint );
+		return slot;
+	}
+
+	void AtlasFont::Touch( const std::vector<uint32_t>& pages ) const
+	{
+		for (auto page : pages)
+			atlas.Touch( page );
 	}
 
 	glm::vec2 AtlasFont::Measure( const std::string& text ) const
 	{
-		auto glyphs = GlyphEnumerator( text );
+		CodepointEnumerator codepoints{ text };
+		auto previous = utf8::uint32_t( 0 );
 		auto width = 0.0f;
 		auto maxHeight = 0.0f;
 		auto minOffY = 0.0f;
 
-		while (glyphs)
+		while (codepoints)
 		{
-			auto glyph = glyphs.Next();
+			auto codepoint = codepoints.Next();
+			auto glyph = GetGlyph( codepoint, true );
 
 			if (minOffY == 0)
 				minOffY = static_cast<float_t>(glyph.OffsetY) - static_cast<float_t>(glyph.Height);
 
-			width += glyph.AdvanceX;
+			width += Kerning( previous, codepoint ) + glyph.AdvanceX;
+			previous = codepoint;
 
 			maxHeight = glm::max( glyph.Height, static_cast<float_t>(glyph.Height) );
 			minOffY = glm::min( minOffY, static_cast<float_t>(glyph.OffsetY) - static_cast<float_t>(glyph.Height) );
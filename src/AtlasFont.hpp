@@ -83,6 +83,8 @@ namespace kodogl
 	//
 	class AtlasFont
 	{
+		friend Atlas;
+
 	public:
 
 		static constexpr auto NullCodepoint = size_t( -1 );
@@ -90,11 +92,19 @@ namespace kodogl
 
 		const float_t Size;
 
+		// Whether the glyphs are signed distance fields, to be drawn with the distance field shader at any size.
+		const bool DistanceField;
+
 		Atlas& atlas;
 
 	private:
 
-		std::unordered_map<utf8::uint32_t, AtlasGlyph> glyphs;
+		// Glyphs rasterized so far; the rest are rasterized from the face on first use.
+		mutable GlyphTable glyphs;
+		KerningTable kerning;
+		AtlasFaceOpener open;
+		// Opened on the first miss when the font was read from a cache.
+		mutable std::unique_ptr<FT_FaceRec_, FT_Face_Deleter> face;
 
 		//
 		// This field is simply used to compute a default line spacing (i.e., the baseline-to-baseline distance) when writing text with this font. 
@@ -138,6 +148,14 @@ namespace kodogl
 
 		float_t BaselineToBaseline;
 
+		//
+		// Distance in pixels from the top of a line, BaselineToBaseline high, down to its baseline.
+		//
+		float_t Ascender() const
+		{
+			return ascender * 100.0f;
+		}
+
 		const Atlas& GetAtlas() const
 		{
 			return atlas;
@@ -150,8 +168,36 @@ namespace kodogl
 
 		GlyphEnumerator GlyphEnumerator( const std::string& str, bool fallBack = false ) const;
 
-		bool HasGlyph( utf8::uint32_t codepoint ) const { return glyphs.count( codepoint ) > 0; }
-		const AtlasGlyph& GetGlyph( utf8::uint32_t codepoint, bool fallback = false ) const;
+		bool HasGlyph( utf8::uint32_t codepoint ) const { return glyphs.Find( codepoint ) != GlyphTable::NoSlot; }
+
+		//
+		// The slot of the glyph of a codepoint within Glyphs(), rasterizing it on first use.
+		// Slots stay valid until the atlas page holding the glyph is cleared.
+		//
+		uint32_t FindGlyph( utf8::uint32_t codepoint, bool fallback = false ) const;
+
+		AtlasGlyph GetGlyph( utf8::uint32_t codepoint, bool fallback = false ) const
+		{
+			return glyphs.At( FindGlyph( codepoint, fallback ) );
+		}
+
+		const GlyphTable& Glyphs() const
+		{
+			return glyphs;
+		}
+
+		//
+		// Keep pages of the atlas from being cleared in this frame, for glyphs drawn without being looked up.
+		//
+		void Touch( const std::vector<uint32_t>& pages ) const;
+
+		//
+		// The kerning in pixels to add to the advance of the previous codepoint, when followed by codepoint.
+		//
+		float_t Kerning( utf8::uint32_t previous, utf8::uint32_t codepoint ) const
+		{
+			return kerning.Get( previous, codepoint );
+		}
 
 		glm::vec2 Measure( const std::string& text ) const;
 	};
@@ -171,7 +217,7 @@ namespace kodogl
 		{
 		}
 
-		const AtlasGlyph& Next()
+		AtlasGlyph Next()
 		{
 			auto codepoint = codepoints.Next();
 
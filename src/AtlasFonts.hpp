@@ -2,21 +2,14 @@
 
 #include <glm/glm.hpp>
 
+#include <functional>
+
+#include "Kerning.hpp"
+#include "SkylinePacker.hpp"
 #include "VertexBuffer.hpp"
 
 namespace kodogl
 {
-	struct Region
-	{
-		int32_t X;
-		int32_t Y;
-		int32_t W;
-		int32_t H;
-
-		Region() : X( 0 ), Y( 0 ), W( 0 ), H( 0 ) {}
-		Region( int32_t x, int32_t y, int32_t width, int32_t height ) : X( x ), Y( y ), W( width ), H( height ) { }
-	};
-
 	struct NormalizedRegion
 	{
 		float_t L, T, R, B;
@@ -61,17 +54,6 @@ namespace kodogl
 		operator bool() const { return citer != cend; }
 	};
 
-	// 
-	// A structure that describes a kerning value relatively to a Unicode codepoint.
-	// 
-	struct TextureFontKerning
-	{
-		// Unicode codepoint in UTF-32 LE encoding.
-		utf8::uint32_t Codepoint;
-		// Kerning value (in fractional pixels).
-		float_t Value;
-	};
-
 	//
 	// A structure that describes a glyph.
 	//
@@ -97,28 +79,230 @@ namespace kodogl
 		// used to increment the pen position when the glyph is drawn as part of a string of text.
 		const float_t AdvanceY;
 
-		// Normalized region occupied by this glyph within a texture atlas.
+		// Normalized region occupied by this glyph within a page of a texture atlas.
 		const NormalizedRegion Region;
+		// Page of the texture atlas holding the glyph, the layer of the atlas texture.
+		const uint32_t Page;
 
-		AtlasGlyph() : Codepoint( 0 ), Width( 0 ), Height( 0 ), OffsetX( 0 ), OffsetY( 0 ), AdvanceX( 0 ), AdvanceY( 0 ) {}
-		AtlasGlyph( uint32_t codepoint, const NormalizedRegion& region ) :
+		AtlasGlyph() : Codepoint( 0 ), Width( 0 ), Height( 0 ), OffsetX( 0 ), OffsetY( 0 ), AdvanceX( 0 ), AdvanceY( 0 ), Page( 0 ) {}
+		AtlasGlyph( uint32_t codepoint, const NormalizedRegion& region, uint32_t page = 0 ) :
 			Codepoint( codepoint ),
 			Width( 0 ), Height( 0 ),
 			OffsetX( 0 ), OffsetY( 0 ),
 			AdvanceX( 0 ), AdvanceY( 0 ),
-			Region( region )
+			Region( region ),
+			Page( page )
 		{
 		}
-		AtlasGlyph( uint32_t cp, float_t w, float_t h, float_t xoff, float_t yoff, float_t xadv, float_t yadv, const NormalizedRegion& region ) :
+		AtlasGlyph( uint32_t cp, float_t w, float_t h, float_t xoff, float_t yoff, float_t xadv, float_t yadv, const NormalizedRegion& region, uint32_t page = 0 ) :
 			Codepoint( cp ),
 			Width( w ), Height( h ),
 			OffsetX( xoff ), OffsetY( yoff ),
 			AdvanceX( xadv ), AdvanceY( yadv ),
-			Region( region )
+			Region( region ),
+			Page( page )
+		{
+		}
+	};
+
+	//
+	// The glyphs of a font, found by codepoint through a page table: Latin-1 directly, other codepoints
+	// through pages of 256 allocated on first use. Each glyph has a slot, and the metrics used by text layout
+	// are kept in arrays of their own indexed by the slot. Codepoints the face has no glyph for are remembered
+	// as missing, so they aren't looked up in the face again.
+	//
+	class GlyphTable
+	{
+		typedef std::array<uint32_t, 256> CodepointPage;
+
+		CodepointPage latin1;
+		// Pages of the codepoints from 256 on, by codepoint >> 8.
+		std::vector<std::unique_ptr<CodepointPage>> pages;
+
+		// Hot: advance, then left bearing, top bearing, width and height.
+		std::vector<float_t> advances;
+		std::vector<glm::vec4> boxes;
+		std::vector<NormalizedRegion> regions;
+		std::vector<uint32_t> pagesOfAtlas;
+
+		// Cold.
+		std::vector<utf8::uint32_t> codepoints;
+		std::vector<float_t> advancesY;
+
+		std::vector<uint32_t> freeSlots;
+		size_t countOfGlyphs;
+
+		// Marks a codepoint the face has no glyph for.
+		static constexpr uint32_t MissingSlot = uint32_t( -2 );
+
+		uint32_t Lookup( utf8::uint32_t codepoint ) const
+		{
+			if (codepoint < 256)
+				return latin1[codepoint];
+
+			auto high = static_cast<size_t>(codepoint >> 8);
+
+			if (high >= pages.size() || !pages[high])
+				return NoSlot;
+
+			return (*pages[high])[codepoint & 0xFF];
+		}
+
+		uint32_t& Entry( utf8::uint32_t codepoint )
+		{
+			if (codepoint < 256)
+				return latin1[codepoint];
+
+			auto high = static_cast<size_t>(codepoint >> 8);
+
+			if (high >= pages.size())
+				pages.resize( high + 1 );
+
+			if (!pages[high])
+			{
+				pages[high] = std::make_unique<CodepointPage>();
+				pages[high]->fill( NoSlot );
+			}
+
+			return (*pages[high])[codepoint & 0xFF];
+		}
+
+	public:
+
+		static constexpr uint32_t NoSlot = uint32_t( -1 );
+		static constexpr utf8::uint32_t NoCodepoint = utf8::uint32_t( -1 );
+
+		GlyphTable() : countOfGlyphs( 0 )
+		{
+			latin1.fill( NoSlot );
+		}
+
+		GlyphTable( GlyphTable&& ) = default;
+		GlyphTable& operator = ( GlyphTable&& ) = default;
+
+		size_t size() const
 		{
+			return countOfGlyphs;
 		}
+
+		//
+		// The slot of the glyph of a codepoint, or NoSlot.
+		//
+		uint32_t Find( utf8::uint32_t codepoint ) const
+		{
+			auto slot = Lookup( codepoint );
+			return slot == MissingSlot ? NoSlot : slot;
+		}
+
+		//
+		// Whether the face is known to have no glyph for a codepoint.
+		//
+		bool Missing( utf8::uint32_t codepoint ) const
+		{
+			return Lookup( codepoint ) == MissingSlot;
+		}
+
+		//
+		// Remember that the face has no glyph for a codepoint.
+		//
+		void AddMissing( utf8::uint32_t codepoint )
+		{
+			auto& entry = Entry( codepoint );
+
+			if (entry == NoSlot)
+				entry = MissingSlot;
+		}
+
+		//
+		// Add or replace the glyph of its codepoint. Returns its slot.
+		//
+		uint32_t Add( const AtlasGlyph& glyph )
+		{
+			auto& entry = Entry( glyph.Codepoint );
+			auto slot = entry;
+
+			if (slot == NoSlot || slot == MissingSlot)
+			{
+				if (freeSlots.empty())
+				{
+					slot = static_cast<uint32_t>(codepoints.size());
+
+					advances.emplace_back();
+					boxes.emplace_back();
+					regions.emplace_back();
+					pagesOfAtlas.emplace_back();
+					codepoints.emplace_back();
+					advancesY.emplace_back();
+				}
+				else
+				{
+					slot = freeSlots.back();
+					freeSlots.pop_back();
+				}
+
+				entry = slot;
+				countOfGlyphs++;
+			}
+
+			advances[slot] = glyph.AdvanceX;
+			boxes[slot] = glm::vec4( glyph.OffsetX, glyph.OffsetY, glyph.Width, glyph.Height );
+			regions[slot] = glyph.Region;
+			pagesOfAtlas[slot] = glyph.Page;
+			codepoints[slot] = glyph.Codepoint;
+			advancesY[slot] = glyph.AdvanceY;
+
+			return slot;
+		}
+
+		//
+		// Remove the glyphs on a page of the atlas.
+		//
+		void RemovePage( uint32_t page )
+		{
+			for (uint32_t slot = 0; slot < codepoints.size(); slot++)
+			{
+				if (codepoints[slot] == NoCodepoint || pagesOfAtlas[slot] != page)
+					continue;
+
+				Entry( codepoints[slot] ) = NoSlot;
+				codepoints[slot] = NoCodepoint;
+				freeSlots.push_back( slot );
+				countOfGlyphs--;
+			}
+		}
+
+		//
+		// Call a function with each glyph.
+		//
+		template<typename TFunction>
+		void ForEach( TFunction function ) const
+		{
+			for (uint32_t slot = 0; slot < codepoints.size(); slot++)
+			{
+				if (codepoints[slot] != NoCodepoint)
+					function( At( slot ) );
+			}
+		}
+
+		AtlasGlyph At( uint32_t slot ) const
+		{
+			const auto& box = boxes[slot];
+			return AtlasGlyph{ codepoints[slot], box.z, box.w, box.x, box.y, advances[slot], advancesY[slot], regions[slot], pagesOfAtlas[slot] };
+		}
+
+		float_t AdvanceX( uint32_t slot ) const { return advances[slot]; }
+		float_t AdvanceY( uint32_t slot ) const { return advancesY[slot]; }
+		// (OffsetX, OffsetY, Width, Height)
+		const glm::vec4& Box( uint32_t slot ) const { return boxes[slot]; }
+		const NormalizedRegion& Region( uint32_t slot ) const { return regions[slot]; }
+		uint32_t Page( uint32_t slot ) const { return pagesOfAtlas[slot]; }
 	};
 
+	typedef decltype(&FT_Done_Face) FT_Face_Deleter;
+
+	// Opens the face of a font with a FreeType library, sized for the atlas.
+	typedef std::function<std::unique_ptr<FT_FaceRec_, FT_Face_Deleter>( FT_Library )> AtlasFaceOpener;
+
 	struct AtlasLoaderFont
 	{
 		const float_t Size;
@@ -130,9 +314,17 @@ namespace kodogl
 		float_t underlineThickness;
 		float_t BaselineToBaseline;
 
-		std::unordered_map<utf8::uint32_t, AtlasGlyph> glyphs;
+		GlyphTable glyphs;
+		KerningTable kerning;
+
+		// Kept open to rasterize glyphs on first use; fonts read from a cache open it on their first miss.
+		AtlasFaceOpener open;
+		std::unique_ptr<FT_FaceRec_, FT_Face_Deleter> face;
+		bool distanceField;
 
-		explicit AtlasLoaderFont( float_t size ) : Size( size ), height( 0 ), linegap( 0 ), ascender( 0 ), descender( 0 ), underlinePosition( 0 ), underlineThickness( 0 ), BaselineToBaseline( 0 )
+		explicit AtlasLoaderFont( float_t size, AtlasFaceOpener open, bool distanceField ) :
+			Size( size ), height( 0 ), linegap( 0 ), ascender( 0 ), descender( 0 ), underlinePosition( 0 ), underlineThickness( 0 ), BaselineToBaseline( 0 ),
+			open( std::move( open ) ), face( nullptr, FT_Done_Face ), distanceField( distanceField )
 		{
 
 		}
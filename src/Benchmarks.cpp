@@ -0,0 +1,78 @@
+#include "Benchmarks.hpp"
+#include "SkylinePacker.hpp"
+#include "Pixels.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+
+namespace kodogl
+{
+	PackingBenchmark BenchmarkPacking(size_t countOfGlyphs, size_t sizeOfPage, bool sortedByHeight)
+	{
+		std::mt19937 random(40);
+		std::uniform_int_distribution<int32_t> widths(4, 24);
+		std::uniform_int_distribution<int32_t> heights(6, 30);
+
+		std::vector<Region> glyphs(countOfGlyphs);
+
+		for (auto& glyph : glyphs)
+		{
+			glyph.W = widths(random);
+			glyph.H = heights(random);
+		}
+
+		PackingBenchmark result{ 0, 0.0, 0.0, 0 };
+
+		auto start = std::chrono::steady_clock::now();
+
+		if (sortedByHeight)
+			std::stable_sort(glyphs.begin(), glyphs.end(), [](const Region& a, const Region& b) { return a.H > b.H; });
+
+		SkylinePacker packer(sizeOfPage, sizeOfPage);
+		int32_t top = 1;
+
+		for (const auto& glyph : glyphs)
+		{
+			Region region;
+
+			if (!packer.GetRegion(glyph.W, glyph.H, region))
+				continue;
+
+			result.Packed++;
+			result.MostNodes = glm::max(result.MostNodes, packer.Nodes().size());
+			top = glm::max(top, region.Y + region.H);
+		}
+
+		result.Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		// The border of the page is never packed.
+		auto area = static_cast<double>(sizeOfPage - 2) * (top - 1);
+		result.Efficiency = area > 0.0 ? packer.Used() / area : 0.0;
+
+		return result;
+	}
+
+	double BenchmarkConversion(glm::uint32 width, glm::uint32 height, glm::uint32 channels, GLenum format, glm::uint32 repeats)
+	{
+		auto bytesPerPixel = format == gl::R8 ? 1u : 4u;
+
+		std::mt19937 random(33);
+		std::vector<glm::uint8> source(static_cast<size_t>(width) * height * channels);
+		std::vector<glm::uint8> destination(static_cast<size_t>(width) * height * bytesPerPixel);
+
+		std::generate(source.begin(), source.end(), [&random]() { return static_cast<glm::uint8>(random()); });
+
+		repeats = glm::max(1u, repeats);
+
+		auto start = std::chrono::steady_clock::now();
+
+		for (glm::uint32 r = 0; r < repeats; r++)
+		{
+			for (glm::uint32 y = 0; y < height; y++)
+				ConvertRow(source.data() + static_cast<size_t>(y) * width * channels, channels, destination.data() + static_cast<size_t>(height - 1 - y) * width * bytesPerPixel, format, width);
+		}
+
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / repeats;
+	}
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "kodo-gl.hpp"
+
+namespace kodogl
+{
+	struct PackingBenchmark
+	{
+		// Glyphs that fit in the page.
+		size_t Packed;
+		double Seconds;
+		// Area of the packed glyphs over the area of the page below the highest of them.
+		double Efficiency;
+		// Nodes of the skyline at most, which bounds the work of placing a glyph.
+		size_t MostNodes;
+	};
+
+	//
+	// Pack glyphs of random sizes, 4-24 by 6-30 pixels, into a square page with the skyline packer, tallest first
+	// like AtlasLoader when sorted. The sizes are the same on every run.
+	//
+	PackingBenchmark BenchmarkPacking( size_t countOfGlyphs, size_t sizeOfPage, bool sortedByHeight );
+
+	//
+	// Seconds to convert an image of random pixels with 1-4 channels to R8 or RGBA8 with ConvertRow, flipped like TextureLoader,
+	// on average over a number of repeats.
+	//
+	double BenchmarkConversion( glm::uint32 width, glm::uint32 height, glm::uint32 channels, GLenum format, glm::uint32 repeats );
+}
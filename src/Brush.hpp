@@ -2,6 +2,8 @@
 
 namespace kodogl
 {
+	class Texture;
+
 	enum class BrushType
 	{
 		Linear,
@@ -61,15 +63,43 @@ namespace kodogl
 			ColorA = glm::packUnorm4x8( color );
 			ColorB = ColorA;
 		}
+
+	protected:
+
+		ColorBrush( BrushType type, const glm::vec4& weights, const glm::vec4& colorA, const glm::vec4& colorB, glm::uint8 opacity = 255 ) :
+			Brush( type, opacity ),
+			Weights( weights ),
+			ColorA( glm::packUnorm4x8( colorA ) ),
+			ColorB( glm::packUnorm4x8( colorB ) )
+		{
+		}
 	};
 
 	struct TextureBrush : Brush
 	{
+		const kodogl::Texture* Texture;
 
+		TextureBrush( const kodogl::Texture* texture, glm::uint8 opacity = 255 ) :
+			Brush( BrushType::Texture, opacity ),
+			Texture( texture )
+		{
+		}
 	};
 
 	struct TextureMaskBrush : ColorBrush
 	{
-		
+		const kodogl::Texture* Mask;
+
+		TextureMaskBrush( const kodogl::Texture* mask, const glm::vec4& color, glm::uint8 opacity = 255 ) :
+			ColorBrush( BrushType::TextureMask, glm::vec4( 1.0f ), color, color, opacity ),
+			Mask( mask )
+		{
+		}
+
+		TextureMaskBrush( const kodogl::Texture* mask, const glm::vec4& colorA, const glm::vec4& colorB, glm::uint8 opacity = 255 ) :
+			ColorBrush( BrushType::TextureMask, glm::vec4( 0.0f, 1.0f, 1.0f, 0.0f ), colorA, colorB, opacity ),
+			Mask( mask )
+		{
+		}
 	};
 }
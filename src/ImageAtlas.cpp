@@ -0,0 +1,193 @@
+#include "ImageAtlas.hpp"
+
+#include "Texture.h"
+
+namespace kodogl
+{
+	ImageAtlas::ImageAtlas(GLenum format) :
+		format(format)
+	{
+	}
+
+	ImageAtlas::~ImageAtlas()
+	{
+	}
+
+	bool ImageAtlas::Packable(GLenum format, glm::uint32 width, glm::uint32 height)
+	{
+		return (format == gl::R8 || format == gl::RGBA8) && width <= MaximumSize && height <= MaximumSize;
+	}
+
+	size_t ImageAtlas::Size() const
+	{
+		if (pages.empty())
+			return 0;
+
+		size_t sizeOfPage = 0;
+
+		for (glm::uint32 i = 0; i < pages.front()->Array->Levels(); i++)
+			sizeOfPage += TextureCompressor::SizeOfLevel(format, glm::max(1u, SizeOfPage >> i), glm::max(1u, SizeOfPage >> i));
+
+		return sizeOfPage * pages.size();
+	}
+
+	bool ImageAtlas::Reuse(Page& page, glm::int32 cellsWide, glm::int32 cellsHigh, Region& cells)
+	{
+		auto best = page.FreeCells.end();
+
+		for (auto it = page.FreeCells.begin(); it != page.FreeCells.end(); ++it)
+		{
+			if (it->W >= cellsWide && it->H >= cellsHigh && (best == page.FreeCells.end() || it->W * it->H < best->W * best->H))
+				best = it;
+		}
+
+		if (best == page.FreeCells.end())
+			return false;
+
+		auto free = *best;
+		*best = page.FreeCells.back();
+		page.FreeCells.pop_back();
+
+		cells = Region{ free.X, free.Y, cellsWide, cellsHigh };
+
+		// The cells right of the image, as high as the free ones, and those above it.
+		if (free.W > cellsWide)
+			page.FreeCells.push_back(Region{ free.X + cellsWide, free.Y, free.W - cellsWide, free.H });
+
+		if (free.H > cellsHigh)
+			page.FreeCells.push_back(Region{ free.X, free.Y + cellsHigh, cellsWide, free.H - cellsHigh });
+
+		return true;
+	}
+
+	ImageAtlas::Page& ImageAtlas::AllocatePage()
+	{
+		auto found = std::find_if(arrays.begin(), arrays.end(), [](const std::unique_ptr<TextureArray>& a) { return !a->Full(); });
+
+		if (found == arrays.end())
+		{
+			arrays.emplace_back(std::make_unique<TextureArray>(format, SizeOfPage, SizeOfPage));
+			found = arrays.end() - 1;
+		}
+
+		auto& pageArray = **found;
+		auto pageLayer = pageArray.Allocate();
+
+		pages.emplace_back(std::make_unique<Page>(Page{ &pageArray, pageLayer, SkylinePacker(SizeOfPage / Alignment, SizeOfPage / Alignment), 0, {} }));
+		return *pages.back();
+	}
+
+	TextureArray& ImageAtlas::Add(const glm::uint8* pixels, glm::uint32 width, glm::uint32 height, glm::uint32& layer, glm::vec4& region, Region& cells)
+	{
+		auto bytesPerPixel = format == gl::R8 ? 1u : 4u;
+
+		auto cellsWide = static_cast<glm::int32>((width + Gutter * 2 + Alignment - 1) / Alignment);
+		auto cellsHigh = static_cast<glm::int32>((height + Gutter * 2 + Alignment - 1) / Alignment);
+
+		Page* page = nullptr;
+
+		//
+		// Cells of released images first, then the skyline of each page, then a new page.
+		//
+		for (auto& candidate : pages)
+		{
+			if (Reuse(*candidate, cellsWide, cellsHigh, cells))
+			{
+				page = candidate.get();
+				break;
+			}
+		}
+
+		for (size_t i = 0; page == nullptr && i < pages.size(); i++)
+		{
+			if (pages[i]->Packer.GetRegion(cellsWide, cellsHigh, cells))
+				page = pages[i].get();
+		}
+
+		if (page == nullptr)
+		{
+			page = &AllocatePage();
+
+			if (!page->Packer.GetRegion(cellsWide, cellsHigh, cells))
+				throw TextureException("Image doesn't fit in an atlas page.");
+		}
+
+		//
+		// Fill the cells, repeating the edges of the image into the gutter and the rounding.
+		//
+		auto blockWidth = cellsWide * Alignment;
+		auto blockHeight = cellsHigh * Alignment;
+
+		std::vector<glm::uint8> block(static_cast<size_t>(blockWidth) * blockHeight * bytesPerPixel);
+
+		for (glm::uint32 y = 0; y < blockHeight; y++)
+		{
+			auto sourceY = static_cast<glm::uint32>(glm::clamp(static_cast<int>(y) - static_cast<int>(Gutter), 0, static_cast<int>(height) - 1));
+			const auto* source = pixels + static_cast<size_t>(sourceY) * width * bytesPerPixel;
+			auto* destination = block.data() + static_cast<size_t>(y) * blockWidth * bytesPerPixel;
+
+			for (glm::uint32 x = 0; x < blockWidth; x++)
+			{
+				auto sourceX = static_cast<glm::uint32>(glm::clamp(static_cast<int>(x) - static_cast<int>(Gutter), 0, static_cast<int>(width) - 1));
+				memcpy(destination + x * bytesPerPixel, source + sourceX * bytesPerPixel, bytesPerPixel);
+			}
+		}
+
+		//
+		// Upload the block and its mipmaps. The block is aligned to cells, so each level covers only its own texels.
+		//
+		auto x = static_cast<glm::uint32>(cells.X) * Alignment;
+		auto y = static_cast<glm::uint32>(cells.Y) * Alignment;
+
+		auto& textureArray = *page->Array;
+		std::vector<glm::uint8> nextLevel;
+
+		for (glm::uint32 i = 0; i < textureArray.Levels(); i++)
+		{
+			if (i > 0)
+			{
+				Downsample(block, blockWidth >> (i - 1), blockHeight >> (i - 1), bytesPerPixel, nextLevel);
+				block.swap(nextLevel);
+			}
+
+			textureArray.Upload(page->Layer, i, x >> i, y >> i, blockWidth >> i, blockHeight >> i, block.data());
+		}
+
+		page->CountOfImages++;
+		layer = page->Layer;
+
+		auto left = static_cast<float>(x + Gutter) / SizeOfPage;
+		auto bottom = static_cast<float>(y + Gutter) / SizeOfPage;
+
+		region = glm::vec4(left, bottom + static_cast<float>(height) / SizeOfPage, left + static_cast<float>(width) / SizeOfPage, bottom);
+		return textureArray;
+	}
+
+	void ImageAtlas::Release(const TextureArray& textureArray, glm::uint32 layer, const Region& cells)
+	{
+		auto it = std::find_if(pages.begin(), pages.end(), [&textureArray, layer](const std::unique_ptr<Page>& page) { return page->Array == &textureArray && page->Layer == layer; });
+
+		if (it == pages.end())
+			return;
+
+		if (--(*it)->CountOfImages == 0)
+		{
+			(*it)->Array->Release(layer);
+			pages.erase(it);
+			return;
+		}
+
+		(*it)->FreeCells.push_back(cells);
+	}
+
+	void ImageAtlas::Trim()
+	{
+		arrays.erase(std::remove_if(arrays.begin(), arrays.end(), [](const std::unique_ptr<TextureArray>& textureArray) { return textureArray->Empty(); }), arrays.end());
+	}
+
+	void ImageAtlas::Abandon()
+	{
+		for (auto& textureArray : arrays)
+			textureArray->Abandon();
+	}
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "kodo-gl.hpp"
+#include "SkylinePacker.hpp"
+
+namespace kodogl
+{
+	class TextureArray;
+
+	//
+	// Packs small images of one format into shared pages, so that many of them can be drawn with a single texture binding.
+	// Pages are layers of texture arrays of the atlas's own, which no other texture writes to.
+	//
+	// Images are packed in cells of Alignment pixels, which keeps them apart at every mipmap level,
+	// and are surrounded by a gutter repeating their edges, so that filtering near an edge doesn't pick up a neighbour.
+	// The cells of released images are packed again, and a page without images is released.
+	//
+	class ImageAtlas : public nocopy
+	{
+		struct Page
+		{
+			TextureArray* Array;
+			glm::uint32 Layer;
+			SkylinePacker Packer;
+			glm::uint32 CountOfImages;
+			// Cells of released images, below the skyline.
+			std::vector<Region> FreeCells;
+		};
+
+		GLenum format;
+
+		std::vector<std::unique_ptr<TextureArray>> arrays;
+		std::vector<std::unique_ptr<Page>> pages;
+
+		//
+		// Take cells of a page from those released, the smallest with room, splitting off the rest.
+		//
+		static bool Reuse( Page& page, glm::int32 cellsWide, glm::int32 cellsHigh, Region& cells );
+
+		Page& AllocatePage();
+
+	public:
+
+		static constexpr glm::uint32 SizeOfPage = 1024;
+		// Images larger than this in either dimension get layers of their own.
+		static constexpr glm::uint32 MaximumSize = 128;
+		// Cell size; 1 << (levels - 1) for the 4 levels of a page.
+		static constexpr glm::uint32 Alignment = 8;
+		static constexpr glm::uint32 Gutter = 4;
+
+		explicit ImageAtlas( GLenum format );
+		~ImageAtlas();
+
+		GLenum Format() const
+		{
+			return format;
+		}
+
+		//
+		// Whether an image of the specified format and size is packed into an atlas. Block compressed images aren't.
+		//
+		static bool Packable( GLenum format, glm::uint32 width, glm::uint32 height );
+
+		//
+		// GPU memory of the pages, including their mipmaps. Pages are charged whole, however much of them is packed.
+		//
+		size_t Size() const;
+
+		//
+		// Pack an uncompressed image (bottom row first, tightly packed) and upload it with its mipmaps.
+		// Returns the texture array holding the page, the layer of the page, the region of the image
+		// as (left, top, right, bottom) texture coordinates and the cells of the page it's packed into.
+		//
+		TextureArray& Add( const glm::uint8* pixels, glm::uint32 width, glm::uint32 height, glm::uint32& layer, glm::vec4& region, Region& cells );
+
+		//
+		// Release the cells of an image of a page, to be packed again. The page is released once none of its images are left.
+		//
+		void Release( const TextureArray& textureArray, glm::uint32 layer, const Region& cells );
+
+		//
+		// Delete the texture arrays without any page in use.
+		//
+		void Trim();
+
+		//
+		// Forget the textures of the pages without deleting them, once the GL context holding them is gone.
+		//
+		void Abandon();
+	};
+}
@@ -0,0 +1,397 @@
+#include "Kerning.hpp"
+
+#include FT_TRUETYPE_TABLES_H
+#include FT_TRUETYPE_TAGS_H
+
+namespace kodogl
+{
+	//
+	// A table of a TrueType or OpenType face. Reads past its end give 0, so malformed tables yield no pairs.
+	//
+	class SfntTable
+	{
+		std::vector<FT_Byte> data;
+
+	public:
+
+		SfntTable(FT_Face face, FT_ULong tag)
+		{
+			FT_ULong length = 0;
+
+			if (FT_Load_Sfnt_Table(face, tag, 0, nullptr, &length) || length == 0)
+				return;
+
+			data.resize(length);
+
+			if (FT_Load_Sfnt_Table(face, tag, 0, data.data(), &length))
+				data.clear();
+		}
+
+		bool Empty() const
+		{
+			return data.empty();
+		}
+
+		uint16_t U16(size_t offset) const
+		{
+			return offset + 2 <= data.size() ? static_cast<uint16_t>(data[offset] << 8 | data[offset + 1]) : 0;
+		}
+
+		int16_t S16(size_t offset) const
+		{
+			return static_cast<int16_t>(U16(offset));
+		}
+
+		uint32_t U32(size_t offset) const
+		{
+			return static_cast<uint32_t>(U16(offset)) << 16 | U16(offset + 2);
+		}
+	};
+
+	// Kerning of a pair of glyph indices, first << 16 | second.
+	typedef std::unordered_map<uint32_t, int32_t> GlyphKerning;
+
+	static uint32_t PairOf(uint32_t first, uint32_t second)
+	{
+		return first << 16 | second;
+	}
+
+	//
+	// Size of a GPOS value record, and the offset of its XAdvance, the kerning, within it.
+	//
+	static size_t SizeOfValueRecord(uint16_t valueFormat)
+	{
+		size_t size = 0;
+
+		for (auto bits = valueFormat; bits != 0; bits >>= 1)
+			size += (bits & 1) * 2;
+
+		return size;
+	}
+
+	static size_t OffsetOfXAdvance(uint16_t valueFormat)
+	{
+		return SizeOfValueRecord(valueFormat & 0x0003);
+	}
+
+	//
+	// The glyphs of a coverage table, with their coverage indices.
+	//
+	static std::vector<std::pair<uint16_t, uint16_t>> Coverage(const SfntTable& table, size_t offset)
+	{
+		std::vector<std::pair<uint16_t, uint16_t>> glyphs;
+
+		auto format = table.U16(offset);
+		auto count = table.U16(offset + 2);
+
+		if (format == 1)
+		{
+			for (uint16_t i = 0; i < count; i++)
+				glyphs.emplace_back(table.U16(offset + 4 + i * 2), i);
+		}
+		else if (format == 2)
+		{
+			for (uint16_t i = 0; i < count; i++)
+			{
+				auto range = offset + 4 + i * 6;
+				auto start = table.U16(range);
+				auto end = table.U16(range + 2);
+				auto index = table.U16(range + 4);
+
+				for (uint32_t glyph = start; glyph <= end; glyph++)
+					glyphs.emplace_back(static_cast<uint16_t>(glyph), static_cast<uint16_t>(index + glyph - start));
+			}
+		}
+
+		return glyphs;
+	}
+
+	//
+	// The class of a glyph in a class definition table; glyphs it doesn't list are of class 0.
+	//
+	static uint16_t ClassOf(const SfntTable& table, size_t offset, uint16_t glyph)
+	{
+		auto format = table.U16(offset);
+
+		if (format == 1)
+		{
+			auto start = table.U16(offset + 2);
+			auto count = table.U16(offset + 4);
+
+			if (glyph >= start && glyph - start < count)
+				return table.U16(offset + 6 + (glyph - start) * 2);
+		}
+		else if (format == 2)
+		{
+			auto count = table.U16(offset + 2);
+
+			for (uint16_t i = 0; i < count; i++)
+			{
+				auto range = offset + 4 + i * 6;
+
+				if (glyph >= table.U16(range) && glyph <= table.U16(range + 2))
+					return table.U16(range + 4);
+			}
+		}
+
+		return 0;
+	}
+
+	//
+	// Add the pairs of a pair adjustment subtable not yet adjusted by an earlier subtable of the lookup.
+	// Only pairs of glyphs with codepoints are added; the others are never drawn without shaping.
+	//
+	static void PairAdjustment(const SfntTable& gpos, size_t subtable, const std::vector<bool>& mapped, const std::vector<uint16_t>& mappedGlyphs, GlyphKerning& pairs)
+	{
+		auto format = gpos.U16(subtable);
+		auto coverage = Coverage(gpos, subtable + gpos.U16(subtable + 2));
+		auto valueFormat1 = gpos.U16(subtable + 4);
+		auto valueFormat2 = gpos.U16(subtable + 6);
+
+		if ((valueFormat1 & 0x0004) == 0)
+			return;
+
+		auto sizeOfRecords = SizeOfValueRecord(valueFormat1) + SizeOfValueRecord(valueFormat2);
+		auto xAdvance = OffsetOfXAdvance(valueFormat1);
+
+		auto isMapped = [&mapped](uint16_t glyph) { return glyph < mapped.size() && mapped[glyph]; };
+
+		if (format == 1)
+		{
+			//
+			// A set of pairs for each first glyph.
+			//
+			for (const auto& covered : coverage)
+			{
+				if (!isMapped(covered.first))
+					continue;
+
+				auto pairSet = subtable + gpos.U16(subtable + 10 + covered.second * 2);
+				auto count = gpos.U16(pairSet);
+
+				for (uint16_t i = 0; i < count; i++)
+				{
+					auto record = pairSet + 2 + i * (2 + sizeOfRecords);
+					auto second = gpos.U16(record);
+					auto value = gpos.S16(record + 2 + xAdvance);
+
+					if (value != 0 && isMapped(second))
+						pairs.emplace(PairOf(covered.first, second), value);
+				}
+			}
+		}
+		else if (format == 2)
+		{
+			//
+			// A value for each pair of classes.
+			//
+			auto classDef1 = subtable + gpos.U16(subtable + 8);
+			auto classDef2 = subtable + gpos.U16(subtable + 10);
+			auto countOfClass1 = gpos.U16(subtable + 12);
+			auto countOfClass2 = gpos.U16(subtable + 14);
+
+			std::vector<std::vector<uint16_t>> glyphsOfClass2(countOfClass2);
+
+			for (auto glyph : mappedGlyphs)
+			{
+				auto class2 = ClassOf(gpos, classDef2, glyph);
+
+				if (class2 < countOfClass2)
+					glyphsOfClass2[class2].push_back(glyph);
+			}
+
+			for (const auto& covered : coverage)
+			{
+				auto class1 = ClassOf(gpos, classDef1, covered.first);
+
+				if (!isMapped(covered.first) || class1 >= countOfClass1)
+					continue;
+
+				for (uint16_t class2 = 0; class2 < countOfClass2; class2++)
+				{
+					auto record = subtable + 16 + (static_cast<size_t>(class1) * countOfClass2 + class2) * sizeOfRecords;
+					auto value = gpos.S16(record + xAdvance);
+
+					if (value == 0)
+						continue;
+
+					for (auto second : glyphsOfClass2[class2])
+						pairs.emplace(PairOf(covered.first, second), value);
+				}
+			}
+		}
+	}
+
+	//
+	// Kerning of the lookups of the 'kern' feature. Returns false when the face has no such feature.
+	//
+	static bool LoadGposKerning(FT_Face face, const std::vector<bool>& mapped, const std::vector<uint16_t>& mappedGlyphs, GlyphKerning& kerning)
+	{
+		SfntTable gpos(face, TTAG_GPOS);
+
+		if (gpos.Empty())
+			return false;
+
+		size_t featureList = gpos.U16(6);
+		size_t lookupList = gpos.U16(8);
+
+		std::vector<uint16_t> lookups;
+
+		for (uint16_t i = 0, count = gpos.U16(featureList); i < count; i++)
+		{
+			auto record = featureList + 2 + i * 6;
+
+			if (gpos.U32(record) != FT_MAKE_TAG('k', 'e', 'r', 'n'))
+				continue;
+
+			auto feature = featureList + gpos.U16(record + 4);
+
+			for (uint16_t j = 0, countOfLookups = gpos.U16(feature + 2); j < countOfLookups; j++)
+				lookups.push_back(gpos.U16(feature + 4 + j * 2));
+		}
+
+		if (lookups.empty())
+			return false;
+
+		// Scripts and languages may share lookups; each applies once.
+		std::sort(lookups.begin(), lookups.end());
+		lookups.erase(std::unique(lookups.begin(), lookups.end()), lookups.end());
+
+		for (auto index : lookups)
+		{
+			auto lookup = lookupList + gpos.U16(lookupList + 2 + index * 2);
+			auto type = gpos.U16(lookup);
+
+			// Within a lookup the first subtable adjusting a pair wins, while the lookups add up.
+			GlyphKerning pairs;
+
+			for (uint16_t i = 0, count = gpos.U16(lookup + 4); i < count; i++)
+			{
+				auto subtable = lookup + gpos.U16(lookup + 6 + i * 2);
+
+				if (type == 9 && gpos.U16(subtable + 2) == 2)
+					PairAdjustment(gpos, subtable + gpos.U32(subtable + 4), mapped, mappedGlyphs, pairs);
+				else if (type == 2)
+					PairAdjustment(gpos, subtable, mapped, mappedGlyphs, pairs);
+			}
+
+			for (const auto& pair : pairs)
+				kerning[pair.first] += pair.second;
+		}
+
+		return true;
+	}
+
+	//
+	// Kerning of the horizontal format 0 subtables of a kern table.
+	//
+	static void LoadKernKerning(FT_Face face, const std::vector<bool>& mapped, GlyphKerning& kerning)
+	{
+		SfntTable kern(face, TTAG_kern);
+
+		// Only the Windows version of the table; the Apple one starts with a 32 bit version.
+		if (kern.Empty() || kern.U16(0) != 0)
+			return;
+
+		size_t subtable = 4;
+
+		for (uint16_t i = 0, count = kern.U16(2); i < count; i++)
+		{
+			auto length = kern.U16(subtable + 2);
+			auto coverage = kern.U16(subtable + 4);
+
+			// Format 0, horizontal, kerning rather than minimum values, not cross-stream.
+			if ((coverage >> 8) == 0 && (coverage & 0x0007) == 0x0001)
+			{
+				auto replace = (coverage & 0x0008) != 0;
+
+				for (uint16_t j = 0, countOfPairs = kern.U16(subtable + 6); j < countOfPairs; j++)
+				{
+					auto record = subtable + 14 + j * 6;
+					auto first = kern.U16(record);
+					auto second = kern.U16(record + 2);
+					auto value = kern.S16(record + 4);
+
+					if (first >= mapped.size() || second >= mapped.size() || !mapped[first] || !mapped[second])
+						continue;
+
+					if (replace)
+						kerning[PairOf(first, second)] = value;
+					else
+						kerning[PairOf(first, second)] += value;
+				}
+			}
+
+			if (length == 0)
+				break;
+
+			subtable += length;
+		}
+	}
+
+	std::vector<TextureFontKerning> LoadKerning(FT_Face face)
+	{
+		std::vector<TextureFontKerning> pairs;
+
+		if (!FT_IS_SFNT(face))
+			return pairs;
+
+		//
+		// The codepoints of each glyph, from the charmap of the face.
+		//
+		std::vector<std::pair<uint16_t, utf8::uint32_t>> codepoints;
+		std::vector<bool> mapped(static_cast<size_t>(face->num_glyphs), false);
+
+		FT_UInt glyphIndex;
+
+		for (auto codepoint = FT_Get_First_Char(face, &glyphIndex); glyphIndex != 0; codepoint = FT_Get_Next_Char(face, codepoint, &glyphIndex))
+		{
+			if (codepoint == 0 || glyphIndex >= mapped.size())
+				continue;
+
+			codepoints.emplace_back(static_cast<uint16_t>(glyphIndex), static_cast<utf8::uint32_t>(codepoint));
+			mapped[glyphIndex] = true;
+		}
+
+		std::sort(codepoints.begin(), codepoints.end());
+
+		std::vector<uint16_t> mappedGlyphs;
+
+		for (const auto& codepoint : codepoints)
+		{
+			if (mappedGlyphs.empty() || mappedGlyphs.back() != codepoint.first)
+				mappedGlyphs.push_back(codepoint.first);
+		}
+
+		GlyphKerning kerning;
+
+		if (!LoadGposKerning(face, mapped, mappedGlyphs, kerning))
+			LoadKernKerning(face, mapped, kerning);
+
+		//
+		// Glyph pairs to codepoint pairs; a glyph may have several codepoints.
+		//
+		auto codepointsOf = [&codepoints](uint16_t glyph)
+		{
+			return std::equal_range(codepoints.begin(), codepoints.end(), std::make_pair(glyph, utf8::uint32_t(0)),
+									[](const std::pair<uint16_t, utf8::uint32_t>& a, const std::pair<uint16_t, utf8::uint32_t>& b) { return a.first < b.first; });
+		};
+
+		for (const auto& pair : kerning)
+		{
+			if (pair.second == 0)
+				continue;
+
+			auto firsts = codepointsOf(static_cast<uint16_t>(pair.first >> 16));
+			auto seconds = codepointsOf(static_cast<uint16_t>(pair.first & 0xFFFF));
+
+			for (auto first = firsts.first; first != firsts.second; ++first)
+			{
+				for (auto second = seconds.first; second != seconds.second; ++second)
+					pairs.push_back(TextureFontKerning{ first->second, second->second, static_cast<float_t>(pair.second) });
+			}
+		}
+
+		return pairs;
+	}
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include "kodo-gl.hpp"
+
+#include <utf8/utf8.h>
+
+namespace kodogl
+{
+	//
+	// A structure that describes a kerning value relatively to a Unicode codepoint.
+	//
+	struct TextureFontKerning
+	{
+		// Unicode codepoint of the glyph preceding the kerned one, in UTF-32 LE encoding.
+		utf8::uint32_t Previous;
+		// Unicode codepoint in UTF-32 LE encoding.
+		utf8::uint32_t Codepoint;
+		// Kerning value (in fractional pixels).
+		float_t Value;
+	};
+
+	//
+	// The kerning pairs of a font, in an open addressed table of at least twice as many slots as pairs,
+	// so a pair is found in a probe or two.
+	//
+	class KerningTable
+	{
+		static constexpr utf8::uint32_t Empty = utf8::uint32_t( -1 );
+
+		std::vector<TextureFontKerning> slots;
+		size_t countOfPairs;
+
+		static size_t Hash( utf8::uint32_t previous, utf8::uint32_t codepoint )
+		{
+			auto hash = static_cast<uint32_t>(previous) * 0x9E3779B1u ^ static_cast<uint32_t>(codepoint) * 0x85EBCA77u;
+			return static_cast<size_t>(hash ^ (hash >> 15));
+		}
+
+	public:
+
+		KerningTable() : countOfPairs( 0 ) {}
+
+		explicit KerningTable( const std::vector<TextureFontKerning>& pairs ) : countOfPairs( 0 )
+		{
+			if (pairs.empty())
+				return;
+
+			size_t countOfSlots = 16;
+
+			while (countOfSlots < pairs.size() * 2)
+				countOfSlots *= 2;
+
+			slots.assign( countOfSlots, TextureFontKerning{ Empty, Empty, 0.0f } );
+
+			for (const auto& pair : pairs)
+			{
+				auto i = Hash( pair.Previous, pair.Codepoint ) & (countOfSlots - 1);
+
+				while (slots[i].Codepoint != Empty && (slots[i].Previous != pair.Previous || slots[i].Codepoint != pair.Codepoint))
+					i = (i + 1) & (countOfSlots - 1);
+
+				if (slots[i].Codepoint == Empty)
+					countOfPairs++;
+
+				slots[i] = pair;
+			}
+		}
+
+		size_t size() const
+		{
+			return countOfPairs;
+		}
+
+		//
+		// The kerning of a codepoint following another, 0 for pairs that aren't kerned.
+		//
+		float_t Get( utf8::uint32_t previous, utf8::uint32_t codepoint ) const
+		{
+			if (slots.empty())
+				return 0.0f;
+
+			auto mask = slots.size() - 1;
+
+			for (auto i = Hash( previous, codepoint ) & mask;; i = (i + 1) & mask)
+			{
+				const auto& slot = slots[i];
+
+				if (slot.Previous == previous && slot.Codepoint == codepoint)
+					return slot.Value;
+
+				if (slot.Codepoint == Empty)
+					return 0.0f;
+			}
+		}
+
+		//
+		// The kerned pairs, in no particular order.
+		//
+		std::vector<TextureFontKerning> Pairs() const
+		{
+			std::vector<TextureFontKerning> pairs;
+			pairs.reserve( countOfPairs );
+
+			for (const auto& slot : slots)
+			{
+				if (slot.Codepoint != Empty)
+					pairs.push_back( slot );
+			}
+
+			return pairs;
+		}
+	};
+
+	//
+	// Read the kerning pairs of the codepoints of a face, from the pair adjustments of the 'kern' feature of its GPOS table,
+	// or from its kern table when it has no such feature. Values are in font units.
+	//
+	std::vector<TextureFontKerning> LoadKerning( FT_Face face );
+}
@@ -0,0 +1,251 @@
+#include "LineLayout.hpp"
+#include "Atlas.hpp"
+
+namespace kodogl
+{
+	namespace
+	{
+		// Lines get items in steps of quads, with half again as many as they need, so typing rarely moves a line.
+		const glm::uint32 QuadsPerStep = 16;
+
+		glm::uint32 CapacityFor(glm::uint32 quadsLength)
+		{
+			auto capacity = quadsLength + quadsLength / 2;
+			return (capacity + QuadsPerStep - 1) / QuadsPerStep * QuadsPerStep;
+		}
+	}
+
+	LineLayout::LineLayout(const std::string& text, const AtlasFont& font, const glm::vec2& position, float_t size) :
+		font(font),
+		position(position),
+		origin(0.0f),
+		size(size),
+		lineHeight(font.BaselineToBaseline * (size > 0.0f ? size / font.Size : 1.0f)),
+		generation(0)
+	{
+		lines.emplace_back();
+		Insert(0, 0, text);
+
+		generation = font.GetAtlas().Generation();
+	}
+
+	void LineLayout::CheckPosition(size_t line, size_t column) const
+	{
+		if (line >= lines.size())
+			throw kodogl::exception("Line " + std::to_string(line) + " is out of range.");
+
+		if (column > lines[line].Text.size())
+			throw kodogl::exception("Column " + std::to_string(column) + " is out of range of line " + std::to_string(line) + ".");
+	}
+
+	glm::vec4 LineLayout::Bounds(size_t line) const
+	{
+		const auto& l = lines.at(line);
+		auto pen = PenOf(line);
+
+		return glm::vec4(pen.x, pen.y + l.Top, pen.x + l.Width, pen.y + l.Bottom);
+	}
+
+	void LineLayout::Degenerate(glm::uint32 key, glm::uint32 first, glm::uint32 quadsLength)
+	{
+		quads.assign(quadsLength * 4, Vertex2f3f1f(glm::vec2(0.0f), glm::vec3(0.0f), 0.0f));
+		vertexBuffer.PatchQuads(key, first, quads, quadsLength);
+	}
+
+	void LineLayout::Release(Line& line)
+	{
+		if (line.Key == 0)
+			return;
+
+		Degenerate(line.Key, 0, line.CountOfQuads);
+		freeItems.push_back(FreeItem{ line.Key, line.CapacityOfQuads });
+
+		line.Key = 0;
+		line.CapacityOfQuads = 0;
+		line.CountOfQuads = 0;
+	}
+
+	void LineLayout::Reserve(Line& line, glm::uint32 quadsLength)
+	{
+		Release(line);
+
+		// The smallest free item with room.
+		auto best = freeItems.end();
+
+		for (auto it = freeItems.begin(); it != freeItems.end(); ++it)
+		{
+			if (it->CapacityOfQuads >= quadsLength && (best == freeItems.end() || it->CapacityOfQuads < best->CapacityOfQuads))
+				best = it;
+		}
+
+		if (best != freeItems.end())
+		{
+			line.Key = best->Key;
+			line.CapacityOfQuads = best->CapacityOfQuads;
+
+			*best = freeItems.back();
+			freeItems.pop_back();
+			return;
+		}
+
+		glm::uint32 vI, iI;
+		line.CapacityOfQuads = CapacityFor(quadsLength);
+		line.Key = vertexBuffer.AllocateQuads(line.CapacityOfQuads, &vI, &iI);
+
+		// Allocated quads have no indices yet.
+		Degenerate(line.Key, 0, line.CapacityOfQuads);
+	}
+
+	void LineLayout::Lay(size_t index)
+	{
+		auto& line = lines[index];
+
+		TextRun::Layout(font, line.Text.data(), line.Text.size(), size, run);
+
+		for (auto page : run.Pages)
+		{
+			if (std::find(pages.begin(), pages.end(), page) == pages.end())
+				pages.push_back(page);
+		}
+
+		auto countOfQuads = static_cast<glm::uint32>(run.Vertices.size() / 4);
+
+		if (countOfQuads > line.CapacityOfQuads)
+			Reserve(line, countOfQuads);
+
+		line.Width = run.Dimensions.x;
+		line.Top = -run.Ascent;
+		line.Bottom = run.Dimensions.y - run.Ascent;
+
+		if (line.Key == 0)
+			return;
+
+		// Quads holding glyphs before and not anymore are made degenerate.
+		auto pen = origin + PenOf(index);
+		auto written = glm::max(countOfQuads, line.CountOfQuads);
+
+		quads.assign(run.Vertices.begin(), run.Vertices.end());
+
+		for (auto& v : quads)
+			v.Vertex += pen;
+
+		quads.resize(written * 4, Vertex2f3f1f(glm::vec2(0.0f), glm::vec3(0.0f), 0.0f));
+
+		vertexBuffer.PatchQuads(line.Key, 0, quads, written);
+		line.CountOfQuads = countOfQuads;
+	}
+
+	void LineLayout::MoveLines(size_t first, ptrdiff_t countOfLines)
+	{
+		auto offset = glm::vec2(0.0f, static_cast<float_t>(countOfLines) * lineHeight);
+
+		for (auto i = first; i < lines.size(); i++)
+		{
+			if (lines[i].Key != 0)
+				vertexBuffer.MoveQuads(lines[i].Key, 0, lines[i].CountOfQuads, offset);
+		}
+	}
+
+	void LineLayout::Origin(const glm::vec2& originToSet)
+	{
+		if (originToSet == origin)
+			return;
+
+		auto offset = originToSet - origin;
+
+		for (const auto& line : lines)
+		{
+			if (line.Key != 0)
+				vertexBuffer.MoveQuads(line.Key, 0, line.CountOfQuads, offset);
+		}
+
+		origin = originToSet;
+	}
+
+	void LineLayout::Insert(size_t line, size_t column, const char* text, size_t length)
+	{
+		CheckPosition(line, column);
+
+		auto end = text + length;
+		auto feed = std::find(text, end, '\n');
+
+		if (feed == end)
+		{
+			lines[line].Text.insert(column, text, length);
+			Lay(line);
+			return;
+		}
+
+		// The line is split; the text after the column goes to the end of the last new line.
+		std::vector<Line> added;
+		auto tail = lines[line].Text.substr(column);
+
+		lines[line].Text.replace(column, std::string::npos, text, feed - text);
+
+		for (auto it = feed + 1;; )
+		{
+			auto next = std::find(it, end, '\n');
+
+			added.emplace_back();
+			added.back().Text.assign(it, next);
+
+			if (next == end)
+				break;
+
+			it = next + 1;
+		}
+
+		added.back().Text += tail;
+
+		lines.insert(lines.begin() + line + 1, std::make_move_iterator(added.begin()), std::make_move_iterator(added.end()));
+		MoveLines(line + 1 + added.size(), static_cast<ptrdiff_t>(added.size()));
+
+		for (auto i = line; i <= line + added.size(); i++)
+			Lay(i);
+	}
+
+	void LineLayout::Erase(size_t line, size_t column, size_t endLine, size_t endColumn)
+	{
+		CheckPosition(line, column);
+		CheckPosition(endLine, endColumn);
+
+		if (endLine < line || (endLine == line && endColumn < column))
+			throw kodogl::exception("The end of the text to erase is before its start.");
+
+		if (endLine == line)
+		{
+			lines[line].Text.erase(column, endColumn - column);
+			Lay(line);
+			return;
+		}
+
+		lines[line].Text.replace(column, std::string::npos, lines[endLine].Text, endColumn, std::string::npos);
+
+		for (auto i = line + 1; i <= endLine; i++)
+			Release(lines[i]);
+
+		lines.erase(lines.begin() + line + 1, lines.begin() + endLine + 1);
+		MoveLines(line + 1, -static_cast<ptrdiff_t>(endLine - line));
+
+		Lay(line);
+	}
+
+	void LineLayout::Refresh()
+	{
+		const auto& atlas = font.GetAtlas();
+
+		if (generation == atlas.Generation())
+		{
+			font.Touch(pages);
+			return;
+		}
+
+		// Glyphs looked up in this frame keep their pages, so each line is laid out once.
+		pages.clear();
+
+		for (size_t i = 0; i < lines.size(); i++)
+			Lay(i);
+
+		generation = atlas.Generation();
+	}
+}
@@ -0,0 +1,198 @@
+#pragma once
+
+#include "VertexBuffer.hpp"
+#include "AtlasFont.hpp"
+#include "TextRun.hpp"
+
+namespace kodogl
+{
+	//
+	// Text laid out line by line into a vertex buffer, for text that's edited, like editors and logs.
+	// An edit lays out only the lines it changes and overwrites their quads in place, so its cost depends
+	// on the length of those lines rather than of the text. Splitting or joining lines moves the quads of
+	// the lines below without laying them out again.
+	//
+	// Each line holds its quads in an item of the layout's vertex buffer with room to grow; unused quads are
+	// degenerate, so the buffer is drawn as a whole. Items of removed lines are reused by other lines.
+	// The buffer persists across frames, so a frame uploads only the quads edited since the last one.
+	//
+	class LineLayout : public nocopy
+	{
+		struct Line
+		{
+			// UTF-8 text, without the line feed.
+			std::string Text;
+
+			// Key of the item holding the quads of the line, 0 before it has one.
+			glm::uint32 Key;
+			// Quads of the item, and those holding glyphs.
+			glm::uint32 CapacityOfQuads;
+			glm::uint32 CountOfQuads;
+
+			// Width of the line, and top and bottom of its glyphs down from the baseline.
+			float_t Width;
+			float_t Top;
+			float_t Bottom;
+
+			Line() : Key( 0 ), CapacityOfQuads( 0 ), CountOfQuads( 0 ), Width( 0.0f ), Top( 0.0f ), Bottom( 0.0f ) {}
+		};
+
+		struct FreeItem
+		{
+			glm::uint32 Key;
+			glm::uint32 CapacityOfQuads;
+		};
+
+		const AtlasFont& font;
+		VertexBuffer<Vertex2f3f1f> vertexBuffer;
+
+		// Pen position at the start of the first line, and the window position it's relative to.
+		glm::vec2 position;
+		glm::vec2 origin;
+		float_t size;
+		float_t lineHeight;
+
+		std::vector<Line> lines;
+		// Items of removed lines, their quads degenerate.
+		std::vector<FreeItem> freeItems;
+
+		// Pages of the atlas holding the glyphs, and the generation of the atlas they were looked up in.
+		std::vector<uint32_t> pages;
+		glm::uint64 generation;
+
+		// Scratch storage of the line laid out, and of the quads written to the buffer.
+		TextRun run;
+		std::vector<Vertex2f3f1f> quads;
+
+		glm::vec2 PenOf( size_t line ) const
+		{
+			return position + glm::vec2( 0.0f, static_cast<float_t>(line) * lineHeight );
+		}
+
+		void CheckPosition( size_t line, size_t column ) const;
+
+		//
+		// Lay out the text of a line and write its quads, moving it to an item with more room when it outgrew its own.
+		//
+		void Lay( size_t line );
+
+		//
+		// Overwrite quads of an item with degenerate ones.
+		//
+		void Degenerate( glm::uint32 key, glm::uint32 first, glm::uint32 quadsLength );
+
+		void Release( Line& line );
+		void Reserve( Line& line, glm::uint32 quadsLength );
+
+		//
+		// Move the quads of the lines from first on by a number of lines, after lines were inserted or removed above them.
+		//
+		void MoveLines( size_t first, ptrdiff_t countOfLines );
+
+	public:
+
+		//
+		// Lay out text with a font, the pen starting at position. Size is the size to draw the text at, 0 for the size of the font.
+		//
+		explicit LineLayout( const std::string& text, const AtlasFont& font, const glm::vec2& position, float_t size = 0.0f );
+
+		const AtlasFont& Font() const
+		{
+			return font;
+		}
+
+		GenericVertexBuffer& Buffer()
+		{
+			return vertexBuffer;
+		}
+
+		//
+		// Whether the buffer holds no quads, e.g. of text without glyphs.
+		//
+		bool Empty() const
+		{
+			return vertexBuffer.CountOfVertices() == 0;
+		}
+
+		const glm::vec2& Position() const
+		{
+			return position;
+		}
+
+		float_t LineHeight() const
+		{
+			return lineHeight;
+		}
+
+		//
+		// Distance from the top of a line down to its baseline.
+		//
+		float_t Ascender() const
+		{
+			return font.Ascender() * (size > 0.0f ? size / font.Size : 1.0f);
+		}
+
+		size_t CountOfLines() const
+		{
+			return lines.size();
+		}
+
+		const std::string& Text( size_t line ) const
+		{
+			return lines.at( line ).Text;
+		}
+
+		//
+		// Bounds (left, top, right, bottom) of the glyphs of a line, relative to the origin.
+		//
+		glm::vec4 Bounds( size_t line ) const;
+
+		//
+		// Key of the item of the vertex buffer holding the quads of a line, 0 when it has none, and how many of
+		// its quads hold glyphs, the first ones. The item may change with edits of the line.
+		//
+		glm::uint32 Key( size_t line ) const
+		{
+			return lines.at( line ).Key;
+		}
+
+		glm::uint32 CountOfGlyphs( size_t line ) const
+		{
+			return lines.at( line ).CountOfQuads;
+		}
+
+		//
+		// Insert UTF-8 text at a byte column of a line; line feeds in the text split the line.
+		//
+		void Insert( size_t line, size_t column, const char* text, size_t length );
+
+		void Insert( size_t line, size_t column, const std::string& text )
+		{
+			Insert( line, column, text.data(), text.size() );
+		}
+
+		//
+		// Append UTF-8 text to the end of the last line, e.g. lines of a log.
+		//
+		void Append( const std::string& text )
+		{
+			Insert( lines.size() - 1, lines.back().Text.size(), text );
+		}
+
+		//
+		// Erase the text from a byte column of a line up to one of a later line, joining the lines.
+		//
+		void Erase( size_t line, size_t column, size_t endLine, size_t endColumn );
+
+		//
+		// Move the quads to a window position the layout is relative to, e.g. the area of the context drawing it.
+		//
+		void Origin( const glm::vec2& originToSet );
+
+		//
+		// Lay out lines again when a page of the atlas was cleared since they were laid out, and keep the pages
+		// of their glyphs for this frame otherwise. Called by WindowContext::DrawLineLayout.
+		//
+		void Refresh();
+	};
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "kodo-gl.hpp"
+
+namespace kodogl
+{
+	//
+	// A read-only view of a whole file, mapped into memory.
+	//
+	class MappedFile : public nocopy
+	{
+		HANDLE file;
+		HANDLE mapping;
+		const glm::uint8* data;
+		size_t size;
+
+	public:
+
+		explicit MappedFile( const std::string& filename ) : file( INVALID_HANDLE_VALUE ), mapping( nullptr ), data( nullptr ), size( 0 )
+		{
+			file = CreateFileA( filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr );
+			if (file == INVALID_HANDLE_VALUE)
+				return;
+
+			// Empty files can't be mapped.
+			LARGE_INTEGER sizeOfFile;
+			if (!GetFileSizeEx( file, &sizeOfFile ) || sizeOfFile.QuadPart == 0)
+				return;
+
+			mapping = CreateFileMappingA( file, nullptr, PAGE_READONLY, 0, 0, nullptr );
+			if (mapping == nullptr)
+				return;
+
+			data = static_cast<const glm::uint8*>(MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 ));
+			if (data != nullptr)
+				size = static_cast<size_t>(sizeOfFile.QuadPart);
+		}
+
+		~MappedFile()
+		{
+			if (data != nullptr)
+				UnmapViewOfFile( data );
+			if (mapping != nullptr)
+				CloseHandle( mapping );
+			if (file != INVALID_HANDLE_VALUE)
+				CloseHandle( file );
+		}
+
+		bool IsOpen() const
+		{
+			return data != nullptr;
+		}
+
+		const glm::uint8* Data() const
+		{
+			return data;
+		}
+
+		size_t Size() const
+		{
+			return size;
+		}
+	};
+}
@@ -0,0 +1,375 @@
+#include "NumberGlyphs.hpp"
+#include "Atlas.hpp"
+
+#include <cmath>
+#include <cstring>
+
+namespace kodogl
+{
+	constexpr char NumberGlyphs::Characters[];
+
+	namespace
+	{
+		// Powers of ten up to 10^22, the largest one exact in a double.
+		const double_t PowersOfTen[] = {
+			1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+			1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+		};
+
+		const uint64_t IntegralPowersOfTen[] = {
+			1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull, 10000000ull,
+			100000000ull, 1000000000ull, 10000000000ull, 100000000000ull, 1000000000000ull,
+			10000000000000ull, 100000000000000ull, 1000000000000000ull, 10000000000000000ull
+		};
+
+		const int MaxPrecision = 15;
+
+		double_t PowerOfTen(int exponent)
+		{
+			if (exponent >= 0 && exponent <= 22)
+				return PowersOfTen[exponent];
+
+			return std::pow(10.0, exponent);
+		}
+
+		// Write the digits of a number, at least a count of them, padded with zeros.
+		char* WriteDigits(char* out, uint64_t value, int minimumDigits = 1)
+		{
+			char digits[20];
+			auto count = 0;
+
+			do
+			{
+				digits[count++] = static_cast<char>('0' + value % 10);
+				value /= 10;
+			} while (value != 0);
+
+			while (count < minimumDigits)
+				digits[count++] = '0';
+
+			while (count > 0)
+				*out++ = digits[--count];
+
+			return out;
+		}
+
+		char* WriteExponent(char* out, int exponent)
+		{
+			*out++ = 'e';
+			*out++ = exponent < 0 ? '-' : '+';
+			return WriteDigits(out, static_cast<uint64_t>(glm::abs(exponent)), 2);
+		}
+
+		// Write digits of a scaled number, with precision of them after the decimal mark.
+		char* WriteScaled(char* out, uint64_t scaled, int precision, char decimalMark)
+		{
+			out = WriteDigits(out, scaled / IntegralPowersOfTen[precision]);
+
+			if (precision > 0)
+			{
+				*out++ = decimalMark;
+				out = WriteDigits(out, scaled % IntegralPowersOfTen[precision], precision);
+			}
+
+			return out;
+		}
+
+		// The exponent of the leading digit of a finite, positive number.
+		int DecimalExponent(double_t value)
+		{
+			auto exponent = static_cast<int>(std::floor(std::log10(value)));
+
+			// log10 may round across a power of ten.
+			if (value < PowerOfTen(exponent))
+				exponent--;
+			else if (value >= PowerOfTen(exponent + 1))
+				exponent++;
+
+			return exponent;
+		}
+
+		// A whole number plus a fraction of a unit, rounded to the nearest whole number with ties to even, as printf does.
+		uint64_t RoundHalfEven(double_t whole, double_t fraction, double_t unit)
+		{
+			auto half = unit * 0.5;
+
+			if (fraction > half || (fraction == half && std::fmod(whole, 2.0) != 0.0))
+				whole += 1.0;
+
+			return static_cast<uint64_t>(whole);
+		}
+
+		// A finite, positive number times 10^shift, rounded to a whole number. The rounding is exact while 10^shift is.
+		uint64_t RoundScaled(double_t value, int shift)
+		{
+			if (shift >= 0 && shift <= 22)
+			{
+				// The product and its rounding error add up to the exact product.
+				auto scale = PowersOfTen[shift];
+				auto product = value * scale;
+				auto error = std::fma(value, scale, -product);
+				auto whole = std::floor(product);
+				auto fraction = product - whole;
+
+				// Only a tie depends on the error.
+				if (fraction == 0.5 && error != 0.0)
+					fraction += error > 0.0 ? 0.25 : -0.25;
+
+				return RoundHalfEven(whole, fraction, 1.0);
+			}
+
+			if (shift < 0 && shift >= -22)
+			{
+				// The remainder of the division is exact.
+				auto divisor = PowersOfTen[-shift];
+				auto whole = std::floor(value / divisor);
+				auto remainder = std::fma(-whole, divisor, value);
+
+				if (remainder < 0.0)
+				{
+					whole -= 1.0;
+					remainder += divisor;
+				}
+				else if (remainder >= divisor)
+				{
+					whole += 1.0;
+					remainder -= divisor;
+				}
+
+				return RoundHalfEven(whole, remainder, divisor);
+			}
+
+			// Keep 10^shift finite for subnormal values.
+			if (shift > 300)
+			{
+				value *= 1e30;
+				shift -= 30;
+			}
+
+			return static_cast<uint64_t>(value * std::pow(10.0, shift) + 0.5);
+		}
+	}
+
+	NumberGlyphs::NumberGlyphs(const AtlasFont& font) :
+		font(font),
+		generation(0),
+		resolved(false)
+	{
+	}
+
+	void NumberGlyphs::Resolve()
+	{
+		const auto& atlas = font.GetAtlas();
+
+		if (resolved && generation == atlas.Generation())
+		{
+			font.Touch(pages);
+			return;
+		}
+
+		const auto& table = font.Glyphs();
+		std::array<utf8::uint32_t, CountOfGlyphs> codepoints;
+
+		pages.clear();
+
+		for (size_t i = 0; i < CountOfGlyphs; i++)
+		{
+			codepoints[i] = i + 1 < CountOfGlyphs ? static_cast<utf8::uint32_t>(Characters[i]) : AtlasFont::FallbackCodepoint;
+
+			auto slot = font.FindGlyph(codepoints[i], true);
+			auto page = table.Page(slot);
+
+			glyphs[i] = Glyph{ table.Box(slot), table.Region(slot), static_cast<float_t>(page), table.AdvanceX(slot) };
+
+			if (std::find(pages.begin(), pages.end(), page) == pages.end())
+				pages.push_back(page);
+		}
+
+		for (size_t previous = 0; previous < CountOfGlyphs; previous++)
+		{
+			for (size_t next = 0; next < CountOfGlyphs; next++)
+				kerning[previous * CountOfGlyphs + next] = font.Kerning(codepoints[previous], codepoints[next]);
+		}
+
+		// Rasterizing may have cleared pages, though never those of glyphs used in this frame.
+		generation = atlas.Generation();
+		resolved = true;
+	}
+
+	NumberText NumberGlyphs::Format(double_t value, NumberFormat format, int precision, char decimalMark)
+	{
+		NumberText text;
+		auto out = text.Chars;
+
+		if (std::isnan(value))
+		{
+			*out++ = 'n';
+			*out++ = 'a';
+			*out++ = 'n';
+			text.Length = out - text.Chars;
+			return text;
+		}
+
+		if (std::signbit(value))
+			*out++ = '-';
+
+		auto magnitude = std::abs(value);
+
+		if (std::isinf(magnitude))
+		{
+			*out++ = 'i';
+			*out++ = 'n';
+			*out++ = 'f';
+			text.Length = out - text.Chars;
+			return text;
+		}
+
+		precision = glm::clamp(precision, 0, MaxPrecision);
+
+		// The scaled digits have to fit in 53 bits to be exact.
+		if (format == NumberFormat::Fixed && magnitude * PowersOfTen[precision] >= 9007199254740992.0)
+			format = NumberFormat::Scientific;
+
+		if (format == NumberFormat::Fixed)
+		{
+			auto scaled = RoundScaled(magnitude, precision);
+			out = WriteScaled(out, scaled, precision, decimalMark);
+		}
+		else if (magnitude == 0.0)
+		{
+			out = WriteScaled(out, 0, precision, decimalMark);
+			out = WriteExponent(out, 0);
+		}
+		else
+		{
+			auto exponent = DecimalExponent(magnitude);
+
+			// Engineering notation rounds the exponent down to a multiple of three.
+			auto step = format == NumberFormat::Engineering ? 3 : 1;
+			exponent = exponent >= 0 ? exponent / step * step : -((-exponent + step - 1) / step) * step;
+
+			auto scaled = RoundScaled(magnitude, precision - exponent);
+
+			// Rounding carried into another digit before the decimal mark.
+			if (scaled >= IntegralPowersOfTen[precision] * (step == 3 ? 1000 : 10))
+			{
+				exponent += step;
+				scaled = RoundScaled(magnitude, precision - exponent);
+			}
+
+			out = WriteScaled(out, scaled, precision, decimalMark);
+			out = WriteExponent(out, exponent);
+		}
+
+		// No sign for values rounded to zero.
+		if (text.Chars[0] == '-')
+		{
+			auto zero = true;
+
+			for (auto c = text.Chars + 1; c != out && *c != 'e'; c++)
+			{
+				if (*c >= '1' && *c <= '9')
+				{
+					zero = false;
+					break;
+				}
+			}
+
+			if (zero)
+			{
+				std::memmove(text.Chars, text.Chars + 1, out - text.Chars - 1);
+				out--;
+			}
+		}
+
+		text.Length = out - text.Chars;
+		return text;
+	}
+
+	NumberText NumberGlyphs::Format(int64_t value)
+	{
+		NumberText text;
+		auto out = text.Chars;
+
+		// The magnitude of the smallest value doesn't fit in its type, only in the unsigned one.
+		auto magnitude = static_cast<uint64_t>(value);
+
+		if (value < 0)
+		{
+			*out++ = '-';
+			magnitude = 0 - magnitude;
+		}
+
+		out = WriteDigits(out, magnitude);
+
+		text.Length = out - text.Chars;
+		return text;
+	}
+
+	size_t NumberGlyphs::Layout(const NumberText& text, const glm::vec4& bounds, TextAligment xAlign, TextAligment yAlign, float_t size, Vertex2f3f1f* vertices, glm::vec2* dimensions)
+	{
+		Resolve();
+
+		auto scale = size > 0.0f ? size / font.Size : 1.0f;
+
+		// Extents of the glyphs, down from the baseline.
+		auto width = 0.0f;
+		auto top = 0.0f;
+		auto bottom = 0.0f;
+
+		auto previous = CountOfGlyphs;
+		auto vertex = vertices;
+
+		// Measure and emit at the origin in one pass, then move the quads into place.
+		for (size_t i = 0; i < text.Length; i++)
+		{
+			auto index = IndexOf(text.Chars[i]);
+			const auto& glyph = glyphs[index];
+
+			if (previous != CountOfGlyphs)
+				width += kerning[previous * CountOfGlyphs + index] * scale;
+
+			previous = index;
+
+			auto x0 = width + glyph.Box.x * scale;
+			auto y0 = -glyph.Box.y * scale;
+			auto x1 = x0 + glyph.Box.z * scale;
+			auto y1 = y0 + glyph.Box.w * scale;
+
+			*vertex++ = Vertex2f3f1f(x0, y0, glyph.Region.L, glyph.Region.T, glyph.Page, 1.0f);
+			*vertex++ = Vertex2f3f1f(x0, y1, glyph.Region.L, glyph.Region.B, glyph.Page, 1.0f);
+			*vertex++ = Vertex2f3f1f(x1, y1, glyph.Region.R, glyph.Region.B, glyph.Page, 1.0f);
+			*vertex++ = Vertex2f3f1f(x1, y0, glyph.Region.R, glyph.Region.T, glyph.Page, 1.0f);
+
+			width += glyph.AdvanceX * scale;
+			top = i == 0 ? y0 : glm::min(top, y0);
+			bottom = i == 0 ? y1 : glm::max(bottom, y1);
+		}
+
+		auto measured = glm::vec2(width, bottom - top);
+		auto origin = TextRun::Origin(measured, -top, bounds, xAlign, yAlign);
+
+		for (auto v = vertices; v != vertex; v++)
+			v->Vertex += origin;
+
+		if (dimensions)
+			*dimensions = measured;
+
+		return static_cast<size_t>(vertex - vertices);
+	}
+
+	glm::uint32 NumberGlyphs::Push(VertexBuffer<Vertex2f3f1f>& vertexBuffer, const NumberText& text, const glm::vec4& bounds, TextAligment xAlign, TextAligment yAlign, float_t size)
+	{
+		Vertex2f3f1f vertices[NumberText::MaxLength * 4];
+		auto countOfVertices = Layout(text, bounds, xAlign, yAlign, size, vertices);
+		auto countOfQuads = static_cast<glm::uint32>(countOfVertices / 4);
+
+		glm::uint32 vI, iI;
+		auto key = vertexBuffer.AllocateQuads(countOfQuads, &vI, &iI);
+
+		for (glm::uint32 i = 0; i < countOfQuads; i++)
+			vertexBuffer.PushQuadTo(vI, iI, i, vertices + i * 4);
+
+		return key;
+	}
+}
@@ -0,0 +1,131 @@
+#pragma once
+
+#include "VertexBuffer.hpp"
+#include "AtlasFont.hpp"
+#include "TextRun.hpp"
+
+namespace kodogl
+{
+	enum class NumberFormat
+	{
+		// Digits after the decimal mark, e.g. 1234.50.
+		Fixed,
+		// One digit before the decimal mark and an exponent, e.g. 1.23e+03.
+		Scientific,
+		// One to three digits before the decimal mark and an exponent that is a multiple of three, e.g. 1.23e+03, 12.3e-06.
+		Engineering
+	};
+
+	//
+	// The characters of a formatted number, held on the stack.
+	//
+	struct NumberText
+	{
+		static constexpr size_t MaxLength = 40;
+
+		char Chars[MaxLength];
+		size_t Length;
+
+		NumberText() : Length( 0 ) {}
+	};
+
+	//
+	// The glyphs of the characters numbers are formatted with, looked up once per font, so numbers that change
+	// every frame, like axis labels and live readouts, are laid out straight into quads: without strings,
+	// decoding UTF-8, looking glyphs up or allocating.
+	//
+	class NumberGlyphs : public nocopy
+	{
+		// Characters with a glyph in the table, those of "nan" and "inf" included; any other character is drawn
+		// with the fallback glyph, last.
+		static constexpr char Characters[] = "0123456789.,e+-naif";
+		static constexpr size_t CountOfGlyphs = sizeof( Characters );
+
+		struct Glyph
+		{
+			// OffsetX, OffsetY, Width, Height
+			glm::vec4 Box;
+			NormalizedRegion Region;
+			float_t Page;
+			float_t AdvanceX;
+		};
+
+		const AtlasFont& font;
+
+		std::array<Glyph, CountOfGlyphs> glyphs;
+		// Kerning of a glyph (column) following another (row).
+		std::array<float_t, CountOfGlyphs * CountOfGlyphs> kerning;
+		// Pages of the atlas holding the glyphs.
+		std::vector<uint32_t> pages;
+		// Generation of the atlas the glyphs were looked up in; none before the first lookup.
+		glm::uint64 generation;
+		bool resolved;
+
+		static size_t IndexOf( char character )
+		{
+			if (character >= '0' && character <= '9')
+				return static_cast<size_t>(character - '0');
+
+			switch (character)
+			{
+			case '.': return 10;
+			case ',': return 11;
+			case 'e': return 12;
+			case '+': return 13;
+			case '-': return 14;
+			case 'n': return 15;
+			case 'a': return 16;
+			case 'i': return 17;
+			case 'f': return 18;
+			default: return CountOfGlyphs - 1;
+			}
+		}
+
+		//
+		// Look the glyphs up again when a page of the atlas was cleared since, and keep their pages for this frame.
+		//
+		void Resolve();
+
+	public:
+
+		explicit NumberGlyphs( const AtlasFont& font );
+
+		const AtlasFont& Font() const
+		{
+			return font;
+		}
+
+		//
+		// Format a number with digits of precision after the decimal mark, up to 15. Fixed numbers with more
+		// digits than a double holds exactly, about 16, are formatted in scientific notation.
+		// The decimal mark is drawn with a glyph of the table only when it's '.' or ','; see DecimalMark.
+		//
+		static NumberText Format( double_t value, NumberFormat format = NumberFormat::Fixed, int precision = 2, char decimalMark = '.' );
+		static NumberText Format( int64_t value );
+
+		//
+		// Whether a character can be the decimal mark of numbers drawn with the glyphs.
+		//
+		static bool DecimalMark( char32_t character )
+		{
+			return character == '.' || character == ',';
+		}
+
+		static NumberText Format( int32_t value )
+		{
+			return Format( static_cast<int64_t>( value ) );
+		}
+
+		//
+		// Lay out a formatted number aligned within bounds (left, top, right, bottom), writing four vertices
+		// per character to vertices, at most NumberText::MaxLength * 4. Size is the size to draw the number at,
+		// 0 for the size of the font. Returns the number of vertices written.
+		//
+		size_t Layout( const NumberText& text, const glm::vec4& bounds, TextAligment xAlign, TextAligment yAlign, float_t size, Vertex2f3f1f* vertices, glm::vec2* dimensions = nullptr );
+
+		//
+		// Lay out a formatted number into quads allocated in a vertex buffer, returning the key of the quads.
+		//
+		glm::uint32 Push( VertexBuffer<Vertex2f3f1f>& vertexBuffer, const NumberText& text, const glm::vec4& bounds, TextAligment xAlign = TextAligment::Near, TextAligment yAlign = TextAligment::Near, float_t size = 0.0f );
+	};
+}
@@ -0,0 +1,285 @@
+#include "Pixels.hpp"
+
+#include <intrin.h>
+#include <emmintrin.h>
+#include <tmmintrin.h>
+
+namespace kodogl
+{
+	static bool HasSSSE3()
+	{
+		int info[4];
+		__cpuid(info, 1);
+		return (info[2] & (1 << 9)) != 0;
+	}
+
+	static const bool hasSSSE3 = HasSSSE3();
+
+	//
+	// Gray, alpha -> alpha, 16 pixels at a time.
+	//
+	static void AlphaFromGrayAlpha(const glm::uint8* source, glm::uint8* destination, glm::uint32 width)
+	{
+		glm::uint32 i = 0;
+
+		for (; i + 16 <= width; i += 16)
+		{
+			auto a = _mm_srli_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i * 2)), 8);
+			auto b = _mm_srli_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i * 2 + 16)), 8);
+
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), _mm_packus_epi16(a, b));
+		}
+
+		for (; i < width; i++)
+			destination[i] = source[i * 2 + 1];
+	}
+
+	//
+	// RGBA -> alpha, 16 pixels at a time.
+	//
+	static void AlphaFromRGBA(const glm::uint8* source, glm::uint8* destination, glm::uint32 width)
+	{
+		glm::uint32 i = 0;
+
+		for (; i + 16 <= width; i += 16)
+		{
+			const auto* s = reinterpret_cast<const __m128i*>(source + i * 4);
+
+			auto a = _mm_packs_epi32(_mm_srli_epi32(_mm_loadu_si128(s), 24), _mm_srli_epi32(_mm_loadu_si128(s + 1), 24));
+			auto b = _mm_packs_epi32(_mm_srli_epi32(_mm_loadu_si128(s + 2), 24), _mm_srli_epi32(_mm_loadu_si128(s + 3), 24));
+
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), _mm_packus_epi16(a, b));
+		}
+
+		for (; i < width; i++)
+			destination[i] = source[i * 4 + 3];
+	}
+
+	//
+	// Gray -> RGBA, 16 pixels at a time.
+	//
+	static void RGBAFromGray(const glm::uint8* source, glm::uint8* destination, glm::uint32 width)
+	{
+		const auto opaque = _mm_set1_epi8(static_cast<char>(0xFF));
+
+		glm::uint32 i = 0;
+
+		for (; i + 16 <= width; i += 16)
+		{
+			auto g = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+			auto gg0 = _mm_unpacklo_epi8(g, g);
+			auto gg1 = _mm_unpackhi_epi8(g, g);
+			auto ga0 = _mm_unpacklo_epi8(g, opaque);
+			auto ga1 = _mm_unpackhi_epi8(g, opaque);
+
+			auto* d = reinterpret_cast<__m128i*>(destination + i * 4);
+			_mm_storeu_si128(d, _mm_unpacklo_epi16(gg0, ga0));
+			_mm_storeu_si128(d + 1, _mm_unpackhi_epi16(gg0, ga0));
+			_mm_storeu_si128(d + 2, _mm_unpacklo_epi16(gg1, ga1));
+			_mm_storeu_si128(d + 3, _mm_unpackhi_epi16(gg1, ga1));
+		}
+
+		for (; i < width; i++)
+		{
+			destination[i * 4 + 0] = destination[i * 4 + 1] = destination[i * 4 + 2] = source[i];
+			destination[i * 4 + 3] = 0xFF;
+		}
+	}
+
+	//
+	// Gray, alpha -> RGBA, 8 pixels at a time.
+	//
+	static void RGBAFromGrayAlpha(const glm::uint8* source, glm::uint8* destination, glm::uint32 width)
+	{
+		const auto gray = _mm_set1_epi16(0x00FF);
+
+		glm::uint32 i = 0;
+
+		for (; i + 8 <= width; i += 8)
+		{
+			auto ga = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i * 2));
+			auto g = _mm_and_si128(ga, gray);
+			auto gg = _mm_or_si128(g, _mm_slli_epi16(g, 8));
+
+			auto* d = reinterpret_cast<__m128i*>(destination + i * 4);
+			_mm_storeu_si128(d, _mm_unpacklo_epi16(gg, ga));
+			_mm_storeu_si128(d + 1, _mm_unpackhi_epi16(gg, ga));
+		}
+
+		for (; i < width; i++)
+		{
+			destination[i * 4 + 0] = destination[i * 4 + 1] = destination[i * 4 + 2] = source[i * 2];
+			destination[i * 4 + 3] = source[i * 2 + 1];
+		}
+	}
+
+	//
+	// RGB -> RGBA, 4 pixels at a time with SSSE3.
+	//
+	static void RGBAFromRGB(const glm::uint8* source, glm::uint8* destination, glm::uint32 width)
+	{
+		glm::uint32 i = 0;
+
+		if (hasSSSE3)
+		{
+			const auto spread = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+			const auto opaque = _mm_set1_epi32(static_cast<int>(0xFF000000));
+
+			// Each load reads 16 bytes for 12 bytes of pixels, so stop before the end of the row.
+			for (; (i + 4) * 3 + 4 <= width * 3; i += 4)
+			{
+				auto rgb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i * 3));
+				auto rgba = _mm_or_si128(_mm_shuffle_epi8(rgb, spread), opaque);
+
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i * 4), rgba);
+			}
+		}
+
+		for (; i < width; i++)
+		{
+			destination[i * 4 + 0] = source[i * 3 + 0];
+			destination[i * 4 + 1] = source[i * 3 + 1];
+			destination[i * 4 + 2] = source[i * 3 + 2];
+			destination[i * 4 + 3] = 0xFF;
+		}
+	}
+
+	void PremultiplyRow(const glm::uint8* source, glm::uint8* destination, glm::uint32 width)
+	{
+		const auto zero = _mm_setzero_si128();
+		// Selects the alpha lanes of two pixels widened to 16 bits.
+		const auto alphaLanes = _mm_setr_epi16(0, 0, 0, -1, 0, 0, 0, -1);
+		const auto opaque = _mm_set1_epi16(0xFF);
+		const auto half = _mm_set1_epi16(0x80);
+
+		//
+		// c * a / 255, rounded, with alpha itself multiplied by 255.
+		//
+		auto premultiply = [&](__m128i c)
+		{
+			auto a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(c, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+			a = _mm_or_si128(_mm_andnot_si128(alphaLanes, a), _mm_and_si128(alphaLanes, opaque));
+
+			auto t = _mm_add_epi16(_mm_mullo_epi16(c, a), half);
+			return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+		};
+
+		glm::uint32 i = 0;
+
+		for (; i + 4 <= width; i += 4)
+		{
+			auto rgba = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i * 4));
+
+			auto lo = premultiply(_mm_unpacklo_epi8(rgba, zero));
+			auto hi = premultiply(_mm_unpackhi_epi8(rgba, zero));
+
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i * 4), _mm_packus_epi16(lo, hi));
+		}
+
+		for (; i < width; i++)
+		{
+			const auto* s = source + i * 4;
+			auto* d = destination + i * 4;
+
+			for (auto c = 0; c < 3; c++)
+			{
+				glm::uint32 t = s[c] * s[3] + 0x80;
+				d[c] = static_cast<glm::uint8>((t + (t >> 8)) >> 8);
+			}
+
+			d[3] = s[3];
+		}
+	}
+
+	void ConvertRow(const glm::uint8* source, glm::uint32 channels, glm::uint8* destination, GLenum format, glm::uint32 width)
+	{
+		if (format == gl::R8)
+		{
+			switch (channels)
+			{
+				case 2:
+					AlphaFromGrayAlpha(source, destination, width);
+					break;
+				case 4:
+					AlphaFromRGBA(source, destination, width);
+					break;
+				default:
+					memset(destination, 0xFF, width);
+					break;
+			}
+		}
+		else
+		{
+			switch (channels)
+			{
+				case 1:
+					RGBAFromGray(source, destination, width);
+					break;
+				case 2:
+					RGBAFromGrayAlpha(source, destination, width);
+					PremultiplyRow(destination, destination, width);
+					break;
+				case 3:
+					RGBAFromRGB(source, destination, width);
+					break;
+				default:
+					PremultiplyRow(source, destination, width);
+					break;
+			}
+		}
+	}
+
+	//
+	// Halve a level into output, which has room for the halved level.
+	//
+	static void DownsampleTo(const glm::uint8* pixels, glm::uint32 width, glm::uint32 height, glm::uint32 bytesPerPixel, glm::uint8* output)
+	{
+		auto outputWidth = glm::max(1u, width / 2);
+		auto outputHeight = glm::max(1u, height / 2);
+
+		for (glm::uint32 y = 0; y < outputHeight; y++)
+		{
+			const auto* row0 = pixels + static_cast<size_t>(glm::min(y * 2, height - 1)) * width * bytesPerPixel;
+			const auto* row1 = pixels + static_cast<size_t>(glm::min(y * 2 + 1, height - 1)) * width * bytesPerPixel;
+
+			for (glm::uint32 x = 0; x < outputWidth; x++)
+			{
+				auto x0 = glm::min(x * 2, width - 1) * bytesPerPixel;
+				auto x1 = glm::min(x * 2 + 1, width - 1) * bytesPerPixel;
+
+				for (glm::uint32 c = 0; c < bytesPerPixel; c++)
+					output[(static_cast<size_t>(y) * outputWidth + x) * bytesPerPixel + c] = static_cast<glm::uint8>((row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c] + 2) / 4);
+			}
+		}
+	}
+
+	void Downsample(const std::vector<glm::uint8>& pixels, glm::uint32 width, glm::uint32 height, glm::uint32 bytesPerPixel, std::vector<glm::uint8>& output)
+	{
+		output.resize(static_cast<size_t>(glm::max(1u, width / 2)) * glm::max(1u, height / 2) * bytesPerPixel);
+		DownsampleTo(pixels.data(), width, height, bytesPerPixel, output.data());
+	}
+
+	void AppendMipmaps(std::vector<glm::uint8>& pixels, glm::uint32 width, glm::uint32 height, glm::uint32 bytesPerPixel, glm::uint32 levels, std::vector<size_t>& sizeOfLevels)
+	{
+		sizeOfLevels.clear();
+
+		size_t size = 0;
+
+		for (glm::uint32 i = 0; i < levels; i++)
+		{
+			sizeOfLevels.push_back(static_cast<size_t>(glm::max(1u, width >> i)) * glm::max(1u, height >> i) * bytesPerPixel);
+			size += sizeOfLevels.back();
+		}
+
+		// Grown once, so each level is read from the one before it in place.
+		pixels.resize(size);
+
+		size_t offset = 0;
+
+		for (glm::uint32 i = 1; i < levels; i++)
+		{
+			DownsampleTo(pixels.data() + offset, glm::max(1u, width >> (i - 1)), glm::max(1u, height >> (i - 1)), bytesPerPixel, pixels.data() + offset + sizeOfLevels[i - 1]);
+			offset += sizeOfLevels[i - 1];
+		}
+	}
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "kodo-gl.hpp"
+
+namespace kodogl
+{
+	//
+	// Convert a row of decoded 8-bit pixels with 1 (gray), 2 (gray, alpha), 3 (RGB) or 4 (RGBA) channels.
+	// R8 keeps only the opacity (opaque without alpha); RGBA8 expands to RGBA with premultiplied alpha.
+	// Rows must not overlap.
+	//
+	void ConvertRow( const glm::uint8* source, glm::uint32 channels, glm::uint8* destination, GLenum format, glm::uint32 width );
+
+	//
+	// Multiply the color channels of a row of RGBA pixels by their alpha. The rows may be the same.
+	//
+	void PremultiplyRow( const glm::uint8* source, glm::uint8* destination, glm::uint32 width );
+
+	//
+	// Halve a level (rows tightly packed) with a box filter. Odd edges repeat their last row or column.
+	//
+	void Downsample( const std::vector<glm::uint8>& pixels, glm::uint32 width, glm::uint32 height, glm::uint32 bytesPerPixel, std::vector<glm::uint8>& output );
+
+	//
+	// Append the mipmaps of an image (level 0, rows tightly packed) to its pixels, level after level, up to a number of levels,
+	// and record the size of each level including level 0.
+	//
+	void AppendMipmaps( std::vector<glm::uint8>& pixels, glm::uint32 width, glm::uint32 height, glm::uint32 bytesPerPixel, glm::uint32 levels, std::vector<size_t>& sizeOfLevels );
+}
@@ -0,0 +1,247 @@
+#include "Series.hpp"
+
+#include <thread>
+#include <emmintrin.h>
+
+namespace kodogl
+{
+	//
+	// Find the indices of the minimum and maximum values in [begin, end), four samples at a time.
+	// Ties resolve to the earliest index. Lanes count from begin, so indices of long series fit them.
+	//
+	static void MinMax( const glm::float32* values, size_t begin, size_t end, size_t& minIndex, size_t& maxIndex )
+	{
+		auto i = begin;
+
+		minIndex = begin;
+		maxIndex = begin;
+
+		if (end - begin >= 8)
+		{
+			auto vmin = _mm_loadu_ps( values + i );
+			auto vmax = vmin;
+			auto index = _mm_setr_epi32( 0, 1, 2, 3 );
+			auto imin = index;
+			auto imax = index;
+			const auto four = _mm_set1_epi32( 4 );
+
+			for (i += 4; i + 4 <= end; i += 4)
+			{
+				index = _mm_add_epi32( index, four );
+
+				auto x = _mm_loadu_ps( values + i );
+				auto lt = _mm_castps_si128( _mm_cmplt_ps( x, vmin ) );
+				auto gt = _mm_castps_si128( _mm_cmpgt_ps( x, vmax ) );
+
+				vmin = _mm_min_ps( x, vmin );
+				vmax = _mm_max_ps( x, vmax );
+				imin = _mm_or_si128( _mm_and_si128( lt, index ), _mm_andnot_si128( lt, imin ) );
+				imax = _mm_or_si128( _mm_and_si128( gt, index ), _mm_andnot_si128( gt, imax ) );
+			}
+
+			alignas(16) glm::float32 laneMin[4], laneMax[4];
+			alignas(16) glm::int32 laneMinIndex[4], laneMaxIndex[4];
+			_mm_store_ps( laneMin, vmin );
+			_mm_store_ps( laneMax, vmax );
+			_mm_store_si128( reinterpret_cast<__m128i*>(laneMinIndex), imin );
+			_mm_store_si128( reinterpret_cast<__m128i*>(laneMaxIndex), imax );
+
+			minIndex = begin + laneMinIndex[0];
+			maxIndex = begin + laneMaxIndex[0];
+
+			for (auto lane = 1; lane < 4; lane++)
+			{
+				auto li = begin + static_cast<size_t>(laneMinIndex[lane]);
+				auto ai = begin + static_cast<size_t>(laneMaxIndex[lane]);
+
+				if (values[li] < values[minIndex] || (values[li] == values[minIndex] && li < minIndex))
+					minIndex = li;
+				if (values[ai] > values[maxIndex] || (values[ai] == values[maxIndex] && ai < maxIndex))
+					maxIndex = ai;
+			}
+		}
+
+		for (; i < end; i++)
+		{
+			if (values[i] < values[minIndex])
+				minIndex = i;
+			if (values[i] > values[maxIndex])
+				maxIndex = i;
+		}
+	}
+
+	constexpr size_t Series::NoSample;
+
+	Series::Series( const glm::float32* values, size_t length ) :
+		values( values, values + length )
+	{
+	}
+
+	void Series::Update( const glm::float32* newValues, size_t length )
+	{
+		values.assign( newValues, newValues + length );
+		decimations.clear();
+	}
+
+	void Series::DecimateColumns( glm::float64 samplesPerColumn, glm::int64 columnFrom, glm::int64 columnTo, SeriesSample* slots ) const
+	{
+		const auto* data = values.data();
+		auto length = static_cast<glm::float64>(values.size());
+
+		for (auto column = columnFrom; column < columnTo; column++)
+		{
+			auto begin = static_cast<size_t>(glm::min( length, glm::floor( column * samplesPerColumn ) ));
+			auto end = static_cast<size_t>(glm::min( length, glm::floor( (column + 1) * samplesPerColumn ) ));
+
+			auto* slot = slots + (column - columnFrom) * 4;
+
+			// Empty slots are marked with no index and dropped when compacting.
+			slot[0] = slot[1] = slot[2] = slot[3] = SeriesSample( NoSample, 0.0f );
+
+			if (begin == end)
+				continue;
+
+			size_t minIndex, maxIndex;
+			MinMax( data, begin, end, minIndex, maxIndex );
+
+			size_t indices[4] = { begin, glm::min( minIndex, maxIndex ), glm::max( minIndex, maxIndex ), end - 1 };
+
+			for (auto i = 0; i < 4; i++)
+			{
+				if (i > 0 && indices[i] == indices[i - 1])
+					continue;
+
+				slot[i] = SeriesSample( indices[i], data[indices[i]] );
+			}
+		}
+	}
+
+	void Series::DecimateRange( glm::float64 samplesPerColumn, glm::int64 columnFrom, glm::int64 columnTo, SeriesSample* slots ) const
+	{
+		auto columns = columnTo - columnFrom;
+
+		if (columns <= 0)
+			return;
+
+		if (columns * samplesPerColumn < ParallelThreshold)
+		{
+			DecimateColumns( samplesPerColumn, columnFrom, columnTo, slots );
+			return;
+		}
+
+		auto threadCount = glm::max<glm::int64>( 1, glm::min<glm::int64>( std::thread::hardware_concurrency(), columns ) );
+		auto columnsPerThread = (columns + threadCount - 1) / threadCount;
+
+		std::vector<std::thread> threads;
+
+		for (glm::int64 t = 1; t < threadCount; t++)
+		{
+			auto from = glm::min( columnTo, columnFrom + t * columnsPerThread );
+			auto to = glm::min( columnTo, from + columnsPerThread );
+
+			threads.emplace_back( &Series::DecimateColumns, this, samplesPerColumn, from, to, slots + (from - columnFrom) * 4 );
+		}
+
+		DecimateColumns( samplesPerColumn, columnFrom, glm::min( columnTo, columnFrom + columnsPerThread ), slots );
+
+		for (auto& thread : threads)
+			thread.join();
+	}
+
+	const std::vector<SeriesSample>& Series::Decimate( glm::float64 xFrom, glm::float64 xTo, glm::uint32 columns )
+	{
+		samples.clear();
+
+		if (values.empty() || columns == 0 || xTo < 0.0 || xTo < xFrom)
+			return samples;
+
+		// Include one sample on each side of the range, so the line leaves the view instead of ending at its edges.
+		auto first = static_cast<size_t>(glm::max( 0.0, glm::floor( xFrom ) ));
+		auto last = static_cast<size_t>(glm::min( static_cast<glm::float64>(values.size() - 1), glm::ceil( xTo ) ));
+
+		if (first > last)
+			return samples;
+
+		//
+		// Few enough samples to draw them all.
+		//
+		if (last - first + 1 <= static_cast<size_t>(columns) * 4)
+		{
+			samples.reserve( last - first + 1 );
+
+			for (auto i = first; i <= last; i++)
+				samples.emplace_back( i, values[i] );
+
+			return samples;
+		}
+
+		//
+		// The same zoom, allowing for the rounding of ranges panned by the caller, shares the grid of columns.
+		//
+		auto samplesPerColumn = (xTo - xFrom) / columns;
+		auto decimation = decimations.end();
+
+		for (auto it = decimations.begin(); it != decimations.end(); ++it)
+		{
+			if (glm::abs( it->SamplesPerColumn - samplesPerColumn ) <= samplesPerColumn * 1e-9)
+			{
+				decimations.splice( decimations.begin(), decimations, it );
+				decimation = decimations.begin();
+				break;
+			}
+		}
+
+		if (decimation == decimations.end())
+		{
+			if (decimations.size() >= CacheSize)
+				decimations.pop_back();
+
+			decimations.emplace_front( Decimation{ samplesPerColumn, 0, 0 } );
+			decimation = decimations.begin();
+		}
+
+		samplesPerColumn = decimation->SamplesPerColumn;
+
+		// The columns of the range and one on each side, as for samples.
+		auto lastColumn = static_cast<glm::int64>(glm::ceil( values.size() / samplesPerColumn ));
+		auto columnFrom = glm::clamp( static_cast<glm::int64>(glm::floor( xFrom / samplesPerColumn )) - 1, glm::int64( 0 ), lastColumn );
+		auto columnTo = glm::clamp( static_cast<glm::int64>(glm::ceil( xTo / samplesPerColumn )) + 1, columnFrom, lastColumn );
+
+		if (columnFrom == decimation->ColumnFrom && columnTo == decimation->ColumnTo)
+			return decimation->Samples;
+
+		//
+		// Columns shared with the previous range are copied, only those panned into are decimated.
+		//
+		std::vector<SeriesSample> slots( static_cast<size_t>(columnTo - columnFrom) * 4 );
+
+		auto sharedFrom = glm::max( columnFrom, decimation->ColumnFrom );
+		auto sharedTo = glm::min( columnTo, decimation->ColumnTo );
+
+		if (sharedFrom < sharedTo)
+		{
+			std::copy( decimation->Slots.begin() + (sharedFrom - decimation->ColumnFrom) * 4, decimation->Slots.begin() + (sharedTo - decimation->ColumnFrom) * 4,
+				slots.begin() + (sharedFrom - columnFrom) * 4 );
+
+			DecimateRange( samplesPerColumn, columnFrom, sharedFrom, slots.data() );
+			DecimateRange( samplesPerColumn, sharedTo, columnTo, slots.data() + (sharedTo - columnFrom) * 4 );
+		}
+		else
+		{
+			DecimateRange( samplesPerColumn, columnFrom, columnTo, slots.data() );
+		}
+
+		decimation->ColumnFrom = columnFrom;
+		decimation->ColumnTo = columnTo;
+		decimation->Slots = std::move( slots );
+		decimation->Samples.clear();
+
+		for (const auto& slot : decimation->Slots)
+		{
+			if (slot.Index != NoSample)
+				decimation->Samples.push_back( slot );
+		}
+
+		return decimation->Samples;
+	}
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "kodo-gl.hpp"
+
+#include <list>
+
+namespace kodogl
+{
+	//
+	// A sample of a series, its index kept whole so samples of long series stay apart.
+	//
+	struct SeriesSample
+	{
+		size_t Index;
+		glm::float32 Value;
+
+		SeriesSample() {}
+		SeriesSample( size_t index, glm::float32 value ) : Index( index ), Value( value ) {}
+	};
+
+	//
+	// A series of samples, decimated to at most four samples (first, min, max, last) per pixel column when drawn.
+	// Columns are laid on a grid starting at sample 0, so panning at the same zoom reuses those decimated before.
+	//
+	class Series : public nocopy
+	{
+		// Number of decimations (i.e., zoom levels) kept per series.
+		static constexpr size_t CacheSize = 4;
+		// Number of samples above which decimation is spread across threads.
+		static constexpr size_t ParallelThreshold = 1 << 18;
+		// Index of an empty slot of a decimation.
+		static constexpr size_t NoSample = size_t( -1 );
+
+		struct Decimation
+		{
+			// Samples per column; column k holds the samples from k * SamplesPerColumn up to (k + 1) * SamplesPerColumn.
+			glm::float64 SamplesPerColumn;
+
+			// Columns decimated, and their four slots each; empty slots have no index.
+			glm::int64 ColumnFrom;
+			glm::int64 ColumnTo;
+			std::vector<SeriesSample> Slots;
+
+			// Decimated samples of the columns, in index order.
+			std::vector<SeriesSample> Samples;
+		};
+
+		std::vector<glm::float32> values;
+
+		// Most recently used decimation first.
+		std::list<Decimation> decimations;
+
+		// Samples of the range last drawn without decimation.
+		std::vector<SeriesSample> samples;
+
+		void DecimateColumns( glm::float64 samplesPerColumn, glm::int64 columnFrom, glm::int64 columnTo, SeriesSample* slots ) const;
+
+		//
+		// Decimate the columns [columnFrom, columnTo) into their slots, across threads when they hold many samples.
+		//
+		void DecimateRange( glm::float64 samplesPerColumn, glm::int64 columnFrom, glm::int64 columnTo, SeriesSample* slots ) const;
+
+	public:
+
+		Series( const glm::float32* values, size_t length );
+
+		size_t Length() const
+		{
+			return values.size();
+		}
+
+		//
+		// Replace the samples of the series, discarding any cached decimation.
+		//
+		void Update( const glm::float32* values, size_t length );
+
+		//
+		// Decimate the samples within [xFrom, xTo] (in sample indices) to the specified number of pixel columns.
+		// Ranges as wide as one decimated before reuse the columns they share with it.
+		//
+		const std::vector<SeriesSample>& Decimate( glm::float64 xFrom, glm::float64 xTo, glm::uint32 columns );
+	};
+}
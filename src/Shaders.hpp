@@ -85,37 +85,128 @@ static const char* basicGeometryFragmentShaderSource = GLSL(
 );
 
 //
-// Basic geometry vertex shader.
+// Line geometry vertex shader.
+//
+// Expands one segment per instance into a quad, mitering the joints with the neighbouring segments.
+//
+static const char* lineGeometryVertexShaderSource = GLSL(
+	// Instanced attributes: the segment A-B and its neighbouring points.
+	layout( location = 0 ) in vec2 inputPrevious;
+	layout( location = 1 ) in vec2 inputA;
+	layout( location = 2 ) in vec2 inputB;
+	layout( location = 3 ) in vec2 inputNext;
+
+	uniform mat4 Projection;
+	uniform float Width;
+
+	// Output weight for the basic fragment shader, across the line.
+	out float fragmentWeight;
+
+	vec2 Direction( vec2 from, vec2 to, vec2 fallback )
+	{
+		vec2 d = to - from;
+		float l = length( d );
+		return l > 0.0001 ? d / l : fallback;
+	}
+
+	vec2 Normal( vec2 d )
+	{
+		return vec2( -d.y, d.x );
+	}
+
+	void main()
+	{
+		vec2 segment = Direction( inputA, inputB, vec2( 1.0, 0.0 ) );
+
+		// Vertices 0 and 1 sit on A, 2 and 3 on B. Even vertices are on the left side.
+		bool atB = gl_VertexID >= 2;
+		float side = (gl_VertexID % 2) == 0 ? -1.0 : 1.0;
+
+		vec2 point = atB ? inputB : inputA;
+		vec2 neighbour = atB ? Direction( inputB, inputNext, segment ) : Direction( inputPrevious, inputA, segment );
+		vec2 tangent = Direction( vec2( 0.0 ), segment + neighbour, segment );
+		vec2 miter = Normal( tangent );
+
+		// Limit the miter length on sharp joints.
+		float miterLength = (Width * 0.5) / max( dot( miter, Normal( segment ) ), 0.25 );
+
+		fragmentWeight = side * 0.5 + 0.5;
+
+		gl_Position = Projection * vec4( point + miter * miterLength * side, 0.0, 1.0 );
+	}
+);
+
+//
+// Texture geometry vertex shader.
 //
-static const char* textureMaskGeometryVertexShaderSource = GLSL(
+static const char* textureGeometryVertexShaderSource = GLSL(
 	// Vertex attributes.
 	layout( location = 0 ) in vec2 inputXY;
-	layout( location = 1 ) in vec2 inputST;
+	layout( location = 1 ) in vec3 inputSTP;
 	layout( location = 2 ) in float inputWeight;
 
 	// Uniform transformation matrices.
 	uniform mat4 Projection;
 
-	// Output color for the fragment shader.
-	out vec2 fragmentST;
+	// Output texture coordinate and layer, and color weight for the fragment shader.
+	out vec3 fragmentSTP;
 	out float fragmentWeight;
 
 	void main()
 	{
-		fragmentST = inputST;
+		fragmentSTP = inputSTP;
 		fragmentWeight = inputWeight;
 
 		gl_Position = Projection * vec4( inputXY, 0.0, 1.0 );
 	}
 );
 //
-// Basic geometry fragment shader.
+// Texture geometry fragment shader.
+//
+static const char* textureGeometryFragmentShaderSource = GLSL(
+	in vec3 fragmentSTP;
+	in float fragmentWeight;
+
+	uniform sampler2DArray Texture;
+	uniform float Opacity;
+
+	out vec4 outColor;
+
+	void main()
+	{
+		// Colors are premultiplied by alpha.
+		outColor = texture( Texture, fragmentSTP ) * Opacity;
+	}
+);
+//
+// Texture mask geometry fragment shader.
 //
 static const char* textureMaskGeometryFragmentShaderSource = GLSL(
-	in vec2 fragmentST;
+	in vec3 fragmentSTP;
+	in float fragmentWeight;
+
+	uniform sampler2DArray Texture;
+	uniform vec4 ColorA;
+	uniform vec4 ColorB;
+	uniform float Opacity;
+
+	out vec4 outColor;
+
+	void main()
+	{
+		float textureOpacity = texture( Texture, fragmentSTP ).r;
+		vec4 mixedColor = mix( ColorA, ColorB, fragmentWeight );
+		outColor = vec4( mixedColor.rgb, mixedColor.a * Opacity * textureOpacity );
+	}
+);
+//
+// Texture distance field geometry fragment shader. The texture holds signed distance fields, the outline at 0.5.
+//
+static const char* textureDistanceFieldGeometryFragmentShaderSource = GLSL(
+	in vec3 fragmentSTP;
 	in float fragmentWeight;
 
-	uniform sampler2D Texture;
+	uniform sampler2DArray Texture;
 	uniform vec4 ColorA;
 	uniform vec4 ColorB;
 	uniform float Opacity;
@@ -124,7 +215,10 @@ static const char* textureMaskGeometryFragmentShaderSource = GLSL(
 
 	void main()
 	{
-		float textureOpacity = texture( Texture, fragmentST ).r;
+		float distance = texture( Texture, fragmentSTP ).r;
+		// Antialias over about a pixel, whatever the scale the field is drawn at.
+		float smoothing = max( fwidth( distance ) * 0.75, 1.0 / 255.0 );
+		float textureOpacity = smoothstep( 0.5 - smoothing, 0.5 + smoothing, distance );
 		vec4 mixedColor = mix( ColorA, ColorB, fragmentWeight );
 		outColor = vec4( mixedColor.rgb, mixedColor.a * Opacity * textureOpacity );
 	}
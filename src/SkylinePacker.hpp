@@ -0,0 +1,191 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+namespace kodogl
+{
+	struct Region
+	{
+		int32_t X;
+		int32_t Y;
+		int32_t W;
+		int32_t H;
+
+		Region() : X( 0 ), Y( 0 ), W( 0 ), H( 0 ) {}
+		Region( int32_t x, int32_t y, int32_t width, int32_t height ) : X( x ), Y( y ), W( width ), H( height ) { }
+	};
+
+	struct AtlasNode
+	{
+		int32_t X;
+		int32_t Y;
+		int32_t Z;
+
+		explicit AtlasNode() : X( 0 ), Y( 0 ), Z( 0 ) {}
+		explicit AtlasNode( int32_t x, int32_t y, int32_t z ) : X( x ), Y( y ), Z( z ) {}
+	};
+
+	//
+	// Packs rectangles into an area with the skyline bottom-left heuristic.
+	// A border of one unit is kept free around the area.
+	//
+	class SkylinePacker
+	{
+		size_t width;
+		size_t height;
+		size_t used;
+
+		// The skyline, left to right: each node is a segment starting at (X, Y), Z wide.
+		std::vector<AtlasNode> nodes;
+
+	public:
+
+		SkylinePacker( size_t width, size_t height ) :
+			width( width ), height( height ), used( 0 )
+		{
+			nodes.push_back( AtlasNode{ 1, 1, static_cast<int32_t>(width - 2) } );
+		}
+
+		//
+		// Restores a packer from the skyline and the used area of another one.
+		//
+		SkylinePacker( size_t width, size_t height, std::vector<AtlasNode> nodes, size_t used ) :
+			width( width ), height( height ), used( used ), nodes( std::move( nodes ) )
+		{
+		}
+
+		size_t Width() const { return width; }
+		size_t Height() const { return height; }
+
+		//
+		// The area covered by the packed rectangles.
+		//
+		size_t Used() const
+		{
+			return used;
+		}
+
+		const std::vector<AtlasNode>& Nodes() const
+		{
+			return nodes;
+		}
+
+		//
+		// Gets the requested region and indicates whether or not it fits.
+		//
+		bool GetRegion( int32_t regionWidth, int32_t regionHeight, Region& region )
+		{
+			auto bestHeight = size_t( UINT_MAX );
+			auto bestWidth = size_t( UINT_MAX );
+			auto bestIndex = -1;
+			auto fittedX = 0;
+			auto fittedY = 0;
+
+			for (size_t i = 0; i < nodes.size(); ++i)
+			{
+				auto& node = nodes[i];
+
+				// Regions are never placed below the node they start at, so a node already higher than the best fit can't beat it.
+				if (static_cast<size_t>(node.Y + regionHeight) > bestHeight)
+					continue;
+
+				auto y = Fit( i, regionWidth, regionHeight, bestHeight );
+
+				if (y >= 0)
+				{
+					if (static_cast<size_t>(y + regionHeight) < bestHeight ||
+						(y + regionHeight == bestHeight && (node.Z > 0 && static_cast<size_t>(node.Z) < bestWidth)))
+					{
+						bestHeight = y + regionHeight;
+						bestIndex = static_cast<int>(i);
+						bestWidth = node.Z;
+						fittedX = node.X;
+						fittedY = y;
+					}
+				}
+			}
+
+			if (bestIndex == -1)
+			{
+				return false;
+			}
+
+			nodes.insert( nodes.cbegin() + bestIndex, AtlasNode{ fittedX, fittedY + regionHeight, regionWidth } );
+
+			//
+			// Drop the nodes the region covers completely in one go, and shorten the one it covers partly.
+			//
+			auto right = fittedX + regionWidth;
+			auto covered = static_cast<size_t>(bestIndex + 1);
+
+			while (covered < nodes.size() && nodes[covered].X + nodes[covered].Z <= right)
+				++covered;
+
+			if (covered < nodes.size() && nodes[covered].X < right)
+			{
+				nodes[covered].Z -= right - nodes[covered].X;
+				nodes[covered].X = right;
+			}
+
+			nodes.erase( nodes.cbegin() + bestIndex + 1, nodes.cbegin() + covered );
+
+			Merge( bestIndex );
+			used += regionWidth * regionHeight;
+			region = Region{ fittedX, fittedY, regionWidth, regionHeight };
+			return true;
+		}
+
+	private:
+
+		//
+		// The height a region starting at a node would be placed at, or -1 if it doesn't fit or can't beat the best height so far.
+		//
+		int32_t Fit( size_t index, size_t regionWidth, size_t regionHeight, size_t bestHeight ) const
+		{
+			auto node = nodes[index];
+			auto i = index;
+			auto x = node.X;
+			auto y = node.Y;
+			auto width_left = static_cast<int32_t>(regionWidth);
+
+			if (x + regionWidth > width - 1)
+				return -1;
+
+			while (width_left > 0)
+			{
+				node = nodes[i];
+
+				if (node.Y > y)
+					y = node.Y;
+
+				if (y + regionHeight > height - 1 || y + regionHeight > bestHeight)
+					return -1;
+
+				width_left -= node.Z;
+				++i;
+			}
+
+			return y;
+		}
+
+		//
+		// Join the new node at index with its neighbours at the same height; no other nodes can have changed.
+		//
+		void Merge( size_t index )
+		{
+			if (index + 1 < nodes.size() && nodes[index].Y == nodes[index + 1].Y)
+			{
+				nodes[index].Z += nodes[index + 1].Z;
+				nodes.erase( nodes.cbegin() + index + 1 );
+			}
+
+			if (index > 0 && nodes[index - 1].Y == nodes[index].Y)
+			{
+				nodes[index - 1].Z += nodes[index].Z;
+				nodes.erase( nodes.cbegin() + index );
+			}
+		}
+	};
+}
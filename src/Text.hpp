@@ -4,25 +4,45 @@
 #include "Atlas.hpp"
 #include "AtlasFont.hpp"
 #include "Brush.hpp"
+#include "TextRun.hpp"
 
 namespace kodogl
 {
-	enum class TextAligment
-	{
-		Near,
-		Mid,
-		Far
-	};
-
 	class TextLayout
 	{
-		VertexBuffer<Vertex2f2f1f>& vertexBuffer;
+		VertexBuffer<Vertex2f3f1f>& vertexBuffer;
 
 		GLuint idOfVertices;
 
 		glm::vec2 position;
 		glm::vec2 dimensions;
 
+		void Push( const TextRun& run, const glm::vec4& bounds, TextAligment xAlign, TextAligment yAlign )
+		{
+			auto origin = run.Origin( bounds, xAlign, yAlign );
+			auto countOfQuads = static_cast<glm::uint32>(run.Vertices.size() / 4);
+
+			glm::uint32 vI, iI;
+			idOfVertices = vertexBuffer.AllocateQuads( countOfQuads, &vI, &iI );
+
+			// Aligned by offsetting the quads as they're copied to the buffer.
+			std::array<Vertex2f3f1f, 4> quad;
+
+			for (glm::uint32 i = 0; i < countOfQuads; i++)
+			{
+				for (auto v = 0; v < 4; v++)
+				{
+					quad[v] = run.Vertices[i * 4 + v];
+					quad[v].Vertex += origin;
+				}
+
+				vertexBuffer.PushQuadTo( vI, iI, i, quad );
+			}
+
+			position = glm::vec2( 0.0f );
+			dimensions = run.Dimensions;
+		}
+
 	public:
 
 		const glm::vec2& Dimensions() const
@@ -58,103 +78,26 @@ namespace kodogl
 			other.idOfVertices = 0;
 		}
 
-		explicit TextLayout( const std::string& text, const AtlasFont& font, VertexBuffer<Vertex2f2f1f>& vertexBuffer, const glm::vec4& bounds, TextAligment xAlign = TextAligment::Near, TextAligment yAlign = TextAligment::Near ) :
+		//
+		// Lay out text with a font. Size is the size to draw the text at, 0 for the size of the font;
+		// only distance field fonts stay sharp at other sizes.
+		//
+		explicit TextLayout( const std::string& text, const AtlasFont& font, VertexBuffer<Vertex2f3f1f>& vertexBuffer, const glm::vec4& bounds, TextAligment xAlign = TextAligment::Near, TextAligment yAlign = TextAligment::Near, float_t size = 0.0f ) :
 			vertexBuffer( vertexBuffer )
 		{
-			auto calculatedWidth = 0.0f;
-			auto calculatedHeight = 0.0f;
-			auto calculatedYOffset = 10000000.0f;
-
-			{
-				CodepointEnumerator testcodepoints{ text };
-
-				while (testcodepoints)
-				{
-					auto codepoint = testcodepoints.Next();
-
-					if (codepoint == 10) // Line Feed U+000A
-					{
-						//textLocation.y -= font.BaselineToBaseline;
-						//textLocation.x = 0;
-						continue;
-					}
-
-					auto glyph = font.GetGlyph( codepoint, true );
-					calculatedWidth += glyph.AdvanceX;
-					calculatedHeight = glm::max( calculatedHeight, glyph.Height );
-					calculatedYOffset = glm::min( calculatedYOffset, glyph.OffsetY - glyph.Height );
-				}
-			}
-
-			dimensions = glm::vec2( calculatedWidth, glm::abs( calculatedHeight ) + glm::abs( calculatedYOffset ) );
-
-			glm::vec2 textLocation;
-
-			if (xAlign == TextAligment::Near)
-			{
-				textLocation.x = bounds.x;
-			}
-			else if (xAlign == TextAligment::Mid)
-			{
-				textLocation.x = bounds.x + (bounds.z - bounds.x) / dimensions.x;
-			}
-			else
-			{
-				textLocation.x = bounds.z - dimensions.x;
-			}
-
-			if (yAlign == TextAligment::Near)
-			{
-				textLocation.y = bounds.y;
-			}
-			else if (yAlign == TextAligment::Mid)
-			{
-				textLocation.y = bounds.y + (bounds.w - bounds.y) / dimensions.y;
-			}
-			else
-			{
-				textLocation.y = bounds.w - dimensions.y;
-			}
-
-			std::vector<Vertex2f2f1f> vertices;
-
-			CodepointEnumerator codepoints{ text };
-
-			while (codepoints)
-			{
-				auto codepoint = codepoints.Next();
-
-				if (codepoint == 10) // Line Feed U+000A
-				{
-					textLocation.y -= font.BaselineToBaseline;
-					textLocation.x = 0;
-					continue;
-				}
+			TextRun run;
+			TextRun::Layout( font, text.data(), text.size(), size, run );
 
-				auto glyph = font.GetGlyph( codepoint, true );
-				auto x0 = textLocation.x + glyph.OffsetX;
-				auto y0 = textLocation.y - glyph.OffsetY;
-				auto x1 = x0 + glyph.Width;
-				auto y1 = y0 + glyph.Height;
-				auto s0 = glyph.Region.L;
-				auto t0 = glyph.Region.T;
-				auto s1 = glyph.Region.R;
-				auto t1 = glyph.Region.B;
-
-				vertices.emplace_back( x0, y0, s0, t0, 1.0f );
-				vertices.emplace_back( x0, y1, s0, t1, 1.0f );
-				vertices.emplace_back( x1, y1, s1, t1, 1.0f );
-				vertices.emplace_back( x1, y0, s1, t0, 1.0f );
-
-				textLocation.x += glyph.AdvanceX;
-				textLocation.y += glyph.AdvanceY;
-
-				calculatedWidth += glyph.AdvanceX;
-				calculatedHeight = glm::max( glyph.Height, glyph.Height );
-				calculatedYOffset = glm::min( calculatedYOffset, glyph.OffsetY - glyph.Height );
-			}
+			Push( run, bounds, xAlign, yAlign );
+		}
 
-			idOfVertices = vertexBuffer.PushQuads( vertices );
+		//
+		// Place text laid out before, e.g. a run of a TextRunCache.
+		//
+		explicit TextLayout( const TextRun& run, VertexBuffer<Vertex2f3f1f>& vertexBuffer, const glm::vec4& bounds, TextAligment xAlign = TextAligment::Near, TextAligment yAlign = TextAligment::Near ) :
+			vertexBuffer( vertexBuffer )
+		{
+			Push( run, bounds, xAlign, yAlign );
 		}
 
 		void Update( const glm::vec2& pos, const glm::vec4& col )
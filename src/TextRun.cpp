@@ -0,0 +1,326 @@
+#include "TextRun.hpp"
+
+#include <cfloat>
+#include <emmintrin.h>
+
+namespace kodogl
+{
+	void TextRun::Layout(const AtlasFont& font, const char* text, size_t length, float_t size, TextRun& run)
+	{
+		auto scale = size > 0.0f ? size / font.Size : 1.0f;
+		const auto& glyphs = font.Glyphs();
+
+		run.Vertices.clear();
+		run.Pages.clear();
+
+		// Each byte is at most a glyph; the capacity stays with the run when it's laid out again.
+		run.Vertices.reserve(length * 4);
+
+		// Extents of the glyphs, down from the baseline of the first line.
+		auto width = 0.0f;
+		auto top = FLT_MAX;
+		auto bottom = -FLT_MAX;
+
+		glm::vec2 textLocation(0.0f);
+		auto previous = utf8::uint32_t(0);
+		auto lastPage = uint32_t(-1);
+
+		//
+		// Measure and emit in one pass, at the origin; the run is aligned by offsetting its quads when placed.
+		//
+		auto emit = [&](utf8::uint32_t codepoint)
+		{
+			if (codepoint == 10) // Line Feed U+000A
+			{
+				textLocation.y += font.BaselineToBaseline * scale;
+				textLocation.x = 0;
+				previous = 0;
+				return;
+			}
+
+			auto slot = font.FindGlyph(codepoint, true);
+			textLocation.x += font.Kerning(previous, codepoint) * scale;
+			previous = codepoint;
+
+			const auto& box = glyphs.Box(slot);
+			const auto& region = glyphs.Region(slot);
+			auto page = glyphs.Page(slot);
+
+			auto x0 = textLocation.x + box.x * scale;
+			auto y0 = textLocation.y - box.y * scale;
+			auto x1 = x0 + box.z * scale;
+			auto y1 = y0 + box.w * scale;
+			auto p = static_cast<float_t>(page);
+
+			run.Vertices.emplace_back(x0, y0, region.L, region.T, p, 1.0f);
+			run.Vertices.emplace_back(x0, y1, region.L, region.B, p, 1.0f);
+			run.Vertices.emplace_back(x1, y1, region.R, region.B, p, 1.0f);
+			run.Vertices.emplace_back(x1, y0, region.R, region.T, p, 1.0f);
+
+			if (page != lastPage && std::find(run.Pages.begin(), run.Pages.end(), page) == run.Pages.end())
+				run.Pages.push_back(page);
+
+			lastPage = page;
+
+			top = glm::min(top, y0);
+			bottom = glm::max(bottom, y1);
+
+			textLocation.x += glyphs.AdvanceX(slot) * scale;
+			textLocation.y += glyphs.AdvanceY(slot) * scale;
+
+			width = glm::max(width, textLocation.x);
+		};
+
+		auto it = text;
+		auto end = text + length;
+
+		while (it != end)
+		{
+			//
+			// A block of 16 bytes without a high bit set is ASCII, each byte its own codepoint.
+			//
+			if (end - it >= 16 && _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(it))) == 0)
+			{
+				for (auto endOfBlock = it + 16; it != endOfBlock; ++it)
+					emit(static_cast<utf8::uint32_t>(*it));
+
+				continue;
+			}
+
+			if (static_cast<uint8_t>(*it) < 0x80)
+				emit(static_cast<utf8::uint32_t>(*it++));
+			else
+				emit(utf8::next(it, end));
+		}
+
+		if (top > bottom)
+			top = bottom = 0.0f;
+
+		run.Dimensions = glm::vec2(width, bottom - top);
+		run.Ascent = -top;
+
+		// Rasterizing may have cleared pages, though never those of glyphs used in this frame.
+		run.Generation = font.GetAtlas().Generation();
+	}
+
+	glm::vec2 TextRun::Origin(const glm::vec2& dimensions, float_t ascent, const glm::vec4& bounds, TextAligment xAlign, TextAligment yAlign)
+	{
+		glm::vec2 origin;
+
+		if (xAlign == TextAligment::Near)
+		{
+			origin.x = bounds.x;
+		}
+		else if (xAlign == TextAligment::Mid)
+		{
+			origin.x = bounds.x + (bounds.z - bounds.x - dimensions.x) * 0.5f;
+		}
+		else
+		{
+			origin.x = bounds.z - dimensions.x;
+		}
+
+		if (yAlign == TextAligment::Near)
+		{
+			origin.y = bounds.y;
+		}
+		else if (yAlign == TextAligment::Mid)
+		{
+			origin.y = bounds.y + (bounds.w - bounds.y - dimensions.y) * 0.5f;
+		}
+		else
+		{
+			origin.y = bounds.w - dimensions.y;
+		}
+
+		// The pen starts on the baseline, below the top of the run.
+		origin.y += ascent;
+
+		return origin;
+	}
+
+	void AppendUtf8(const char16_t* text, size_t length, std::string& utf8)
+	{
+		auto out = std::back_inserter(utf8);
+
+		for (size_t i = 0; i < length; i++)
+		{
+			auto codepoint = static_cast<utf8::uint32_t>(text[i]);
+
+			if (utf8::internal::is_lead_surrogate(codepoint))
+			{
+				if (i + 1 < length && utf8::internal::is_trail_surrogate(text[i + 1]))
+				{
+					codepoint = (codepoint << 10) + text[++i] + utf8::internal::SURROGATE_OFFSET;
+				}
+				else
+				{
+					codepoint = 0xFFFD;
+				}
+			}
+			else if (utf8::internal::is_trail_surrogate(codepoint))
+			{
+				codepoint = 0xFFFD;
+			}
+
+			out = utf8::unchecked::append(codepoint, out);
+		}
+	}
+
+	size_t Utf8Offset(const std::string& utf8, size_t utf16Offset)
+	{
+		size_t offset = 0;
+
+		while (utf16Offset > 0 && offset < utf8.size())
+		{
+			auto lead = static_cast<glm::uint8>(utf8[offset]);
+			auto length = utf8::internal::sequence_length(utf8.begin() + offset);
+
+			// Codepoints beyond the BMP, of 4 bytes, are surrogate pairs in UTF-16.
+			auto units = lead >= 0xF0 ? size_t(2) : size_t(1);
+
+			if (units > utf16Offset)
+				break;
+
+			offset += glm::max<size_t>(1, length);
+			utf16Offset -= units;
+		}
+
+		return utf16Offset == 0 ? offset : std::string::npos;
+	}
+
+	TextRunCache::TextRunCache(size_t capacity) :
+		capacity(glm::max<size_t>(1, capacity)),
+		hits(0),
+		misses(0)
+	{
+	}
+
+	glm::uint64 TextRunCache::Key(const AtlasFont& font, const char* text, size_t length, float_t size)
+	{
+		// 64-bit FNV-1a over the text, the font and the size.
+		glm::uint64 hash = 0xCBF29CE484222325ull;
+
+		auto mix = [&hash](const void* data, size_t size)
+		{
+			const auto* bytes = static_cast<const uint8_t*>(data);
+
+			for (size_t i = 0; i < size; i++)
+			{
+				hash ^= bytes[i];
+				hash *= 0x100000001B3ull;
+			}
+		};
+
+		const auto* fontPointer = &font;
+
+		mix(text, length);
+		mix(&fontPointer, sizeof(fontPointer));
+		mix(&size, sizeof(size));
+
+		return hash;
+	}
+
+	void TextRunCache::Lay(const AtlasFont& font, const char* text, size_t length, float_t size, std::list<Entry>::iterator entry)
+	{
+		try
+		{
+			TextRun::Layout(font, text, length, size, entry->Run);
+		}
+		catch (...)
+		{
+			// A run left half laid out would be a hit the next time.
+			index.erase(entry->Key);
+			entries.erase(entry);
+			throw;
+		}
+	}
+
+	const TextRun& TextRunCache::Get(const AtlasFont& font, const char* text, size_t length, float_t size)
+	{
+		auto key = Key(font, text, length, size);
+		auto found = index.find(key);
+
+		std::list<Entry>::iterator entry;
+
+		if (found != index.end())
+		{
+			entry = found->second;
+			entries.splice(entries.begin(), entries, entry);
+
+			if (entry->Font == &font && entry->Size == size && entry->Text.size() == length && entry->Text.compare(0, length, text, length) == 0)
+			{
+				if (entry->Run.Generation == font.GetAtlas().Generation())
+				{
+					hits++;
+
+					// The glyphs aren't looked up, so keep their pages from being cleared.
+					font.Touch(entry->Run.Pages);
+					return entry->Run;
+				}
+
+				misses++;
+				Lay(font, text, length, size, entry);
+				return entry->Run;
+			}
+
+			// Another text of the same key; it's replaced.
+		}
+		else if (entries.size() >= capacity)
+		{
+			// Reuse the run used least recently, with its storage.
+			entry = std::prev(entries.end());
+			index.erase(entry->Key);
+			entries.splice(entries.begin(), entries, entry);
+		}
+		else
+		{
+			entries.emplace_front();
+			entry = entries.begin();
+		}
+
+		misses++;
+
+		entry->Key = key;
+		entry->Font = &font;
+		entry->Size = size;
+		entry->Text.assign(text, length);
+		index[key] = entry;
+
+		Lay(font, text, length, size, entry);
+		return entry->Run;
+	}
+
+	void TextRunCache::Capacity(size_t runs)
+	{
+		capacity = glm::max<size_t>(1, runs);
+
+		while (entries.size() > capacity)
+		{
+			index.erase(entries.back().Key);
+			entries.pop_back();
+		}
+	}
+
+	void TextRunCache::Clear()
+	{
+		index.clear();
+		entries.clear();
+	}
+
+	void TextRunCache::Clear(const AtlasFont& font)
+	{
+		for (auto it = entries.begin(); it != entries.end();)
+		{
+			if (it->Font == &font)
+			{
+				index.erase(it->Key);
+				it = entries.erase(it);
+			}
+			else
+			{
+				++it;
+			}
+		}
+	}
+}
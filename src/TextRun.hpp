@@ -0,0 +1,139 @@
+#pragma once
+
+#include "VertexBuffer.hpp"
+#include "Atlas.hpp"
+#include "AtlasFont.hpp"
+
+#include <list>
+
+namespace kodogl
+{
+	enum class TextAligment
+	{
+		Near,
+		Mid,
+		Far
+	};
+
+	//
+	// Text laid out with a font, as quads relative to the pen position at the start of the first line.
+	// Y grows downwards, so lines follow below the first one.
+	//
+	struct TextRun
+	{
+		// Four vertices per glyph.
+		std::vector<Vertex2f3f1f> Vertices;
+		// Width of the longest line, and height from the top of the highest glyph to the bottom of the lowest one.
+		glm::vec2 Dimensions;
+		// Distance from the top of the run down to the baseline of the first line.
+		float_t Ascent;
+
+		// Pages of the atlas holding the glyphs.
+		std::vector<uint32_t> Pages;
+		// Generation of the atlas the glyphs were looked up in. A later one may have cleared their pages.
+		glm::uint64 Generation;
+
+		TextRun() : Dimensions( 0.0f ), Ascent( 0.0f ), Generation( 0 ) {}
+
+		//
+		// Lay out UTF-8 text, reusing the storage of the run. Size is the size to draw the text at, 0 for the size of the font;
+		// only distance field fonts stay sharp at other sizes.
+		//
+		static void Layout( const AtlasFont& font, const char* text, size_t length, float_t size, TextRun& run );
+
+		//
+		// Where the pen starts for the run to be aligned within bounds (left, top, right, bottom).
+		//
+		glm::vec2 Origin( const glm::vec4& bounds, TextAligment xAlign, TextAligment yAlign ) const
+		{
+			return Origin( Dimensions, Ascent, bounds, xAlign, yAlign );
+		}
+
+		static glm::vec2 Origin( const glm::vec2& dimensions, float_t ascent, const glm::vec4& bounds, TextAligment xAlign, TextAligment yAlign );
+	};
+
+	//
+	// Append UTF-16 text as UTF-8, replacing unpaired surrogates with U+FFFD.
+	//
+	void AppendUtf8( const char16_t* text, size_t length, std::string& utf8 );
+
+	//
+	// Byte offset within UTF-8 text of an offset in UTF-16 code units, std::string::npos past the end of the text.
+	//
+	size_t Utf8Offset( const std::string& utf8, size_t utf16Offset );
+
+	//
+	// Runs laid out recently, keyed by font, size and text, so labels drawn every frame are laid out once.
+	// Holds up to a capacity of runs, dropping the one used least recently. Runs laid out before a page of
+	// their atlas was cleared are laid out again.
+	//
+	class TextRunCache : public nocopy
+	{
+		struct Entry
+		{
+			glm::uint64 Key;
+			const AtlasFont* Font;
+			float_t Size;
+			std::string Text;
+			TextRun Run;
+		};
+
+		// Most recently used first.
+		std::list<Entry> entries;
+		std::unordered_map<glm::uint64, std::list<Entry>::iterator> index;
+
+		size_t capacity;
+
+		glm::uint64 hits;
+		glm::uint64 misses;
+
+		static glm::uint64 Key( const AtlasFont& font, const char* text, size_t length, float_t size );
+
+		//
+		// Lay out the run of an entry, dropping the entry when the text can't be laid out, e.g. isn't valid UTF-8.
+		//
+		void Lay( const AtlasFont& font, const char* text, size_t length, float_t size, std::list<Entry>::iterator entry );
+
+	public:
+
+		static constexpr size_t DefaultCapacity = 4096;
+
+		explicit TextRunCache( size_t capacity = DefaultCapacity );
+
+		//
+		// The run of UTF-8 text, laid out on a miss. The run stays valid until the next call.
+		//
+		const TextRun& Get( const AtlasFont& font, const char* text, size_t length, float_t size = 0.0f );
+
+		const TextRun& Get( const AtlasFont& font, const std::string& text, float_t size = 0.0f )
+		{
+			return Get( font, text.data(), text.size(), size );
+		}
+
+		//
+		// Limit the number of runs kept, dropping those used least recently. At least one run is kept.
+		//
+		void Capacity( size_t runs );
+
+		size_t Count() const
+		{
+			return entries.size();
+		}
+
+		glm::uint64 Hits() const
+		{
+			return hits;
+		}
+
+		glm::uint64 Misses() const
+		{
+			return misses;
+		}
+
+		//
+		// Drop every run, and the runs of a font before it's destroyed.
+		//
+		void Clear();
+		void Clear( const AtlasFont& font );
+	};
+}
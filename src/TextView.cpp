@@ -0,0 +1,262 @@
+#include "TextView.hpp"
+#include "Atlas.hpp"
+
+#include <cstring>
+#include <iterator>
+
+namespace kodogl
+{
+	namespace
+	{
+		// Push the offsets following the line feeds within [from, to) of data.
+		void ScanLineFeeds(const glm::uint8* data, size_t from, size_t to, std::vector<size_t>& starts)
+		{
+			starts.clear();
+
+			const auto* it = data + from;
+			const auto* end = data + to;
+
+			while (it != end)
+			{
+				const auto* feed = static_cast<const glm::uint8*>(std::memchr(it, '\n', end - it));
+
+				if (feed == nullptr)
+					break;
+
+				starts.push_back(static_cast<size_t>(feed - data) + 1);
+				it = feed + 1;
+			}
+		}
+	}
+
+	TextView::TextView(const std::string& filename, const AtlasFont& font, float_t size) :
+		file(filename),
+		font(font),
+		size(size),
+		lineHeight(font.BaselineToBaseline * (size > 0.0f ? size / font.Size : 1.0f)),
+		indexed(false),
+		stopping(false)
+	{
+		lineStarts.push_back(0);
+
+		if (!file.IsOpen())
+		{
+			// Missing and empty files have no lines.
+			indexed = true;
+			return;
+		}
+
+		indexer = std::thread(&TextView::Index, this);
+	}
+
+	TextView::~TextView()
+	{
+		stopping = true;
+
+		if (indexer.joinable())
+			indexer.join();
+	}
+
+	void TextView::Index()
+	{
+		auto sizeOfFile = file.Size();
+		auto countOfThreads = static_cast<size_t>(glm::max(1u, std::thread::hardware_concurrency()));
+
+		std::vector<std::vector<size_t>> startsOfThreads(countOfThreads);
+		auto complete = true;
+
+		try
+		{
+			IndexSegments(startsOfThreads);
+		}
+		catch (const std::exception&)
+		{
+			// Out of memory; the lines indexed so far stay viewable.
+			complete = false;
+		}
+
+		std::lock_guard<std::mutex> lock(mutex);
+
+		// The last line ends at the end of the file rather than at a line feed.
+		if (complete && !stopping && lineStarts.back() < sizeOfFile)
+			lineStarts.push_back(sizeOfFile + 1);
+
+		indexed = true;
+	}
+
+	void TextView::IndexSegments(std::vector<std::vector<size_t>>& startsOfThreads)
+	{
+		const auto* data = file.Data();
+		auto sizeOfFile = file.Size();
+		auto countOfThreads = startsOfThreads.size();
+
+		for (size_t segment = 0; segment < sizeOfFile && !stopping; segment += BytesPerSegment)
+		{
+			auto endOfSegment = glm::min(sizeOfFile, segment + BytesPerSegment);
+			auto threadCount = glm::min(countOfThreads, (endOfSegment - segment) / ParallelThreshold + 1);
+			auto bytesPerThread = (endOfSegment - segment + threadCount - 1) / threadCount;
+
+			auto scan = [&](size_t t)
+			{
+				auto from = glm::min(endOfSegment, segment + t * bytesPerThread);
+				auto to = glm::min(endOfSegment, from + bytesPerThread);
+
+				ScanLineFeeds(data, from, to, startsOfThreads[t]);
+			};
+
+			std::vector<std::thread> threads;
+
+			for (size_t t = 1; t < threadCount; t++)
+			{
+				try
+				{
+					threads.emplace_back(scan, t);
+				}
+				catch (const std::system_error&)
+				{
+					// Out of threads, the part is scanned on this one.
+					scan(t);
+				}
+			}
+
+			scan(0);
+
+			for (auto& thread : threads)
+				thread.join();
+
+			// Parts of the segment are in order, so are their lines.
+			std::lock_guard<std::mutex> lock(mutex);
+
+			for (size_t t = 0; t < threadCount; t++)
+				lineStarts.insert(lineStarts.end(), startsOfThreads[t].begin(), startsOfThreads[t].end());
+		}
+	}
+
+	size_t TextView::CountOfLines() const
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		// Each line ends where the next one starts.
+		return lineStarts.size() - 1;
+	}
+
+	bool TextView::Indexed() const
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return indexed;
+	}
+
+	void TextView::Release(Line& line)
+	{
+		spareRuns.push_back(std::move(line.Run));
+	}
+
+	TextView::Line TextView::Acquire(size_t index, size_t first)
+	{
+		Line line;
+		line.Index = index;
+
+		if (!spareRuns.empty())
+		{
+			line.Run = std::move(spareRuns.back());
+			spareRuns.pop_back();
+		}
+
+		Lay(line, first);
+		return line;
+	}
+
+	void TextView::Lay(Line& line, size_t first)
+	{
+		auto from = starts[line.Index - first];
+		// The line feed ending the line, or the end of the file.
+		auto to = starts[line.Index - first + 1] - 1;
+
+		const auto* begin = reinterpret_cast<const char*>(file.Data()) + from;
+		auto length = to - from;
+
+		if (length > 0 && begin[length - 1] == '\r')
+			length--;
+
+		// Cut long lines on a character boundary.
+		if (length > MaxLengthOfLine)
+		{
+			length = MaxLengthOfLine;
+
+			while (length > 0 && (static_cast<glm::uint8>(begin[length]) & 0xC0) == 0x80)
+				length--;
+		}
+
+		if (!utf8::is_valid(begin, begin + length))
+		{
+			text.clear();
+			utf8::replace_invalid(begin, begin + length, std::back_inserter(text));
+
+			begin = text.data();
+			length = text.size();
+		}
+
+		TextRun::Layout(font, begin, length, size, line.Run);
+	}
+
+	const std::deque<TextView::Line>& TextView::Layout(size_t first, size_t last)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+
+			last = glm::min(last, lineStarts.size() - 1);
+			first = glm::min(first, last);
+
+			starts.assign(lineStarts.begin() + first, lineStarts.begin() + last + 1);
+		}
+
+		//
+		// Lines scrolled out give their runs to those scrolled in.
+		//
+		while (!lines.empty() && (lines.front().Index < first || lines.front().Index >= last))
+		{
+			Release(lines.front());
+			lines.pop_front();
+		}
+
+		while (!lines.empty() && lines.back().Index >= last)
+		{
+			Release(lines.back());
+			lines.pop_back();
+		}
+
+		auto generation = font.GetAtlas().Generation();
+
+		//
+		// Rasterizing may have cleared pages, though never those of glyphs used in this frame. The pages of the lines
+		// kept are used before any line is laid out again, so laying out one can't clear those of another.
+		//
+		for (auto& line : lines)
+		{
+			if (line.Run.Generation == generation)
+				font.Touch(line.Run.Pages);
+		}
+
+		for (auto& line : lines)
+		{
+			if (line.Run.Generation != generation)
+				Lay(line, first);
+		}
+
+		if (lines.empty())
+		{
+			for (auto index = first; index < last; index++)
+				lines.push_back(Acquire(index, first));
+		}
+		else
+		{
+			for (auto index = lines.front().Index; index > first; index--)
+				lines.push_front(Acquire(index - 1, first));
+
+			for (auto index = lines.back().Index + 1; index < last; index++)
+				lines.push_back(Acquire(index, first));
+		}
+
+		return lines;
+	}
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "kodo-gl.hpp"
+#include "MappedFile.hpp"
+#include "TextRun.hpp"
+
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace kodogl
+{
+	//
+	// A view of a UTF-8 text file too large to lay out, e.g. a log. The file is mapped into memory and its lines
+	// are indexed in the background, across threads; only the lines drawn are laid out. Lines laid out for the
+	// previous draw are kept while they stay visible, so scrolling lays out only the lines scrolled in.
+	//
+	class TextView : public nocopy
+	{
+	public:
+
+		struct Line
+		{
+			size_t Index;
+			TextRun Run;
+		};
+
+	private:
+
+		// Bytes indexed at once, split across threads; lines of a segment become visible when it's done.
+		static constexpr size_t BytesPerSegment = 64 * 1024 * 1024;
+		// Number of bytes above which a segment is indexed across threads.
+		static constexpr size_t ParallelThreshold = 1 << 20;
+		// Bytes of a line laid out at most, e.g. of a binary file without line feeds.
+		static constexpr size_t MaxLengthOfLine = 1 << 16;
+
+		MappedFile file;
+		const AtlasFont& font;
+		float_t size;
+		float_t lineHeight;
+
+		// Offsets of the starts of the lines indexed so far, and of the end of the last line plus one once indexed.
+		mutable std::mutex mutex;
+		std::deque<size_t> lineStarts;
+		bool indexed;
+
+		std::atomic<bool> stopping;
+		std::thread indexer;
+
+		// Lines laid out for the last draw, in order, and runs of lines scrolled out, reused for those scrolled in.
+		std::deque<Line> lines;
+		std::vector<TextRun> spareRuns;
+
+		// Scratch storage of the starts of the lines laid out, and of lines that aren't valid UTF-8.
+		std::vector<size_t> starts;
+		std::string text;
+
+		void Index();
+		void IndexSegments( std::vector<std::vector<size_t>>& startsOfThreads );
+
+		//
+		// Lay out a line, of the lines from first whose starts are in starts.
+		//
+		void Lay( Line& line, size_t first );
+
+		void Release( Line& line );
+		Line Acquire( size_t index, size_t first );
+
+	public:
+
+		//
+		// Open a file and start indexing its lines. Size is the size to draw the text at, 0 for the size of the font.
+		//
+		explicit TextView( const std::string& filename, const AtlasFont& font, float_t size = 0.0f );
+		~TextView();
+
+		bool IsOpen() const
+		{
+			return file.IsOpen();
+		}
+
+		const AtlasFont& Font() const
+		{
+			return font;
+		}
+
+		float_t LineHeight() const
+		{
+			return lineHeight;
+		}
+
+		//
+		// Distance from the top of a line down to its baseline.
+		//
+		float_t Ascender() const
+		{
+			return font.Ascender() * (size > 0.0f ? size / font.Size : 1.0f);
+		}
+
+		//
+		// Number of lines indexed so far, all of them once Indexed.
+		//
+		size_t CountOfLines() const;
+		bool Indexed() const;
+
+		//
+		// Lay out lines first up to last, those indexed so far, keeping lines laid out for the previous call.
+		// The lines stay valid until the next call.
+		//
+		const std::deque<Line>& Layout( size_t first, size_t last );
+	};
+}
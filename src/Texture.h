@@ -1,6 +1,10 @@
 #pragma once
 
 #include "kodo-gl.hpp"
+#include "ImageAtlas.hpp"
+#include "MappedFile.hpp"
+#include "Pixels.hpp"
+#include "TextureCompressor.hpp"
 
 #include <glm/glm.hpp>
 
@@ -12,50 +16,119 @@ namespace kodogl
 		explicit TextureException( std::string message ) : exception( message ) {}
 	};
 
+	//
+	// Number of mipmap levels of a texture of the specified size.
+	//
+	inline glm::uint32 CountOfTextureLevels( glm::uint32 width, glm::uint32 height )
+	{
+		const glm::uint32 maximumLevels = 4;
+
+		glm::uint32 levels = 1;
+
+		while (levels < maximumLevels && (glm::min( width, height ) >> levels) > 0)
+			levels++;
+
+		return levels;
+	}
+
 	class TextureLoader
 	{
-		FILE* fp;
+		//
+		// Read position within the encoded image, for the libpng read callback.
+		//
+		struct Span
+		{
+			const png_byte* Data;
+			size_t Size;
+			size_t Offset;
+		};
+
 		png_structp libpng;
 		png_infop libpngInfo;
 		png_infop linpngEndInfo;
 
+		Span span;
+
+		const TextureCompressor* compressor;
+
 	public:
 
-		GLuint id;
 		GLenum format;
 
 		glm::vec2 dimensions;
 
+		// Decoded pixels, bottom row first, rows tightly packed. RGBA8 colors are premultiplied by alpha.
+		// Textures with layers of their own hold all of their levels, one after the other; the mipmaps are
+		// made here, off the GL thread. Textures packed into an atlas hold level 0.
+		std::vector<png_byte> pixels;
+
+		// Size of each level the pixels hold; empty for textures packed into an atlas.
+		std::vector<size_t> sizeOfLevels;
+
 		~TextureLoader()
 		{
-			fclose( fp );
 			png_destroy_read_struct( &libpng, &libpngInfo, &linpngEndInfo );
 		}
 
-		void libpngUpdate( png_uint_32& pngWidth, png_uint_32& pngHeight, png_int_32& pngDepth, png_int_32& pngColor ) const
-		{
-			png_read_update_info( libpng, libpngInfo );
-			png_get_IHDR( libpng, libpngInfo, &pngWidth, &pngHeight, &pngDepth, &pngColor, nullptr, nullptr, nullptr );
-		}
-
 		static void libpngError( png_structp, png_const_charp msg )
 		{
 			throw TextureException( "libpng: Unknown/unsupported color type -> " + std::string( msg ) );
 		}
 
-		TextureLoader( const std::string& filename, bool onlyOpacity )
+		static void libpngRead( png_structp png, png_bytep bytes, png_size_t count )
 		{
-			png_byte header[8];
+			auto& span = *static_cast<Span*>(png_get_io_ptr( png ));
+
+			if (span.Size - span.Offset < count)
+				png_error( png, "Unexpected end of image data" );
 
-			// Open the file.
-			fopen_s( &fp, filename.c_str(), "rb" );
-			if (fp == nullptr)
+			memcpy( bytes, span.Data + span.Offset, count );
+			span.Offset += count;
+		}
+
+		//
+		// Decode a PNG file, reading it through a memory mapping.
+		// With a compressor, the texture is block compressed, or read from the compressor's cache.
+		//
+		TextureLoader( const std::string& filename, bool onlyOpacity, const TextureCompressor* compressor = nullptr ) :
+			libpng( nullptr ), libpngInfo( nullptr ), linpngEndInfo( nullptr ), compressor( compressor )
+		{
+			MappedFile file( filename );
+			if (!file.IsOpen())
 				throw TextureException( "Couldn't open -> " + filename );
 
-			// Read the header.
-			fread( header, 1, 8, fp );
-			if (png_sig_cmp( header, 0, 8 ))
+			span = Span{ file.Data(), file.Size(), 0 };
+			Load( filename, onlyOpacity );
+		}
+
+		//
+		// Decode a PNG image held in memory, e.g. embedded in the binary or part of a mapped pack.
+		//
+		TextureLoader( const void* data, size_t size, bool onlyOpacity, const TextureCompressor* compressor = nullptr ) :
+			libpng( nullptr ), libpngInfo( nullptr ), linpngEndInfo( nullptr ), compressor( compressor )
+		{
+			span = Span{ static_cast<const png_byte*>(data), size, 0 };
+			Load( "<memory>", onlyOpacity );
+		}
+
+	private:
+
+		void Load( const std::string& filename, bool onlyOpacity )
+		{
+			glm::uint64 key = 0;
+
+			if (compressor != nullptr)
+			{
+				key = TextureCompressor::Key( span.Data, span.Size, onlyOpacity );
+
+				if (compressor->Find( key, format, dimensions, pixels, sizeOfLevels ))
+					return;
+			}
+
+			// Check the header.
+			if (span.Size < 8 || png_sig_cmp( span.Data, 0, 8 ))
 				throw TextureException( "Not a PNG file -> " + filename );
+			span.Offset = 8;
 
 			// Create libpng structs.
 			libpng = png_create_read_struct( PNG_LIBPNG_VER_STRING, nullptr, libpngError, nullptr );
@@ -68,7 +141,7 @@ namespace kodogl
 			if (linpngEndInfo == nullptr)
 				throw TextureException( "png_create_info_struct failed -> " + filename );
 
-			png_init_io( libpng, fp );
+			png_set_read_fn( libpng, &span, libpngRead );
 			png_set_sig_bytes( libpng, 8 );
 
 			png_int_32 pngDepth, pngColor;
@@ -77,122 +150,519 @@ namespace kodogl
 			png_read_info( libpng, libpngInfo );
 			png_get_IHDR( libpng, libpngInfo, &pngWidth, &pngHeight, &pngDepth, &pngColor, nullptr, nullptr, nullptr );
 
-			if (pngDepth < 8) {
-				png_set_expand_gray_1_2_4_to_8( libpng );
-				libpngUpdate( pngWidth, pngHeight, pngDepth, pngColor );
-			}
-			if (pngColor == PNG_COLOR_TYPE_PALETTE) {
+			//
+			// Let libpng expand everything to 8-bit gray, gray + alpha, RGB or RGBA.
+			// The conversion to the texture format is done by ConvertRow.
+			//
+			if (pngDepth == 16)
+				png_set_strip_16( libpng );
+			if (pngColor == PNG_COLOR_TYPE_PALETTE)
 				png_set_palette_to_rgb( libpng );
-				libpngUpdate( pngWidth, pngHeight, pngDepth, pngColor );
-			}
-			if (pngColor == PNG_COLOR_TYPE_RGB || pngColor == PNG_COLOR_TYPE_GRAY) {
-				png_set_add_alpha( libpng, 1, PNG_FILLER_AFTER );
-				libpngUpdate( pngWidth, pngHeight, pngDepth, pngColor );
+			if (pngColor == PNG_COLOR_TYPE_GRAY && pngDepth < 8)
+				png_set_expand_gray_1_2_4_to_8( libpng );
+			if (png_get_valid( libpng, libpngInfo, PNG_INFO_tRNS ))
+				png_set_tRNS_to_alpha( libpng );
+
+			auto passes = png_set_interlace_handling( libpng );
+
+			png_read_update_info( libpng, libpngInfo );
+
+			auto channels = static_cast<glm::uint32>(png_get_channels( libpng, libpngInfo ));
+			if (channels < 1 || channels > 4)
+				throw TextureException( "Unknown/unsupported color type -> " + filename );
+
+			dimensions = glm::vec2( pngWidth, pngHeight );
+			format = onlyOpacity ? gl::R8 : gl::RGBA8;
+
+			// Rows are tightly packed.
+			size_t bytesPerRow = pngWidth * (onlyOpacity ? 1 : 4);
+			pixels.resize( bytesPerRow * pngHeight );
+
+			//
+			// Convert each row as it's decoded, while it's still in cache, and flip the image so the bottom row comes first.
+			// Interlaced images need all of their passes before any row is complete.
+			//
+			auto decodedBytesPerRow = png_get_rowbytes( libpng, libpngInfo );
+
+			std::vector<png_byte> decoded( passes > 1 ? decodedBytesPerRow * pngHeight : decodedBytesPerRow );
+			std::vector<png_byte*> decodedRows;
+
+			if (passes > 1)
+			{
+				decodedRows.resize( pngHeight );
+
+				for (png_uint_32 i = 0; i < pngHeight; i++)
+					decodedRows[i] = decoded.data() + i * decodedBytesPerRow;
+
+				png_read_image( libpng, decodedRows.data() );
 			}
 
-			if (onlyOpacity)
+			for (png_uint_32 i = 0; i < pngHeight; i++)
 			{
-				if (pngColor != PNG_COLOR_TYPE_GRAY_ALPHA)
+				const png_byte* row;
+
+				if (passes > 1)
 				{
-					png_set_rgb_to_gray( libpng, 1, 0, 0 );
-					libpngUpdate( pngWidth, pngHeight, pngDepth, pngColor );
+					row = decodedRows[i];
 				}
-			}
-			else if (pngColor != PNG_COLOR_TYPE_RGB_ALPHA)
-			{
-				if (pngColor == PNG_COLOR_TYPE_GRAY_ALPHA)
+				else
 				{
-					png_set_gray_to_rgb( libpng );
-					libpngUpdate( pngWidth, pngHeight, pngDepth, pngColor );
+					png_read_row( libpng, decoded.data(), nullptr );
+					row = decoded.data();
 				}
-				if (pngColor != PNG_COLOR_TYPE_RGB_ALPHA)
-					throw TextureException( "Unknown/unsupported color type -> " + filename );
+
+				ConvertRow( row, channels, pixels.data() + (pngHeight - 1 - i) * bytesPerRow, format, pngWidth );
 			}
 
-			// Get the row byte count and make sure alignment is correct.
-			auto bytesPerRow = png_get_rowbytes( libpng, libpngInfo );
-			bytesPerRow += 3 - ((bytesPerRow - 1) % 4);
+			if (compressor != nullptr)
+				compressor->Compress( key, format, dimensions, CountOfTextureLevels( pngWidth, pngHeight ), pixels, sizeOfLevels );
+			else if (!ImageAtlas::Packable( format, pngWidth, pngHeight ))
+				AppendMipmaps( pixels, pngWidth, pngHeight, onlyOpacity ? 1 : 4, CountOfTextureLevels( pngWidth, pngHeight ), sizeOfLevels );
+		}
+	};
 
-			// Allocate the image data.
-			std::vector<png_byte> imageData( static_cast<size_t>(bytesPerRow * pngHeight), 0 );
-			std::vector<png_byte*> imageRows( pngHeight );
+	//
+	// A GL_TEXTURE_2D_ARRAY holding textures of the same size and format, one per layer.
+	//
+	class TextureArray : public nocopy
+	{
+		// Approximate amount of GPU memory reserved per array (level 0), which decides the number of layers.
+		static constexpr glm::uint32 BytesPerArray = 16 * 1024 * 1024;
+		static constexpr glm::uint32 MaximumLayers = 256;
 
-			// Set the row pointers to the correct offsets in image data.
-			for (png_uint_32 i = 0; i < pngHeight; i++)
-				imageRows[pngHeight - 1 - i] = imageData.data() + i * bytesPerRow;
+		GLuint nameOfTexture;
+		GLenum format;
 
-			// Read the PNG.
-			png_read_image( libpng, imageRows.data() );
+		glm::uint32 width;
+		glm::uint32 height;
+		glm::uint32 levels;
 
-			dimensions = glm::vec2( pngWidth, pngHeight );
+		std::vector<bool> layers;
+		glm::uint32 countOfUsed;
+
+	public:
+
+		GLuint Name() const { return nameOfTexture; }
+		GLenum Format() const { return format; }
+		glm::uint32 Width() const { return width; }
+		glm::uint32 Height() const { return height; }
+		glm::uint32 Levels() const { return levels; }
+
+		bool Matches( GLenum f, glm::uint32 w, glm::uint32 h ) const
+		{
+			return format == f && width == w && height == h;
+		}
+
+		bool Full() const
+		{
+			return countOfUsed == layers.size();
+		}
+
+		bool Empty() const
+		{
+			return countOfUsed == 0;
+		}
+
+		bool Compressed() const
+		{
+			return format == gl::COMPRESSED_RED_RGTC1 || format == gl::COMPRESSED_RGBA_BPTC_UNORM;
+		}
+
+		TextureArray( GLenum format, glm::uint32 width, glm::uint32 height ) :
+			format( format ), width( width ), height( height ), levels( CountOfTextureLevels( width, height ) ), countOfUsed( 0 )
+		{
+			GLint maximumLayers;
+			gl::GetIntegerv( gl::MAX_ARRAY_TEXTURE_LAYERS, &maximumLayers );
+
+			auto bytesPerLayer = static_cast<glm::uint32>(TextureCompressor::SizeOfLevel( format, width, height ));
+			auto capacity = glm::clamp( BytesPerArray / glm::max( 1u, bytesPerLayer ), 1u, glm::min( MaximumLayers, static_cast<glm::uint32>(maximumLayers) ) );
 
-			// Generate the OpenGL texture.
-			gl::GenTextures( 1, &id );
-			gl::BindTexture( gl::TEXTURE_2D, id );
+			layers.resize( capacity, false );
 
-			if (onlyOpacity)
+			gl::GenTextures( 1, &nameOfTexture );
+			gl::BindTexture( gl::TEXTURE_2D_ARRAY, nameOfTexture );
+			gl::TexStorage3D( gl::TEXTURE_2D_ARRAY, levels, format, width, height, capacity );
+			gl::TexParameteri( gl::TEXTURE_2D_ARRAY, gl::TEXTURE_WRAP_S, gl::CLAMP_TO_EDGE );
+			gl::TexParameteri( gl::TEXTURE_2D_ARRAY, gl::TEXTURE_WRAP_T, gl::CLAMP_TO_EDGE );
+			gl::TexParameterf( gl::TEXTURE_2D_ARRAY, gl::TEXTURE_MIN_FILTER, gl::LINEAR_MIPMAP_LINEAR );
+			gl::TexParameterf( gl::TEXTURE_2D_ARRAY, gl::TEXTURE_MAG_FILTER, gl::LINEAR );
+		}
+
+		~TextureArray()
+		{
+			if (nameOfTexture != 0)
 			{
-				//
-				// Read only the alpha channel.
-				//
-				std::vector<png_byte> imageData2( imageData.size() / 2, 0 );
+				gl::DeleteTextures( 1, &nameOfTexture );
+				nameOfTexture = 0;
+			}
+		}
 
-				for (size_t i = 0, ii = 1; i < imageData2.size(); i++, ii += 2)
-					imageData2[i] = imageData[ii];
+		//
+		// Forget the texture without deleting it, once the GL context holding it is gone.
+		//
+		void Abandon()
+		{
+			nameOfTexture = 0;
+		}
 
-				format = gl::R8;
-				gl::TexStorage2D( gl::TEXTURE_2D, 4, format, pngWidth, pngHeight );
-				gl::TexSubImage2D( gl::TEXTURE_2D, 0, 0, 0, pngWidth, pngHeight, gl::RED, gl::UNSIGNED_BYTE, imageData2.data() );
+		//
+		// Reserve a free layer.
+		//
+		glm::uint32 Allocate()
+		{
+			auto layer = static_cast<glm::uint32>(std::find( layers.begin(), layers.end(), false ) - layers.begin());
+
+			if (layer == layers.size())
+				throw TextureException( "TextureArray is full." );
+
+			layers[layer] = true;
+			countOfUsed++;
+			return layer;
+		}
+
+		void Release( glm::uint32 layer )
+		{
+			if (layers[layer])
+			{
+				layers[layer] = false;
+				countOfUsed--;
 			}
-			else
+		}
+
+		//
+		// Upload a region of a level of a layer, rows bottom first, leaving the other levels as they are.
+		//
+		void Upload( glm::uint32 layer, glm::uint32 level, glm::uint32 x, glm::uint32 y, glm::uint32 regionWidth, glm::uint32 regionHeight, const void* pixels )
+		{
+			auto pixelFormat = format == gl::R8 ? gl::RED : gl::RGBA;
+
+			gl::BindTexture( gl::TEXTURE_2D_ARRAY, nameOfTexture );
+			gl::PixelStorei( gl::UNPACK_ALIGNMENT, 1 );
+			gl::TexSubImage3D( gl::TEXTURE_2D_ARRAY, level, x, y, layer, regionWidth, regionHeight, 1, pixelFormat, gl::UNSIGNED_BYTE, pixels );
+		}
+
+		//
+		// Upload a layer of the texture with all of its levels, one after the other, rows bottom first.
+		// Only the layer is written; glGenerateMipmap would rebuild the mipmaps of every layer of the array.
+		// When a pixel unpack buffer is bound, pixels is an offset into that buffer.
+		//
+		void Upload( glm::uint32 layer, const void* pixels, const std::vector<size_t>& sizeOfLevels )
+		{
+			auto pixelFormat = format == gl::R8 ? gl::RED : gl::RGBA;
+
+			gl::BindTexture( gl::TEXTURE_2D_ARRAY, nameOfTexture );
+			gl::PixelStorei( gl::UNPACK_ALIGNMENT, 1 );
+
+			const auto* level = static_cast<const glm::uint8*>(pixels);
+
+			for (glm::uint32 i = 0; i < levels && i < sizeOfLevels.size(); i++)
 			{
-				format = gl::RGBA8;
-				gl::TexStorage2D( gl::TEXTURE_2D, 4, format, pngWidth, pngHeight );
-				gl::TexSubImage2D( gl::TEXTURE_2D, 0, 0, 0, pngWidth, pngHeight, gl::RGBA, gl::UNSIGNED_BYTE, imageData.data() );
+				auto levelWidth = glm::max( 1u, width >> i );
+				auto levelHeight = glm::max( 1u, height >> i );
+
+				if (Compressed())
+					gl::CompressedTexSubImage3D( gl::TEXTURE_2D_ARRAY, i, 0, 0, layer, levelWidth, levelHeight, 1, format, static_cast<GLsizei>(sizeOfLevels[i]), level );
+				else
+					gl::TexSubImage3D( gl::TEXTURE_2D_ARRAY, i, 0, 0, layer, levelWidth, levelHeight, 1, pixelFormat, gl::UNSIGNED_BYTE, level );
+
+				level += sizeOfLevels[i];
+			}
+		}
+	};
+
+	//
+	// The set of texture arrays that textures are allocated from.
+	// Textures of the same size and format share arrays, so they can be drawn together; small textures share atlas pages,
+	// held by arrays of the atlases.
+	//
+	class TexturePool : public nocopy
+	{
+		std::vector<std::unique_ptr<TextureArray>> arrays;
+		std::vector<std::unique_ptr<ImageAtlas>> atlases;
+
+	public:
+
+		//
+		// The GL context is gone by the time a global pool is destroyed, so the textures are left to it; Release deletes them before.
+		//
+		~TexturePool()
+		{
+			for (auto& textureArray : arrays)
+				textureArray->Abandon();
+
+			for (auto& atlas : atlases)
+				atlas->Abandon();
+		}
+
+		//
+		// Delete the atlases and texture arrays, while the GL context is still current.
+		//
+		void Release()
+		{
+			atlases.clear();
+			arrays.clear();
+		}
+
+		//
+		// The atlas small textures of the specified format are packed into.
+		//
+		ImageAtlas& Atlas( GLenum format )
+		{
+			for (auto& atlas : atlases)
+			{
+				if (atlas->Format() == format)
+					return *atlas;
+			}
+
+			atlases.emplace_back( std::make_unique<ImageAtlas>( format ) );
+			return *atlases.back();
+		}
+
+		//
+		// GPU memory of the pages of the atlases.
+		//
+		size_t AtlasSize() const
+		{
+			size_t size = 0;
+
+			for (const auto& atlas : atlases)
+				size += atlas->Size();
+
+			return size;
+		}
+
+		//
+		// Reserve a layer for a texture of the specified format and size.
+		//
+		TextureArray& Allocate( GLenum format, glm::uint32 width, glm::uint32 height, glm::uint32& layer )
+		{
+			for (auto& textureArray : arrays)
+			{
+				if (textureArray->Matches( format, width, height ) && !textureArray->Full())
+				{
+					layer = textureArray->Allocate();
+					return *textureArray;
+				}
 			}
 
-			gl::GenerateMipmap( gl::TEXTURE_2D );
-			gl::TexParameterf( gl::TEXTURE_2D, gl::TEXTURE_MIN_FILTER, gl::LINEAR_MIPMAP_LINEAR );
-			gl::TexParameterf( gl::TEXTURE_2D, gl::TEXTURE_MAG_FILTER, gl::LINEAR );
+			arrays.emplace_back( std::make_unique<TextureArray>( format, width, height ) );
+			layer = arrays.back()->Allocate();
+			return *arrays.back();
 		}
+
+		//
+		// Delete the texture arrays without any layer in use.
+		//
+		void Trim()
+		{
+			arrays.erase( std::remove_if( arrays.begin(), arrays.end(), []( const std::unique_ptr<TextureArray>& textureArray ) { return textureArray->Empty(); } ), arrays.end() );
+
+			for (auto& atlas : atlases)
+				atlas->Trim();
+		}
+	};
+
+	enum class TextureState
+	{
+		Pending,
+		Ready,
+		Failed,
+		// Released to stay within the memory budget; reloaded from its file when next drawn.
+		Evicted
 	};
 
-	class Texture
+	class Texture : public nocopy
 	{
-		
-		glm::uint32 ifOfTexture;
+		friend class TextureManager;
+
+		TextureArray* textureArray;
+		glm::uint32 layer;
 		glm::uint32 format;
 
+		// The atlas the texture is packed into, if any, and its region of the layer.
+		ImageAtlas* atlas;
+		glm::vec4 region;
+		// Cells of the atlas page the texture is packed into.
+		Region cells;
+
 		glm::vec2 dimensions;
 
+		TextureState state;
+
+		// Source of the texture, to reload it from: its file, or a copy of the image it was created from in memory.
+		std::string filename;
+		std::shared_ptr<const std::vector<glm::uint8>> encoded;
+		bool onlyOpacity;
+
+		// Whether the texture was drawn since the last frame ended, and the last frame it was drawn in.
+		mutable bool used;
+		glm::uint64 lastUsedFrame;
+
+		void Release()
+		{
+			if (atlas != nullptr)
+				atlas->Release( *textureArray, layer, cells );
+			else
+				textureArray->Release( layer );
+
+			textureArray = nullptr;
+			atlas = nullptr;
+		}
+
 	public:
 
+		TextureState State() const
+		{
+			return state;
+		}
+
+		bool Ready() const
+		{
+			return state == TextureState::Ready;
+		}
+
+		//
+		// GL identity of the texture array holding the texture, 0 while it isn't ready.
 		glm::uint32 Name() const
 		{
-			return ifOfTexture;
+			return textureArray != nullptr ? textureArray->Name() : 0;
 		}
 
-		Texture( const std::string& filename, bool onlyOpacity )
+		//
+		// Layer of the texture within its texture array.
+		glm::uint32 Layer() const
+		{
+			return layer;
+		}
+
+		//
+		// Region of the layer occupied by the texture as (left, top, right, bottom) texture coordinates.
+		// Rows are stored bottom first, so the top of the image is at t = 1.
+		glm::vec4 Region() const
+		{
+			return region;
+		}
+
+		const glm::vec2& Dimensions() const
+		{
+			return dimensions;
+		}
+
+		//
+		// GPU memory used by the layer of the texture, including its mipmaps; 0 when it isn't resident.
+		// Textures in an atlas are charged with its pages, see ImageAtlas::Size, so they count 0.
+		//
+		size_t Size() const
+		{
+			if (textureArray == nullptr || atlas != nullptr)
+				return 0;
+
+			size_t size = 0;
+
+			for (glm::uint32 i = 0; i < textureArray->Levels(); i++)
+				size += TextureCompressor::SizeOfLevel( format, glm::max( 1u, textureArray->Width() >> i ), glm::max( 1u, textureArray->Height() >> i ) );
+
+			return size;
+		}
+
+		//
+		// Record that the texture is drawn in the current frame.
+		//
+		void Touch() const
+		{
+			used = true;
+		}
+
+		Texture( TexturePool& pool, const std::string& filename, bool onlyOpacity, const TextureCompressor* compressor = nullptr ) : Texture( filename, onlyOpacity )
+		{
+			Upload( pool, TextureLoader( filename, onlyOpacity, compressor ) );
+		}
+
+		Texture( TexturePool& pool, const void* data, size_t size, bool onlyOpacity, const TextureCompressor* compressor = nullptr ) : Texture( std::string(), onlyOpacity )
+		{
+			Upload( pool, TextureLoader( data, size, onlyOpacity, compressor ) );
+
+			// Decoded once more if evicted; the caller's image needn't outlive the texture.
+			const auto* bytes = static_cast<const glm::uint8*>(data);
+			encoded = std::make_shared<const std::vector<glm::uint8>>( bytes, bytes + size );
+		}
+
+		//
+		// Create a pending texture, to be completed once its pixels are decoded and uploaded (see TextureQueue).
+		//
+		Texture( const std::string& filename, bool onlyOpacity ) :
+			textureArray( nullptr ), layer( 0 ), format( 0 ), atlas( nullptr ), region( 0.0f, 1.0f, 1.0f, 0.0f ), dimensions( 0.0f ), state( TextureState::Pending ),
+			filename( filename ), onlyOpacity( onlyOpacity ), used( false ), lastUsedFrame( 0 )
 		{
-			TextureLoader loader( filename, onlyOpacity );
-			ifOfTexture = loader.id;
-			format = loader.format;
-			dimensions = loader.dimensions;
 		}
 
 		~Texture()
 		{
-			if (ifOfTexture != 0)
+			if (textureArray != nullptr)
+				Release();
+		}
+
+		//
+		// Upload the decoded pixels and mark the texture as ready. Small uncompressed textures are packed into the pool's atlas.
+		//
+		void Upload( TexturePool& pool, const TextureLoader& loader )
+		{
+			format = loader.format;
+			dimensions = loader.dimensions;
+
+			auto width = static_cast<glm::uint32>(dimensions.x);
+			auto height = static_cast<glm::uint32>(dimensions.y);
+
+			if (loader.sizeOfLevels.empty() && ImageAtlas::Packable( format, width, height ))
 			{
-				gl::DeleteTextures( 1, &ifOfTexture );
-				ifOfTexture = 0;
+				atlas = &pool.Atlas( format );
+				textureArray = &atlas->Add( loader.pixels.data(), width, height, layer, region, cells );
 			}
+			else
+			{
+				textureArray = &pool.Allocate( format, width, height, layer );
+				textureArray->Upload( layer, loader.pixels.data(), loader.sizeOfLevels );
+				region = glm::vec4( 0.0f, 1.0f, 1.0f, 0.0f );
+			}
+
+			state = TextureState::Ready;
+		}
+
+		//
+		// Mark a pending texture as ready, now that its pixels are in the layer of the texture array.
+		//
+		void Complete( TextureArray& completedArray, glm::uint32 completedLayer, const glm::vec2& completedDimensions )
+		{
+			textureArray = &completedArray;
+			layer = completedLayer;
+			format = completedArray.Format();
+			region = glm::vec4( 0.0f, 1.0f, 1.0f, 0.0f );
+			dimensions = completedDimensions;
+			state = TextureState::Ready;
+		}
+
+		void Fail()
+		{
+			state = TextureState::Failed;
+		}
+
+		//
+		// Release the layer of a ready texture, keeping what's needed to reload it.
+		//
+		bool Evict()
+		{
+			if (state != TextureState::Ready || (filename.empty() && !encoded))
+				return false;
+
+			Release();
+			state = TextureState::Evicted;
+			return true;
 		}
 
 		void Bind( glm::uint8 textureUnit ) const
 		{
 			gl::ActiveTexture( gl::TEXTURE0 + textureUnit );
-			gl::BindTexture( gl::TEXTURE_2D, ifOfTexture );
+			gl::BindTexture( gl::TEXTURE_2D_ARRAY, Name() );
 		}
 	};
 }
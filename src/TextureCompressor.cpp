@@ -0,0 +1,447 @@
+#include "TextureCompressor.hpp"
+
+#include "MappedFile.hpp"
+#include "Pixels.hpp"
+
+#include <thread>
+
+namespace kodogl
+{
+	static constexpr glm::uint32 CacheMagic = 0x5854474B; // "KGTX"
+
+	//
+	// Writes a 128-bit block, least significant bit first.
+	//
+	struct BlockWriter
+	{
+		glm::uint64 Bits[2] = { 0, 0 };
+		glm::uint32 Position = 0;
+
+		void Put( glm::uint32 value, glm::uint32 count )
+		{
+			for (glm::uint32 i = 0; i < count; i++, Position++)
+				Bits[Position >> 6] |= static_cast<glm::uint64>((value >> i) & 1) << (Position & 63);
+		}
+	};
+
+	//
+	// Gather a 4x4 block of pixels, replicating the last row and column past the edges of the image.
+	//
+	static void FetchBlock( const glm::uint8* pixels, glm::uint32 width, glm::uint32 height, glm::uint32 bytesPerPixel, glm::uint32 blockX, glm::uint32 blockY, glm::uint8* block )
+	{
+		for (glm::uint32 y = 0; y < 4; y++)
+		{
+			auto row = glm::min( blockY * 4 + y, height - 1 );
+
+			for (glm::uint32 x = 0; x < 4; x++)
+			{
+				auto column = glm::min( blockX * 4 + x, width - 1 );
+				memcpy( block + (y * 4 + x) * bytesPerPixel, pixels + (row * width + column) * bytesPerPixel, bytesPerPixel );
+			}
+		}
+	}
+
+	//
+	// BC4: two 8-bit endpoints and 3-bit indices into the 8 values between them.
+	//
+	static void EncodeBC4( const glm::uint8* values, glm::uint8* output )
+	{
+		auto lo = values[0];
+		auto hi = values[0];
+
+		for (auto i = 1; i < 16; i++)
+		{
+			lo = glm::min( lo, values[i] );
+			hi = glm::max( hi, values[i] );
+		}
+
+		// hi > lo selects the mode with six interpolated values; codes 0 and 1 are the endpoints.
+		output[0] = hi;
+		output[1] = lo;
+
+		glm::uint64 indices = 0;
+
+		if (hi > lo)
+		{
+			glm::uint32 range = hi - lo;
+
+			for (auto i = 0; i < 16; i++)
+			{
+				auto step = ((hi - values[i]) * 7 + range / 2) / range;
+				glm::uint64 code = step == 0 ? 0 : step == 7 ? 1 : step + 1;
+				indices |= code << (i * 3);
+			}
+		}
+
+		for (auto i = 0; i < 6; i++)
+			output[2 + i] = static_cast<glm::uint8>(indices >> (i * 8));
+	}
+
+	//
+	// BC7 mode 6: one subset, RGBA endpoints of 7 bits plus a shared low bit each, and 4-bit indices.
+	// The endpoints are fitted along the principal axis of the block's colors.
+	//
+	static void EncodeBC7( const glm::uint8* pixels, glm::uint8* output )
+	{
+		static const glm::uint32 weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+		glm::vec4 colors[16];
+		glm::vec4 mean( 0.0f );
+
+		for (auto i = 0; i < 16; i++)
+		{
+			colors[i] = glm::vec4( pixels[i * 4], pixels[i * 4 + 1], pixels[i * 4 + 2], pixels[i * 4 + 3] );
+			mean += colors[i];
+		}
+
+		mean /= 16.0f;
+
+		glm::mat4 covariance( 0.0f );
+
+		for (const auto& color : colors)
+		{
+			auto d = color - mean;
+			covariance += glm::outerProduct( d, d );
+		}
+
+		// Power iteration for the principal axis.
+		glm::vec4 axis( 1.0f, 1.0f, 1.0f, 1.0f );
+
+		for (auto i = 0; i < 8; i++)
+		{
+			axis = covariance * axis;
+
+			auto length = glm::length( axis );
+			if (length < 1e-6f)
+				break;
+
+			axis /= length;
+		}
+
+		auto tMin = 0.0f;
+		auto tMax = 0.0f;
+
+		if (glm::length( axis ) > 0.5f)
+		{
+			for (const auto& color : colors)
+			{
+				auto t = glm::dot( color - mean, axis );
+				tMin = glm::min( tMin, t );
+				tMax = glm::max( tMax, t );
+			}
+		}
+
+		glm::vec4 endpoints[2] = {
+			glm::clamp( mean + axis * tMin, 0.0f, 255.0f ),
+			glm::clamp( mean + axis * tMax, 0.0f, 255.0f )
+		};
+
+		//
+		// Quantize each endpoint to 7 bits per channel, choosing the shared low bit with the smaller error.
+		//
+		glm::uvec4 quantized[2];
+		glm::uint32 lowBits[2];
+		glm::vec4 reconstructed[2];
+
+		for (auto e = 0; e < 2; e++)
+		{
+			auto bestError = FLT_MAX;
+
+			for (glm::uint32 p = 0; p < 2; p++)
+			{
+				auto q = glm::uvec4( glm::clamp( glm::round( (endpoints[e] - static_cast<glm::float32>(p)) / 2.0f ), 0.0f, 127.0f ) );
+				auto r = glm::vec4( q * 2u + p );
+				auto d = r - endpoints[e];
+				auto error = glm::dot( d, d );
+
+				if (error < bestError)
+				{
+					bestError = error;
+					quantized[e] = q;
+					lowBits[e] = p;
+					reconstructed[e] = r;
+				}
+			}
+		}
+
+		glm::vec4 palette[16];
+
+		for (auto i = 0; i < 16; i++)
+			palette[i] = glm::floor( (reconstructed[0] * static_cast<glm::float32>(64 - weights[i]) + reconstructed[1] * static_cast<glm::float32>(weights[i]) + 32.0f) / 64.0f );
+
+		glm::uint32 indices[16];
+
+		for (auto i = 0; i < 16; i++)
+		{
+			auto bestError = FLT_MAX;
+
+			for (glm::uint32 j = 0; j < 16; j++)
+			{
+				auto d = palette[j] - colors[i];
+				auto error = glm::dot( d, d );
+
+				if (error < bestError)
+				{
+					bestError = error;
+					indices[i] = j;
+				}
+			}
+		}
+
+		// The first index is stored with 3 bits, so its high bit must be clear; swap the endpoints otherwise.
+		if (indices[0] >= 8)
+		{
+			std::swap( quantized[0], quantized[1] );
+			std::swap( lowBits[0], lowBits[1] );
+
+			for (auto& index : indices)
+				index = 15 - index;
+		}
+
+		BlockWriter writer;
+		writer.Put( 1 << 6, 7 );
+
+		for (auto c = 0; c < 4; c++)
+		{
+			writer.Put( quantized[0][c], 7 );
+			writer.Put( quantized[1][c], 7 );
+		}
+
+		writer.Put( lowBits[0], 1 );
+		writer.Put( lowBits[1], 1 );
+		writer.Put( indices[0], 3 );
+
+		for (auto i = 1; i < 16; i++)
+			writer.Put( indices[i], 4 );
+
+		memcpy( output, writer.Bits, 16 );
+	}
+
+	//
+	// Encode the block rows [rowFrom, rowTo) of a level.
+	//
+	static void EncodeRows( GLenum format, const glm::uint8* pixels, glm::uint32 width, glm::uint32 height, glm::uint32 rowFrom, glm::uint32 rowTo, glm::uint8* output )
+	{
+		auto isMask = format == gl::COMPRESSED_RED_RGTC1;
+		auto bytesPerPixel = isMask ? 1u : 4u;
+		auto bytesPerBlock = isMask ? 8u : 16u;
+		auto blocksPerRow = (width + 3) / 4;
+
+		glm::uint8 block[16 * 4];
+
+		for (auto blockY = rowFrom; blockY < rowTo; blockY++)
+		{
+			for (glm::uint32 blockX = 0; blockX < blocksPerRow; blockX++)
+			{
+				FetchBlock( pixels, width, height, bytesPerPixel, blockX, blockY, block );
+
+				auto* blockOutput = output + (blockY * blocksPerRow + blockX) * bytesPerBlock;
+
+				if (isMask)
+					EncodeBC4( block, blockOutput );
+				else
+					EncodeBC7( block, blockOutput );
+			}
+		}
+	}
+
+	TextureCompressor::TextureCompressor(const std::string& cacheDirectory) :
+		cacheDirectory(cacheDirectory)
+	{
+	}
+
+	GLenum TextureCompressor::CompressedFormat(GLenum format)
+	{
+		return format == gl::R8 ? gl::COMPRESSED_RED_RGTC1 : gl::COMPRESSED_RGBA_BPTC_UNORM;
+	}
+
+	size_t TextureCompressor::SizeOfLevel(GLenum format, glm::uint32 width, glm::uint32 height)
+	{
+		auto blocks = static_cast<size_t>((width + 3) / 4) * ((height + 3) / 4);
+
+		switch (format)
+		{
+			case gl::R8:
+				return static_cast<size_t>(width) * height;
+			case gl::COMPRESSED_RED_RGTC1:
+				return blocks * 8;
+			case gl::COMPRESSED_RGBA_BPTC_UNORM:
+				return blocks * 16;
+			default:
+				return static_cast<size_t>(width) * height * 4;
+		}
+	}
+
+	glm::uint64 TextureCompressor::Key(const void* data, size_t size, bool onlyOpacity)
+	{
+		// 64-bit FNV-1a.
+		glm::uint64 hash = 0xCBF29CE484222325ull;
+
+		auto mix = [&hash](glm::uint8 byte)
+		{
+			hash ^= byte;
+			hash *= 0x100000001B3ull;
+		};
+
+		const auto* bytes = static_cast<const glm::uint8*>(data);
+
+		for (size_t i = 0; i < size; i++)
+			mix(bytes[i]);
+
+		mix(onlyOpacity ? 1 : 0);
+		mix(static_cast<glm::uint8>(Version));
+
+		return hash;
+	}
+
+	std::string TextureCompressor::CachePath(glm::uint64 key) const
+	{
+		char name[32];
+		snprintf(name, sizeof(name), "%016llx.kgltex", static_cast<unsigned long long>(key));
+
+		return cacheDirectory + "\\" + name;
+	}
+
+	bool TextureCompressor::Find(glm::uint64 key, GLenum& format, glm::vec2& dimensions, std::vector<glm::uint8>& pixels, std::vector<size_t>& sizeOfLevels) const
+	{
+		if (cacheDirectory.empty())
+			return false;
+
+		MappedFile file(CachePath(key));
+
+		//
+		// Header: magic, version, format, width, height, number of levels, then the size of each level.
+		//
+		const size_t sizeOfHeader = 6 * sizeof(glm::uint32);
+
+		if (!file.IsOpen() || file.Size() < sizeOfHeader)
+			return false;
+
+		glm::uint32 header[6];
+		memcpy(header, file.Data(), sizeOfHeader);
+
+		if (header[0] != CacheMagic || header[1] != Version)
+			return false;
+
+		auto countOfLevels = header[5];
+		auto offset = sizeOfHeader + countOfLevels * sizeof(glm::uint64);
+
+		if (file.Size() < offset)
+			return false;
+
+		std::vector<size_t> sizes(countOfLevels);
+		size_t total = 0;
+
+		for (glm::uint32 i = 0; i < countOfLevels; i++)
+		{
+			glm::uint64 size;
+			memcpy(&size, file.Data() + sizeOfHeader + i * sizeof(glm::uint64), sizeof(size));
+
+			sizes[i] = static_cast<size_t>(size);
+			total += sizes[i];
+		}
+
+		if (file.Size() != offset + total)
+			return false;
+
+		format = header[2];
+		dimensions = glm::vec2(header[3], header[4]);
+		pixels.assign(file.Data() + offset, file.Data() + offset + total);
+		sizeOfLevels = std::move(sizes);
+		return true;
+	}
+
+	void TextureCompressor::Compress(glm::uint64 key, GLenum& format, const glm::vec2& dimensions, glm::uint32 levels, std::vector<glm::uint8>& pixels, std::vector<size_t>& sizeOfLevels) const
+	{
+		auto bytesPerPixel = format == gl::R8 ? 1u : 4u;
+		auto compressedFormat = CompressedFormat(format);
+
+		auto width = static_cast<glm::uint32>(dimensions.x);
+		auto height = static_cast<glm::uint32>(dimensions.y);
+
+		std::vector<glm::uint8> level = std::move(pixels);
+		std::vector<glm::uint8> nextLevel;
+		std::vector<glm::uint8> compressed;
+
+		sizeOfLevels.clear();
+
+		for (glm::uint32 l = 0; l < levels; l++)
+		{
+			if (l > 0)
+			{
+				Downsample(level, width, height, bytesPerPixel, nextLevel);
+				level.swap(nextLevel);
+
+				width = glm::max(1u, width / 2);
+				height = glm::max(1u, height / 2);
+			}
+
+			auto size = SizeOfLevel(compressedFormat, width, height);
+			auto offset = compressed.size();
+			compressed.resize(offset + size);
+
+			auto rows = (height + 3) / 4;
+			auto blocks = static_cast<size_t>((width + 3) / 4) * rows;
+			auto* output = compressed.data() + offset;
+
+			if (blocks < ParallelThreshold)
+			{
+				EncodeRows(compressedFormat, level.data(), width, height, 0, rows, output);
+			}
+			else
+			{
+				auto threadCount = glm::max(1u, glm::min(std::thread::hardware_concurrency(), rows));
+				auto rowsPerThread = (rows + threadCount - 1) / threadCount;
+
+				std::vector<std::thread> threads;
+
+				for (glm::uint32 t = 1; t < threadCount; t++)
+				{
+					auto rowFrom = glm::min(rows, t * rowsPerThread);
+					auto rowTo = glm::min(rows, rowFrom + rowsPerThread);
+
+					threads.emplace_back(EncodeRows, compressedFormat, level.data(), width, height, rowFrom, rowTo, output);
+				}
+
+				EncodeRows(compressedFormat, level.data(), width, height, 0, glm::min(rows, rowsPerThread), output);
+
+				for (auto& thread : threads)
+					thread.join();
+			}
+
+			sizeOfLevels.push_back(size);
+		}
+
+		format = compressedFormat;
+		pixels = std::move(compressed);
+
+		if (cacheDirectory.empty())
+			return;
+
+		//
+		// Write to a file of this thread's own, then move it in place, so concurrent loads of the same image don't collide.
+		//
+		auto path = CachePath(key);
+		auto temporaryPath = path + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()));
+
+		FILE* fp = nullptr;
+		fopen_s(&fp, temporaryPath.c_str(), "wb");
+		if (fp == nullptr)
+			return;
+
+		glm::uint32 header[6] = { CacheMagic, Version, format, static_cast<glm::uint32>(dimensions.x), static_cast<glm::uint32>(dimensions.y), static_cast<glm::uint32>(sizeOfLevels.size()) };
+		auto written = fwrite(header, sizeof(header), 1, fp) == 1;
+
+		for (auto size : sizeOfLevels)
+		{
+			glm::uint64 size64 = size;
+			written = written && fwrite(&size64, sizeof(size64), 1, fp) == 1;
+		}
+
+		written = written && fwrite(pixels.data(), 1, pixels.size(), fp) == pixels.size();
+		fclose(fp);
+
+		if (!written || std::rename(temporaryPath.c_str(), path.c_str()) != 0)
+			std::remove(temporaryPath.c_str());
+	}
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "kodo-gl.hpp"
+
+namespace kodogl
+{
+	//
+	// Block compresses textures on the CPU: opacity masks to BC4 (RGTC1), colors to BC7 (BPTC).
+	// The results are cached on disk, keyed by the hash of the encoded image, so later runs skip decoding and encoding.
+	//
+	class TextureCompressor : public nocopy
+	{
+		// Bump when the encoders or the cache file layout change.
+		static constexpr glm::uint32 Version = 1;
+		// Number of blocks above which encoding is spread across threads.
+		static constexpr size_t ParallelThreshold = 4096;
+
+		std::string cacheDirectory;
+
+		std::string CachePath( glm::uint64 key ) const;
+
+	public:
+
+		explicit TextureCompressor( const std::string& cacheDirectory );
+
+		//
+		// The block compressed format used for an uncompressed format (R8 or RGBA8).
+		//
+		static GLenum CompressedFormat( GLenum format );
+
+		//
+		// Size of a level in bytes, in any format textures are stored in.
+		//
+		static size_t SizeOfLevel( GLenum format, glm::uint32 width, glm::uint32 height );
+
+		//
+		// The cache key of an encoded image.
+		//
+		static glm::uint64 Key( const void* data, size_t size, bool onlyOpacity );
+
+		//
+		// Look up the compressed levels of an image. The levels are stored one after the other in pixels.
+		//
+		bool Find( glm::uint64 key, GLenum& format, glm::vec2& dimensions, std::vector<glm::uint8>& pixels, std::vector<size_t>& sizeOfLevels ) const;
+
+		//
+		// Compress level 0 of an image (bottom row first, tightly packed) and the mipmap levels below it, and cache the result.
+		// On return, format and pixels hold the compressed levels.
+		//
+		void Compress( glm::uint64 key, GLenum& format, const glm::vec2& dimensions, glm::uint32 levels, std::vector<glm::uint8>& pixels, std::vector<size_t>& sizeOfLevels ) const;
+	};
+}
@@ -0,0 +1,135 @@
+#include "TextureManager.hpp"
+
+namespace kodogl
+{
+	TextureManager::TextureManager() :
+		budget(0),
+		residentSize(0),
+		frame(0)
+	{
+	}
+
+	Texture* TextureManager::Add(std::unique_ptr<Texture> texture)
+	{
+		texture->lastUsedFrame = frame;
+		textures.emplace_back(std::move(texture));
+		return textures.back().get();
+	}
+
+	Texture* TextureManager::Create(const std::string& filename, bool onlyOpacity)
+	{
+		return Add(std::make_unique<Texture>(pool, filename, onlyOpacity, compressor.get()));
+	}
+
+	Texture* TextureManager::Create(const void* data, size_t size, bool onlyOpacity)
+	{
+		return Add(std::make_unique<Texture>(pool, data, size, onlyOpacity, compressor.get()));
+	}
+
+	Texture* TextureManager::CreateAsync(const std::string& filename, bool onlyOpacity)
+	{
+		auto* texture = Add(std::make_unique<Texture>(filename, onlyOpacity));
+		queue.Enqueue(texture, filename, onlyOpacity, compressor);
+		return texture;
+	}
+
+	void TextureManager::Destroy(Texture* texture)
+	{
+		auto it = std::find_if(textures.begin(), textures.end(), [texture](const std::unique_ptr<Texture>& t) { return t.get() == texture; });
+
+		if (it == textures.end())
+			return;
+
+		//
+		// The queue still refers to pending textures, and commands recorded in this frame may refer to the layers of others,
+		// which mustn't be given to new textures before the frame is drawn.
+		//
+		if (texture->State() == TextureState::Pending)
+			destroyed.emplace_back(std::move(*it));
+		else
+			retired.emplace_back(std::move(*it));
+
+		textures.erase(it);
+	}
+
+	void TextureManager::BeginFrame()
+	{
+		queue.Process(pool);
+
+		destroyed.erase(std::remove_if(destroyed.begin(), destroyed.end(), [](const std::unique_ptr<Texture>& t) { return t->State() != TextureState::Pending; }), destroyed.end());
+	}
+
+	void TextureManager::EndFrame()
+	{
+		retired.clear();
+
+		frame++;
+		// Atlas pages are charged whole, whichever of their textures are resident.
+		residentSize = pool.AtlasSize();
+
+		for (auto& texture : textures)
+		{
+			if (texture->used)
+			{
+				texture->used = false;
+				texture->lastUsedFrame = frame;
+
+				if (texture->State() == TextureState::Evicted)
+				{
+					texture->state = TextureState::Pending;
+
+					if (texture->encoded)
+						queue.Enqueue(texture.get(), texture->encoded, texture->onlyOpacity, compressor);
+					else
+						queue.Enqueue(texture.get(), texture->filename, texture->onlyOpacity, compressor);
+				}
+			}
+
+			residentSize += texture->Size();
+		}
+
+		if (budget != 0 && residentSize > budget)
+			Evict();
+
+		pool.Trim();
+	}
+
+	void TextureManager::Evict()
+	{
+		//
+		// Evict the least recently drawn textures, never those drawn in this frame; it's drawn already, so their layers can go.
+		//
+		std::vector<Texture*> candidates;
+
+		for (auto& texture : textures)
+		{
+			if (texture->Ready() && texture->lastUsedFrame < frame)
+				candidates.push_back(texture.get());
+		}
+
+		std::sort(candidates.begin(), candidates.end(), [](const Texture* a, const Texture* b) { return a->lastUsedFrame < b->lastUsedFrame; });
+
+		for (auto* texture : candidates)
+		{
+			if (residentSize <= budget)
+				break;
+
+			// Evicting a texture of an atlas frees memory only once its page is released.
+			auto size = texture->Size() + pool.AtlasSize();
+
+			if (texture->Evict())
+				residentSize -= size - pool.AtlasSize();
+		}
+	}
+
+	void TextureManager::Stop()
+	{
+		queue.Stop();
+
+		// The textures refer to the arrays of the pool.
+		destroyed.clear();
+		retired.clear();
+		textures.clear();
+		pool.Release();
+	}
+}
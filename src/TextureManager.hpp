@@ -0,0 +1,81 @@
+#pragma once
+
+#include "kodo-gl.hpp"
+#include "Texture.h"
+#include "TextureQueue.hpp"
+
+namespace kodogl
+{
+	//
+	// Owns the textures and keeps the GPU memory they use within a budget.
+	// Textures not drawn recently are evicted, least recently drawn first, and reloaded in the background when drawn again,
+	// from their file or from the copy of the image they were created from in memory.
+	//
+	class TextureManager : public nocopy
+	{
+		TexturePool pool;
+		TextureQueue queue;
+		std::shared_ptr<const TextureCompressor> compressor;
+
+		std::vector<std::unique_ptr<Texture>> textures;
+		// Destroyed textures still being loaded by the queue, deleted once it's done with them.
+		std::vector<std::unique_ptr<Texture>> destroyed;
+		// Destroyed textures commands of the current frame may still draw, deleted once the frame is drawn.
+		std::vector<std::unique_ptr<Texture>> retired;
+
+		// GPU memory budget in bytes, 0 for no limit.
+		size_t budget;
+		size_t residentSize;
+		glm::uint64 frame;
+
+		Texture* Add( std::unique_ptr<Texture> texture );
+		void Evict();
+
+	public:
+
+		TextureManager();
+
+		Texture* Create( const std::string& filename, bool onlyOpacity );
+		Texture* Create( const void* data, size_t size, bool onlyOpacity );
+		Texture* CreateAsync( const std::string& filename, bool onlyOpacity );
+
+		void Destroy( Texture* texture );
+
+		//
+		// Block compress the textures loaded from now on, see TextureCompressor. Null turns compression off.
+		//
+		void Compression( std::shared_ptr<const TextureCompressor> textureCompressor )
+		{
+			compressor = std::move( textureCompressor );
+		}
+
+		void Budget( size_t bytes )
+		{
+			budget = bytes;
+		}
+
+		//
+		// GPU memory used by the resident textures and the atlas pages they're packed into, as of the end of the last frame.
+		//
+		size_t ResidentSize() const
+		{
+			return residentSize;
+		}
+
+		//
+		// Upload the textures loaded in the background. Must be called with the GL context current.
+		//
+		void BeginFrame();
+
+		//
+		// Delete the textures destroyed during the frame, reload the evicted textures drawn in it, and evict textures until
+		// the budget is met. Must be called once the commands of the frame are drawn.
+		//
+		void EndFrame();
+
+		//
+		// Stop loading textures and delete them, while the GL context is still current. Textures must not be used afterwards.
+		//
+		void Stop();
+	};
+}
@@ -0,0 +1,210 @@
+#include "TextureQueue.hpp"
+
+namespace kodogl
+{
+	TextureQueue::TextureQueue() :
+		stopping(false),
+		unpackBuffers(),
+		nextUnpackBuffer(0)
+	{
+	}
+
+	TextureQueue::~TextureQueue()
+	{
+		Stop();
+	}
+
+	void TextureQueue::Enqueue(Texture* texture, const std::string& filename, bool onlyOpacity, std::shared_ptr<const TextureCompressor> compressor)
+	{
+		Enqueue(Request{ texture, filename, nullptr, onlyOpacity, std::move(compressor) });
+	}
+
+	void TextureQueue::Enqueue(Texture* texture, std::shared_ptr<const std::vector<glm::uint8>> encoded, bool onlyOpacity, std::shared_ptr<const TextureCompressor> compressor)
+	{
+		Enqueue(Request{ texture, std::string(), std::move(encoded), onlyOpacity, std::move(compressor) });
+	}
+
+	void TextureQueue::Enqueue(Request request)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+
+			if (workers.empty())
+			{
+				// Leave a core to the GL thread.
+				auto countOfWorkers = glm::max(1u, std::thread::hardware_concurrency() - 1);
+
+				stopping = false;
+
+				for (glm::uint32 i = 0; i < countOfWorkers; i++)
+					workers.emplace_back(&TextureQueue::Work, this);
+			}
+
+			requests.emplace_back(std::move(request));
+		}
+
+		requested.notify_one();
+	}
+
+	void TextureQueue::Work()
+	{
+		for (;;)
+		{
+			Request request;
+
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				requested.wait(lock, [this] { return stopping || !requests.empty(); });
+
+				if (stopping)
+					return;
+
+				request = std::move(requests.front());
+				requests.pop_front();
+			}
+
+			std::unique_ptr<TextureLoader> loader;
+
+			try
+			{
+				if (request.Encoded)
+					loader = std::make_unique<TextureLoader>(request.Encoded->data(), request.Encoded->size(), request.OnlyOpacity, request.Compressor.get());
+				else
+					loader = std::make_unique<TextureLoader>(request.Filename, request.OnlyOpacity, request.Compressor.get());
+			}
+			catch (const std::exception&)
+			{
+				// Decoding failed or ran out of memory; leave the loader empty, Process marks the texture as failed.
+			}
+
+			std::lock_guard<std::mutex> lock(mutex);
+			decoded.emplace_back(Decoded{ request.Texture, std::move(loader) });
+		}
+	}
+
+	bool TextureQueue::Upload(TexturePool& pool, Decoded& texture)
+	{
+		const auto& loader = *texture.Loader;
+		auto size = loader.pixels.size();
+
+		//
+		// Small textures go into an atlas page, uploaded directly.
+		//
+		if (loader.sizeOfLevels.empty() && ImageAtlas::Packable(loader.format, static_cast<glm::uint32>(loader.dimensions.x), static_cast<glm::uint32>(loader.dimensions.y)))
+		{
+			texture.Texture->Upload(pool, loader);
+			return true;
+		}
+
+		UnpackBuffer* unpackBuffer = nullptr;
+
+		if (size <= BytesPerBuffer)
+		{
+			unpackBuffer = &unpackBuffers[nextUnpackBuffer];
+
+			if (unpackBuffer->Name == 0)
+			{
+				const GLbitfield flags = gl::MAP_WRITE_BIT | gl::MAP_PERSISTENT_BIT | gl::MAP_COHERENT_BIT;
+
+				gl::GenBuffers(1, &unpackBuffer->Name);
+				gl::BindBuffer(gl::PIXEL_UNPACK_BUFFER, unpackBuffer->Name);
+				gl::BufferStorage(gl::PIXEL_UNPACK_BUFFER, BytesPerBuffer, nullptr, flags);
+				unpackBuffer->Mapped = static_cast<glm::uint8*>(gl::MapBufferRange(gl::PIXEL_UNPACK_BUFFER, 0, BytesPerBuffer, flags));
+				gl::BindBuffer(gl::PIXEL_UNPACK_BUFFER, 0);
+			}
+
+			//
+			// The buffer is still being read by an earlier upload; try again next frame.
+			//
+			if (unpackBuffer->Fence != nullptr)
+			{
+				if (gl::ClientWaitSync(unpackBuffer->Fence, 0, 0) == gl::TIMEOUT_EXPIRED)
+					return false;
+
+				gl::DeleteSync(unpackBuffer->Fence);
+				unpackBuffer->Fence = nullptr;
+			}
+		}
+
+		glm::uint32 layer;
+		auto& textureArray = pool.Allocate(loader.format, static_cast<glm::uint32>(loader.dimensions.x), static_cast<glm::uint32>(loader.dimensions.y), layer);
+
+		if (unpackBuffer != nullptr)
+		{
+			memcpy(unpackBuffer->Mapped, loader.pixels.data(), size);
+
+			gl::BindBuffer(gl::PIXEL_UNPACK_BUFFER, unpackBuffer->Name);
+			textureArray.Upload(layer, nullptr, loader.sizeOfLevels);
+			gl::BindBuffer(gl::PIXEL_UNPACK_BUFFER, 0);
+
+			unpackBuffer->Fence = gl::FenceSync(gl::SYNC_GPU_COMMANDS_COMPLETE, 0);
+			nextUnpackBuffer = (nextUnpackBuffer + 1) % CountOfBuffers;
+		}
+		else
+		{
+			textureArray.Upload(layer, loader.pixels.data(), loader.sizeOfLevels);
+		}
+
+		texture.Texture->Complete(textureArray, layer, loader.dimensions);
+		return true;
+	}
+
+	void TextureQueue::Process(TexturePool& pool)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+
+			for (auto& texture : decoded)
+				uploads.emplace_back(std::move(texture));
+
+			decoded.clear();
+		}
+
+		while (!uploads.empty())
+		{
+			auto& texture = uploads.front();
+
+			if (!texture.Loader)
+			{
+				texture.Texture->Fail();
+			}
+			else if (!Upload(pool, texture))
+			{
+				break;
+			}
+
+			uploads.pop_front();
+		}
+	}
+
+	void TextureQueue::Stop()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopping = true;
+		}
+
+		requested.notify_all();
+
+		for (auto& worker : workers)
+			worker.join();
+
+		workers.clear();
+
+		for (auto& unpackBuffer : unpackBuffers)
+		{
+			if (unpackBuffer.Fence != nullptr)
+				gl::DeleteSync(unpackBuffer.Fence);
+
+			if (unpackBuffer.Name != 0)
+			{
+				gl::BindBuffer(gl::PIXEL_UNPACK_BUFFER, unpackBuffer.Name);
+				gl::UnmapBuffer(gl::PIXEL_UNPACK_BUFFER);
+				gl::BindBuffer(gl::PIXEL_UNPACK_BUFFER, 0);
+				gl::DeleteBuffers(1, &unpackBuffer.Name);
+			}
+
+			unpackBuffer = UnpackBuffer{};
+		}
+	}
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "kodo-gl.hpp"
+#include "Texture.h"
+
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+
+namespace kodogl
+{
+	//
+	// Loads textures in the background. Worker threads decode the images, and the GL thread
+	// uploads the decoded pixels through a ring of persistently mapped pixel unpack buffers.
+	//
+	class TextureQueue : public nocopy
+	{
+		// Size of each pixel unpack buffer; larger images are uploaded from client memory.
+		static constexpr size_t BytesPerBuffer = 4 * 1024 * 1024;
+		static constexpr size_t CountOfBuffers = 3;
+
+		struct Request
+		{
+			kodogl::Texture* Texture;
+			std::string Filename;
+			// The image to decode instead of the file, if any.
+			std::shared_ptr<const std::vector<glm::uint8>> Encoded;
+			bool OnlyOpacity;
+			std::shared_ptr<const TextureCompressor> Compressor;
+		};
+
+		struct Decoded
+		{
+			kodogl::Texture* Texture;
+			std::unique_ptr<TextureLoader> Loader;
+		};
+
+		struct UnpackBuffer
+		{
+			GLuint Name;
+			glm::uint8* Mapped;
+			GLsync Fence;
+		};
+
+		std::mutex mutex;
+		std::condition_variable requested;
+		std::deque<Request> requests;
+		std::deque<Decoded> decoded;
+		std::vector<std::thread> workers;
+		bool stopping;
+
+		// Decoded textures waiting for a free unpack buffer, only touched by the GL thread.
+		std::deque<Decoded> uploads;
+
+		std::array<UnpackBuffer, CountOfBuffers> unpackBuffers;
+		size_t nextUnpackBuffer;
+
+		void Work();
+		bool Upload( TexturePool& pool, Decoded& texture );
+		void Enqueue( Request request );
+
+	public:
+
+		TextureQueue();
+		~TextureQueue();
+
+		//
+		// Queue the texture for decoding, and compression when a compressor is given.
+		// The texture stays pending until Process uploads it.
+		//
+		void Enqueue( Texture* texture, const std::string& filename, bool onlyOpacity, std::shared_ptr<const TextureCompressor> compressor = nullptr );
+
+		//
+		// Queue the texture for decoding from an image in memory, kept alive by the request.
+		//
+		void Enqueue( Texture* texture, std::shared_ptr<const std::vector<glm::uint8>> encoded, bool onlyOpacity, std::shared_ptr<const TextureCompressor> compressor = nullptr );
+
+		//
+		// Upload the textures decoded so far, as far as the unpack buffers allow.
+		// Must be called on the thread owning the GL context.
+		//
+		void Process( TexturePool& pool );
+
+		//
+		// Stop the workers and release the unpack buffers, while the GL context is still current.
+		//
+		void Stop();
+	};
+}
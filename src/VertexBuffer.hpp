@@ -2,6 +2,8 @@
 
 #include "kodo-gl.hpp"
 
+#include <algorithm>
+
 namespace kodogl
 {
 	struct VertexAttribute
@@ -94,6 +96,27 @@ namespace kodogl
 		}
 	};
 
+	struct Vertex2f3f1f
+	{
+		glm::vec2 Vertex;
+		glm::vec3 Texture;
+		glm::float_t Weight;
+
+		Vertex2f3f1f() {}
+		Vertex2f3f1f(float_t x, float_t y, float_t s, float_t t, float_t p, glm::float_t w) : Vertex2f3f1f(glm::vec2(x, y), glm::vec3(s, t, p), w) {}
+		Vertex2f3f1f(const glm::vec2& vp, const glm::vec3& tp, glm::float_t w) : Vertex(vp), Texture(tp), Weight(w) {}
+
+		static const std::array<VertexAttribute, 3>& Attributes()
+		{
+			static const std::array<VertexAttribute, 3> attributes{
+				VertexAttribute{ 0, 2, gl::FLOAT, false, reinterpret_cast<GLvoid*>(offsetof(Vertex2f3f1f, Vertex)) },
+				VertexAttribute{ 1, 3, gl::FLOAT, false, reinterpret_cast<GLvoid*>(offsetof(Vertex2f3f1f, Texture)) },
+				VertexAttribute{ 2, 1, gl::FLOAT, false, reinterpret_cast<GLvoid*>(offsetof(Vertex2f3f1f, Weight)) }
+			};
+			return attributes;
+		}
+	};
+
 	struct Vertex2f2f
 	{
 		glm::vec2 Vertex;
@@ -191,6 +214,11 @@ namespace kodogl
 		virtual void Render() = 0;
 		// glDrawElements a specific range of vertices.
 		virtual void Render(glm::uint32) = 0;
+		// glDrawElements the items first through last in one call. Requires Contiguous items.
+		virtual void Render(glm::uint32 first, glm::uint32 last) = 0;
+
+		// Indicates whether or not the item next directly follows the item previous in the buffer.
+		virtual bool Contiguous(glm::uint32 previous, glm::uint32 next) const = 0;
 	};
 
 	template<typename TVertex>
@@ -207,6 +235,8 @@ namespace kodogl
 		enum class VertexBufferState
 		{
 			Clean,
+			// Only the patched ranges were modified since the last upload.
+			Patched,
 			Dirty,
 			Frozen
 		};
@@ -241,17 +271,79 @@ namespace kodogl
 		// GL identity of the index buffer.
 		GLuint idOfIndices;
 
-		// Current size of the vertex buffer in the GPU.
+		// Current capacity of the vertex buffer in the GPU.
 		glm::uint32 sizeofGPUVertices;
-		// Current size of the index buffer in the GPU.
+		// Current capacity of the index buffer in the GPU.
 		glm::uint32 sizeofGPUIndices;
 
 		// State of the buffer.
 		VertexBufferState state;
 
+		// Ranges of vertices and indices modified since the last upload, [first, end).
+		std::vector<glm::uvec2> patchedVertices;
+		std::vector<glm::uvec2> patchedIndices;
+
 		// Item key 'generator'.
 		glm::uint32 keyCounter;
 
+		// Patched ranges closer than this are uploaded as one.
+		static constexpr glm::uint32 RangeGap = 256;
+
+		static void Extend(std::vector<glm::uvec2>& ranges, glm::uint32 start, glm::uint32 count)
+		{
+			if (count == 0)
+				return;
+
+			// Ranges are often patched in order, e.g. quad by quad.
+			if (!ranges.empty() && start >= ranges.back().x && start <= ranges.back().y)
+				ranges.back().y = glm::max(ranges.back().y, start + count);
+			else
+				ranges.emplace_back(start, start + count);
+		}
+
+		void Patch(glm::uint32 startOfVertices, glm::uint32 countOfVertices, glm::uint32 startOfIndices, glm::uint32 countOfIndices)
+		{
+			if (state == VertexBufferState::Clean)
+			{
+				state = VertexBufferState::Patched;
+			}
+			else if (state == VertexBufferState::Frozen)
+			{
+				// Cleared since the last upload.
+				state = VertexBufferState::Dirty;
+				return;
+			}
+			else if (state == VertexBufferState::Dirty)
+			{
+				// The whole buffer is uploaded anyway.
+				return;
+			}
+
+			Extend(patchedVertices, startOfVertices, countOfVertices);
+			Extend(patchedIndices, startOfIndices, countOfIndices);
+		}
+
+		//
+		// Upload ranges of elements, merging those that overlap or are close.
+		//
+		template<typename TElement>
+		static void UploadRanges(GLenum target, std::vector<glm::uvec2>& ranges, const std::vector<TElement>& elements)
+		{
+			std::sort(ranges.begin(), ranges.end(), [](const glm::uvec2& a, const glm::uvec2& b) { return a.x < b.x; });
+
+			for (size_t i = 0; i < ranges.size();)
+			{
+				auto range = ranges[i++];
+
+				while (i < ranges.size() && ranges[i].x <= range.y + RangeGap)
+					range.y = glm::max(range.y, ranges[i++].y);
+
+				gl::BufferSubData(target, range.x * sizeof(TElement), (range.y - range.x) * sizeof(TElement), elements.data() + range.x);
+			}
+
+			ranges.clear();
+		}
+
 	public:
 
 		// GL identity of the Vertex Array Object.
@@ -293,6 +385,8 @@ namespace kodogl
 			idOfVAO(other.idOfVAO), idOfVertices(other.idOfVertices), idOfIndices(other.idOfIndices),
 			sizeofGPUVertices(other.sizeofGPUVertices), sizeofGPUIndices(other.sizeofGPUIndices),
 			state(other.state),
+			patchedVertices(std::move(other.patchedVertices)),
+			patchedIndices(std::move(other.patchedIndices)),
 			keyCounter(other.keyCounter)
 		{
 			other.idOfVAO = 0;
@@ -354,22 +448,44 @@ namespace kodogl
 			if (state == VertexBufferState::Frozen)
 				return;
 
+			auto sizeofVertices = vertices.size() * SizeOfVertex;
+			auto sizeofIndices = indices.size() * SizeOfIndex;
+
 			//
-			// Upload vertices
+			// Upload only the patched ranges
 			//
 
-			auto sizeofVertices = vertices.size() * SizeOfVertex;
+			if (state == VertexBufferState::Patched && sizeofVertices <= sizeofGPUVertices && sizeofIndices <= sizeofGPUIndices)
+			{
+				gl::BindBuffer(gl::ARRAY_BUFFER, idOfVertices);
+				UploadRanges(gl::ARRAY_BUFFER, patchedVertices, vertices);
+				gl::BindBuffer(gl::ARRAY_BUFFER, 0);
+
+				gl::BindBuffer(gl::ELEMENT_ARRAY_BUFFER, idOfIndices);
+				UploadRanges(gl::ELEMENT_ARRAY_BUFFER, patchedIndices, indices);
+				gl::BindBuffer(gl::ELEMENT_ARRAY_BUFFER, 0);
+				return;
+			}
+
+			patchedVertices.clear();
+			patchedIndices.clear();
+
+			//
+			// Upload vertices
+			//
 
 			gl::BindBuffer(gl::ARRAY_BUFFER, idOfVertices);
 
-			if (sizeofVertices == sizeofGPUVertices)
+			if (sizeofVertices <= sizeofGPUVertices)
 			{
 				gl::BufferSubData(gl::ARRAY_BUFFER, 0, sizeofVertices, vertices.data());
 			}
 			else
 			{
-				gl::BufferData(gl::ARRAY_BUFFER, sizeofVertices, vertices.data(), gl::DYNAMIC_DRAW);
-				sizeofGPUVertices = sizeofVertices;
+				// Allocated with the capacity of the vector, so quads allocated later are uploaded as patches.
+				sizeofGPUVertices = vertices.capacity() * SizeOfVertex;
+				gl::BufferData(gl::ARRAY_BUFFER, sizeofGPUVertices, nullptr, gl::DYNAMIC_DRAW);
+				gl::BufferSubData(gl::ARRAY_BUFFER, 0, sizeofVertices, vertices.data());
 			}
 
 			gl::BindBuffer(gl::ARRAY_BUFFER, 0);
@@ -378,18 +494,17 @@ namespace kodogl
 			// Upload indices
 			//
 
-			auto sizeofIndices = indices.size() * SizeOfIndex;
-
 			gl::BindBuffer(gl::ELEMENT_ARRAY_BUFFER, idOfIndices);
 
-			if (sizeofIndices == sizeofGPUIndices)
+			if (sizeofIndices <= sizeofGPUIndices)
 			{
 				gl::BufferSubData(gl::ELEMENT_ARRAY_BUFFER, 0, sizeofIndices, indices.data());
 			}
 			else
 			{
-				gl::BufferData(gl::ELEMENT_ARRAY_BUFFER, sizeofIndices, indices.data(), gl::DYNAMIC_DRAW);
-				sizeofGPUIndices = sizeofIndices;
+				sizeofGPUIndices = indices.capacity() * SizeOfIndex;
+				gl::BufferData(gl::ELEMENT_ARRAY_BUFFER, sizeofGPUIndices, nullptr, gl::DYNAMIC_DRAW);
+				gl::BufferSubData(gl::ELEMENT_ARRAY_BUFFER, 0, sizeofIndices, indices.data());
 			}
 
 			gl::BindBuffer(gl::ELEMENT_ARRAY_BUFFER, 0);
@@ -439,6 +554,21 @@ namespace kodogl
 			gl::DrawElements(gl::TRIANGLES, item.CountOfIndices, gl::UNSIGNED_INT, indexPtr);
 		}
 
+		void Render(glm::uint32 first, glm::uint32 last) override
+		{
+			const auto& firstItem = items[first];
+			const auto& lastItem = items[last];
+			const auto* indexPtr = reinterpret_cast<void*>(firstItem.StartOfIndices * SizeOfIndex);
+
+			gl::DrawElements(gl::TRIANGLES, lastItem.StartOfIndices + lastItem.CountOfIndices - firstItem.StartOfIndices, gl::UNSIGNED_INT, indexPtr);
+		}
+
+		bool Contiguous(glm::uint32 previous, glm::uint32 next) const override
+		{
+			const auto& previousItem = items.at(previous);
+			return previousItem.StartOfIndices + previousItem.CountOfIndices == items.at(next).StartOfIndices;
+		}
+
 	public:
 
 		template<typename TVertices>
@@ -467,10 +597,12 @@ namespace kodogl
 			return keyCounter;
 		}
 
+		//
+		// Allocate quads at the back of the buffer, to be written with PushQuadTo. Only they are uploaded, as long
+		// as the buffer in the GPU has room for them and nothing else modified the buffer.
+		//
 		glm::uint32 AllocateQuads(glm::uint32 quadsLength, glm::uint32* vI, glm::uint32* iI)
 		{
-			state = VertexBufferState::Dirty;
-
 			auto startOfVertices = vertices.size();
 			auto countOfVertices = quadsLength * 4;
 			auto startOfIndices = indices.size();
@@ -479,6 +611,8 @@ namespace kodogl
 			vertices.resize(vertices.size() + countOfVertices);
 			indices.resize(indices.size() + countOfIndices);
 
+			Patch(startOfVertices, countOfVertices, startOfIndices, countOfIndices);
+
 			keyCounter++;
 			items.emplace(keyCounter, VertexBufferItem{ startOfIndices, countOfIndices, startOfVertices, countOfVertices });
 
@@ -520,6 +654,43 @@ namespace kodogl
 				indices[item.StartOfIndices + i + (num * 6)] = item.StartOfVertices + (num * 4) + IndicesOfQuad[i];
 		}
 
+		//
+		// Overwrite quads of an item in place, from its quad first on. Until something else modifies the buffer,
+		// only the overwritten range is uploaded.
+		//
+		template<typename TVertices>
+		void PatchQuads(glm::uint32 key, glm::uint32 first, const TVertices& quads, glm::uint32 quadsLength)
+		{
+			const auto& item = items.at(key);
+			auto startOfVertices = item.StartOfVertices + first * 4;
+			auto startOfIndices = item.StartOfIndices + first * 6;
+
+			for (glm::uint32 q = 0; q < quadsLength; q++)
+			{
+				for (auto i = 0; i < 4; i++)
+					vertices[startOfVertices + q * 4 + i] = quads[q * 4 + i];
+
+				for (auto i = 0; i < 6; i++)
+					indices[startOfIndices + q * 6 + i] = startOfVertices + q * 4 + IndicesOfQuad[i];
+			}
+
+			Patch(startOfVertices, quadsLength * 4, startOfIndices, quadsLength * 6);
+		}
+
+		//
+		// Move quads of an item in place, from its quad first on, uploading them like PatchQuads.
+		//
+		void MoveQuads(glm::uint32 key, glm::uint32 first, glm::uint32 quadsLength, const glm::vec2& offset)
+		{
+			const auto& item = items.at(key);
+			auto startOfVertices = item.StartOfVertices + first * 4;
+
+			for (glm::uint32 v = startOfVertices; v < startOfVertices + quadsLength * 4; v++)
+				vertices[v].Vertex += offset;
+
+			Patch(startOfVertices, quadsLength * 4, item.StartOfIndices + first * 6, 0);
+		}
+
 		template<typename TVertices>
 		glm::uint32 PushQuad(const TVertices& vRange)
 		{
@@ -561,4 +732,209 @@ namespace kodogl
 			return keyCounter;
 		}
 	};
+
+	//
+	// A buffer of line strips, expanded into joined segments by the vertex shader.
+	//
+	// Each strip is stored with its end points duplicated, [p0, p0, p1, ..., pn-1, pn-1], so that
+	// instance i reads (previous, a, b, next) from four instanced attributes over the same buffer.
+	//
+	class LineBuffer : public nocopy, public GenericVertexBuffer
+	{
+	public:
+
+		static constexpr auto SizeOfPoint = sizeof(glm::vec2);
+
+	private:
+
+		struct LineBufferItem
+		{
+			uint32_t StartOfPoints;
+			const uint32_t CountOfSegments;
+
+			LineBufferItem() : StartOfPoints(0), CountOfSegments(0) {}
+			LineBufferItem(uint32_t sp, uint32_t cs) : StartOfPoints(sp), CountOfSegments(cs) {}
+		};
+
+		// Vector of points.
+		std::vector<glm::vec2> points;
+		// Map of items.
+		std::unordered_map<GLuint, LineBufferItem> items;
+
+		// GL identity of the Vertex Array Object.
+		GLuint idOfVAO;
+		// GL identity of the point buffer.
+		GLuint idOfPoints;
+
+		// Current size of the point buffer in the GPU.
+		glm::uint32 sizeofGPUPoints;
+
+		// Points as last uploaded; strips pushed again with the same points aren't uploaded again.
+		std::vector<glm::vec2> uploaded;
+		// Range of points differing from those uploaded, empty when from isn't below to.
+		glm::uint32 dirtyFrom;
+		glm::uint32 dirtyTo;
+
+		// Item key 'generator'.
+		glm::uint32 keyCounter;
+
+	public:
+
+		explicit LineBuffer() :
+			idOfVAO(0), idOfPoints(0),
+			sizeofGPUPoints(0),
+			dirtyFrom(UINT_MAX), dirtyTo(0),
+			keyCounter(0)
+		{
+			gl::GenBuffers(1, &idOfPoints);
+			gl::GenVertexArrays(1, &idOfVAO);
+
+			gl::BindVertexArray(idOfVAO);
+			gl::BindBuffer(gl::ARRAY_BUFFER, idOfPoints);
+
+			// Previous, A, B and next point of the segment, one segment per instance.
+			for (GLuint i = 0; i < 4; i++)
+			{
+				gl::EnableVertexAttribArray(i);
+				gl::VertexAttribPointer(i, 2, gl::FLOAT, false, SizeOfPoint, reinterpret_cast<GLvoid*>(i * SizeOfPoint));
+				gl::VertexAttribDivisor(i, 1);
+			}
+
+			gl::BindVertexArray(0);
+			gl::BindBuffer(gl::ARRAY_BUFFER, 0);
+		}
+
+		~LineBuffer()
+		{
+			if (idOfVAO != 0) {
+				gl::DeleteVertexArrays(1, &idOfVAO);
+				idOfVAO = 0;
+			}
+			if (idOfPoints != 0) {
+				gl::DeleteBuffers(1, &idOfPoints);
+				idOfPoints = 0;
+			}
+		}
+
+		//
+		// Clear the line buffer.
+		//
+		void Clear()
+		{
+			items.clear();
+			points.clear();
+			keyCounter = 0;
+		}
+
+		//
+		// Push a strip of pointsLength points, translated by offset. Returns the strip's key.
+		// The bounds of the translated points are written to bounds.
+		//
+		glm::uint32 PushStrip(const glm::vec2* strip, glm::uint32 pointsLength, const glm::vec2& offset, glm::vec4& bounds)
+		{
+			auto startOfPoints = static_cast<glm::uint32>(points.size());
+
+			points.resize(points.size() + pointsLength + 2);
+
+			auto* destination = points.data() + startOfPoints + 1;
+			auto minimum = glm::vec2(FLT_MAX);
+			auto maximum = glm::vec2(-FLT_MAX);
+
+			for (glm::uint32 i = 0; i < pointsLength; i++)
+			{
+				destination[i] = strip[i] + offset;
+				minimum = glm::min(minimum, destination[i]);
+				maximum = glm::max(maximum, destination[i]);
+			}
+
+			destination[-1] = destination[0];
+			destination[pointsLength] = destination[pointsLength - 1];
+
+			bounds = glm::vec4(minimum, maximum);
+
+			//
+			// Strips are pushed again every frame; only those whose points moved are uploaded.
+			//
+			auto endOfPoints = static_cast<glm::uint32>(points.size());
+
+			if (endOfPoints > uploaded.size() || memcmp(points.data() + startOfPoints, uploaded.data() + startOfPoints, (endOfPoints - startOfPoints) * SizeOfPoint) != 0)
+			{
+				dirtyFrom = glm::min(dirtyFrom, startOfPoints);
+				dirtyTo = glm::max(dirtyTo, endOfPoints);
+			}
+
+			keyCounter++;
+			items.emplace(keyCounter, LineBufferItem{ startOfPoints, pointsLength - 1 });
+			return keyCounter;
+		}
+
+		//
+		// Upload the points that changed since the last upload. The GPU buffer only grows, points past
+		// those of the frame are never drawn.
+		//
+		void Upload()
+		{
+			auto sizeofPoints = static_cast<glm::uint32>(points.size() * SizeOfPoint);
+
+			gl::BindBuffer(gl::ARRAY_BUFFER, idOfPoints);
+
+			if (sizeofPoints > sizeofGPUPoints)
+			{
+				gl::BufferData(gl::ARRAY_BUFFER, sizeofPoints, points.data(), gl::DYNAMIC_DRAW);
+				sizeofGPUPoints = sizeofPoints;
+				uploaded = points;
+			}
+			else
+			{
+				gl::BufferSubData(gl::ARRAY_BUFFER, dirtyFrom * SizeOfPoint, (dirtyTo - dirtyFrom) * SizeOfPoint, points.data() + dirtyFrom);
+				std::copy(points.begin() + dirtyFrom, points.begin() + dirtyTo, uploaded.begin() + dirtyFrom);
+			}
+
+			gl::BindBuffer(gl::ARRAY_BUFFER, 0);
+
+			dirtyFrom = UINT_MAX;
+			dirtyTo = 0;
+		}
+
+		void Bind() override
+		{
+			if (dirtyFrom < dirtyTo)
+			{
+				Unbind();
+				Upload();
+			}
+
+			gl::BindVertexArray(idOfVAO);
+		}
+
+		void Unbind() override
+		{
+			gl::BindVertexArray(0);
+		}
+
+		void Render() override
+		{
+			for (const auto& item : items)
+				Render(item.first);
+		}
+
+		void Render(glm::uint32 id) override
+		{
+			const auto& item = items[id];
+
+			// Four vertices per segment, the corners are selected by gl_VertexID.
+			gl::DrawArraysInstancedBaseInstance(gl::TRIANGLE_STRIP, 0, 4, item.CountOfSegments, item.StartOfPoints);
+		}
+
+		void Render(glm::uint32 first, glm::uint32 last) override
+		{
+			Render(first);
+		}
+
+		// Strips are separate instanced draws, they never merge.
+		bool Contiguous(glm::uint32 previous, glm::uint32 next) const override
+		{
+			return false;
+		}
+	};
 }
\ No newline at end of file
@@ -6,6 +6,7 @@
 #include "VertexBuffer.hpp"
 
 #include "WindowContext.hpp"
+#include "Atlas.hpp"
 
 enum class ColoringUniforms
 {
@@ -15,6 +16,22 @@ enum class ColoringUniforms
 	Opacity
 };
 
+enum class LineUniforms
+{
+	Projection,
+	Width,
+	ColorA,
+	ColorB,
+	Opacity
+};
+
+enum class TextureUniforms
+{
+	Projection,
+	Texture,
+	Opacity
+};
+
 enum class TextureMaskUniforms
 {
 	Projection,
@@ -27,8 +44,15 @@ enum class TextureMaskUniforms
 namespace kodogl
 {
 	Window::Window(GLFWwindow* glfwWindow) :
-		glfwPointer(glfwWindow)
+		glfwPointer(glfwWindow),
+		area(0.0f)
 	{
+		glm::int32 width, height;
+		glfwGetFramebufferSize(glfwWindow, &width, &height);
+
+		area.z = static_cast<glm::float32>(width);
+		area.w = static_cast<glm::float32>(height);
+
 		basicGeometryBuffer = std::make_unique<VertexBuffer<Vertex2f1f>>();
 
 		//
@@ -62,7 +86,22 @@ namespace kodogl
 
 		{
 			std::vector<Shader> shaders;
-			shaders.emplace_back(ShaderType::Vertex, textureMaskGeometryVertexShaderSource);
+			shaders.emplace_back(ShaderType::Vertex, textureGeometryVertexShaderSource);
+			shaders.emplace_back(ShaderType::Fragment, textureGeometryFragmentShaderSource);
+			std::vector<Uniform> uniforms;
+			uniforms.emplace_back(TextureUniforms::Texture, "Texture");
+			uniforms.emplace_back(TextureUniforms::Opacity, "Opacity");
+			uniforms.emplace_back(TextureUniforms::Projection, "Projection");
+
+			textureGeometryProgram = std::make_unique<ShaderProgram>("textureGeometryProgram", shaders, uniforms);
+			textureGeometryProgram->Use();
+			textureGeometryProgram->Get(TextureUniforms::Texture) = 0;
+			textureGeometryProgram->Get(TextureUniforms::Opacity) = 1.0f;
+		}
+
+		{
+			std::vector<Shader> shaders;
+			shaders.emplace_back(ShaderType::Vertex, textureGeometryVertexShaderSource);
 			shaders.emplace_back(ShaderType::Fragment, textureMaskGeometryFragmentShaderSource);
 			std::vector<Uniform> uniforms;
 			uniforms.emplace_back(TextureMaskUniforms::Texture, "Texture");
@@ -78,7 +117,26 @@ namespace kodogl
 			textureMaskGeometryProgram->Get(TextureMaskUniforms::ColorB) = glm::vec4(1.0f, 1.0f, 1.0f, 1.0f);
 			textureMaskGeometryProgram->Get(TextureMaskUniforms::Opacity) = 1.0f;
 
-			textureGeometryBuffer = std::make_unique<VertexBuffer<Vertex2f2f1f>>();
+			textureGeometryBuffer = std::make_unique<VertexBuffer<Vertex2f3f1f>>();
+		}
+
+		{
+			std::vector<Shader> shaders;
+			shaders.emplace_back(ShaderType::Vertex, textureGeometryVertexShaderSource);
+			shaders.emplace_back(ShaderType::Fragment, textureDistanceFieldGeometryFragmentShaderSource);
+			std::vector<Uniform> uniforms;
+			uniforms.emplace_back(TextureMaskUniforms::Texture, "Texture");
+			uniforms.emplace_back(TextureMaskUniforms::ColorA, "ColorA");
+			uniforms.emplace_back(TextureMaskUniforms::ColorB, "ColorB");
+			uniforms.emplace_back(TextureMaskUniforms::Opacity, "Opacity");
+			uniforms.emplace_back(TextureMaskUniforms::Projection, "Projection");
+
+			textureDistanceFieldGeometryProgram = std::make_unique<ShaderProgram>("textureDistanceFieldGeometryProgram", shaders, uniforms);
+			textureDistanceFieldGeometryProgram->Use();
+			textureDistanceFieldGeometryProgram->Get(TextureMaskUniforms::Texture) = 0;
+			textureDistanceFieldGeometryProgram->Get(TextureMaskUniforms::ColorA) = glm::vec4(1.0f, 1.0f, 1.0f, 1.0f);
+			textureDistanceFieldGeometryProgram->Get(TextureMaskUniforms::ColorB) = glm::vec4(1.0f, 1.0f, 1.0f, 1.0f);
+			textureDistanceFieldGeometryProgram->Get(TextureMaskUniforms::Opacity) = 1.0f;
 		}
 
 		{
@@ -97,6 +155,27 @@ namespace kodogl
 			basicGeometryProgram->Get(ColoringUniforms::ColorB) = glm::vec4(1.0f, 1.0f, 1.0f, 1.0f);
 			basicGeometryProgram->Get(ColoringUniforms::Opacity) = 1.0f;
 		}
+
+		{
+			std::vector<Shader> shaders;
+			shaders.emplace_back(ShaderType::Vertex, lineGeometryVertexShaderSource);
+			shaders.emplace_back(ShaderType::Fragment, basicGeometryFragmentShaderSource);
+			std::vector<Uniform> uniforms;
+			uniforms.emplace_back(LineUniforms::Width, "Width");
+			uniforms.emplace_back(LineUniforms::ColorA, "ColorA");
+			uniforms.emplace_back(LineUniforms::ColorB, "ColorB");
+			uniforms.emplace_back(LineUniforms::Opacity, "Opacity");
+			uniforms.emplace_back(LineUniforms::Projection, "Projection");
+
+			lineGeometryProgram = std::make_unique<ShaderProgram>("lineGeometryProgram", shaders, uniforms);
+			lineGeometryProgram->Use();
+			lineGeometryProgram->Get(LineUniforms::Width) = 1.0f;
+			lineGeometryProgram->Get(LineUniforms::ColorA) = glm::vec4(1.0f, 1.0f, 1.0f, 1.0f);
+			lineGeometryProgram->Get(LineUniforms::ColorB) = glm::vec4(1.0f, 1.0f, 1.0f, 1.0f);
+			lineGeometryProgram->Get(LineUniforms::Opacity) = 1.0f;
+
+			lineGeometryBuffer = std::make_unique<LineBuffer>();
+		}
 	}
 
 	void Window::OnPositionChanged(glm::int32 x, glm::int32 y)
@@ -130,8 +209,22 @@ namespace kodogl
 
 		basicGeometryProgram->Use();
 		basicGeometryProgram->Get(ColoringUniforms::Projection).Set(projection);
+		textureGeometryProgram->Use();
+		textureGeometryProgram->Get(TextureUniforms::Projection).Set(projection);
 		textureMaskGeometryProgram->Use();
 		textureMaskGeometryProgram->Get(TextureMaskUniforms::Projection).Set(projection);
+		textureDistanceFieldGeometryProgram->Use();
+		textureDistanceFieldGeometryProgram->Get(TextureMaskUniforms::Projection).Set(projection);
+		lineGeometryProgram->Use();
+		lineGeometryProgram->Get(LineUniforms::Projection).Set(projection);
+	}
+
+	void Window::Scissor(const glm::vec4& contextArea) const
+	{
+		gl::Scissor(static_cast<GLint>(contextArea.x),
+					static_cast<GLint>(area.w - contextArea.w),
+					static_cast<GLsizei>(contextArea.z - contextArea.x),
+					static_cast<GLsizei>(contextArea.w - contextArea.y));
 	}
 
 	void Window::BeginFrame()
@@ -139,8 +232,11 @@ namespace kodogl
 		bool fullFrame = false;
 
 		basicGeometryBuffer->Clear();
+		textureGeometryBuffer->Clear();
+		lineGeometryBuffer->Clear();
 
 		commandVector.clear();
+		atlasesOfFrame.clear();
 
 		for (const auto& context : drawingContexts)
 		{
@@ -160,6 +256,31 @@ namespace kodogl
 	{
 		auto fullFrame = true;
 
+		//
+		// Upload the glyphs rasterized for this frame's text. An atlas grown by new pages gets a new texture,
+		// so text commands learn theirs only now.
+		//
+		for (auto* atlas : atlasesOfFrame)
+			atlas->Upload();
+
+		for (auto& ref : commandVector)
+		{
+			if (ref.GlyphAtlas != nullptr)
+				ref.TextureRef = ref.GlyphAtlas->Name();
+		}
+
+		atlasesOfFrame.clear();
+
+		//
+		// Drop commands that lie entirely outside the frame buffer, so they're never sorted.
+		//
+		auto outside = [this](const DrawingReference& ref)
+		{
+			return ref.Bounds.x >= area.z || ref.Bounds.y >= area.w || ref.Bounds.z <= 0.0f || ref.Bounds.w <= 0.0f;
+		};
+
+		commandVector.erase(std::remove_if(commandVector.begin(), commandVector.end(), outside), commandVector.end());
+
 		//
 		// Sort the accumulated commands.
 		//
@@ -200,11 +321,7 @@ namespace kodogl
 				if (context->Modified)
 				{
 					// Scissor the context area.
-					const auto& contextArea = context->Area();
-					gl::Scissor(static_cast<GLint>(contextArea.x),
-								static_cast<GLint>(area.w - contextArea.w),
-								static_cast<GLsizei>(contextArea.z - contextArea.x),
-								static_cast<GLsizei>(contextArea.w - contextArea.y));
+					Scissor(context->Area());
 
 					// Clear the context area.
 					gl::Clear(gl::COLOR_BUFFER_BIT);
@@ -216,19 +333,36 @@ namespace kodogl
 		WindowContext* currentContext = nullptr;
 		GenericVertexBuffer* currentBuffer = nullptr;
 
-		for (const auto& ref : commandVector)
+		for (size_t i = 0; i < commandVector.size(); i++)
 		{
+			const auto& ref = commandVector[i];
+
+			//
+			// Merge the following commands that share this command's state and continue its geometry.
+			//
+			auto last = i;
+
+			while (last + 1 < commandVector.size())
+			{
+				const auto& next = commandVector[last + 1];
+
+				if (!ref.SharesState(next) || ((!fullFrame || ref.Scissored) && ref.Context != next.Context) ||
+					ref.GeometryRef == DrawingReference::WholeBuffer ||
+					!ref.Buffer->Contiguous(commandVector[last].GeometryRef, next.GeometryRef))
+					break;
+
+				last++;
+			}
+
+			const auto lastGeometryRef = commandVector[last].GeometryRef;
+			i = last;
+
 			if (!fullFrame && currentContext != ref.Context)
 			{
 				currentContext = ref.Context;
 
 				// Scissor the context area.
-				const auto& contextArea = currentContext->Area();
-				//printf_s( "%f", area.x );
-				gl::Scissor(static_cast<GLint>(contextArea.x),
-							static_cast<GLint>(area.w - contextArea.w),
-							static_cast<GLsizei>(contextArea.z - contextArea.x),
-							static_cast<GLsizei>(contextArea.w - contextArea.y));
+				Scissor(currentContext->Area());
 			}
 
 			if (currentBuffer != ref.Buffer)
@@ -237,6 +371,27 @@ namespace kodogl
 				currentBuffer->Bind();
 			}
 
+			//
+			// Textures hold premultiplied colors.
+			//
+			if ((ref.Type == CommandType::Texture) != (currentType == CommandType::Texture))
+				gl::BlendFunc(ref.Type == CommandType::Texture ? gl::ONE : gl::SRC_ALPHA, gl::ONE_MINUS_SRC_ALPHA);
+
+			auto render = [&]()
+			{
+				if (ref.GeometryRef == DrawingReference::WholeBuffer)
+					currentBuffer->Render();
+				else
+					currentBuffer->Render(ref.GeometryRef, lastGeometryRef);
+			};
+
+			// Geometry that isn't clipped on the CPU is scissored to its context.
+			if (fullFrame && ref.Scissored)
+			{
+				gl::Enable(gl::SCISSOR_TEST);
+				Scissor(ref.Context->Area());
+			}
+
 			switch (ref.Type)
 			{
 				case CommandType::Color:
@@ -250,11 +405,23 @@ namespace kodogl
 					basicGeometryProgram->Get(ColoringUniforms::ColorA) = glm::unpackUnorm4x8(ref.ColorA);
 					basicGeometryProgram->Get(ColoringUniforms::ColorB) = glm::unpackUnorm4x8(ref.ColorB);
 
-					currentBuffer->Render(ref.GeometryRef);
+					render();
 					break;
 				}
 				case CommandType::Texture:
+				{
+					if (currentType != CommandType::Texture)
+					{
+						currentType = CommandType::Texture;
+						textureGeometryProgram->Use();
+					}
+
+					gl::ActiveTexture(gl::TEXTURE0);
+					gl::BindTexture(gl::TEXTURE_2D_ARRAY, ref.TextureRef);
+
+					render();
 					break;
+				}
 				case CommandType::TextureMask:
 				{
 					if (currentType != CommandType::TextureMask)
@@ -264,11 +431,43 @@ namespace kodogl
 					}
 
 					gl::ActiveTexture(gl::TEXTURE0);
-					gl::BindTexture(gl::TEXTURE_2D, ref.TextureRef);
+					gl::BindTexture(gl::TEXTURE_2D_ARRAY, ref.TextureRef);
 
 					textureMaskGeometryProgram->Get(TextureMaskUniforms::ColorA) = glm::unpackUnorm4x8(ref.ColorA);
 					textureMaskGeometryProgram->Get(TextureMaskUniforms::ColorB) = glm::unpackUnorm4x8(ref.ColorB);
 
+					render();
+					break;
+				}
+				case CommandType::TextureDistanceField:
+				{
+					if (currentType != CommandType::TextureDistanceField)
+					{
+						currentType = CommandType::TextureDistanceField;
+						textureDistanceFieldGeometryProgram->Use();
+					}
+
+					gl::ActiveTexture(gl::TEXTURE0);
+					gl::BindTexture(gl::TEXTURE_2D_ARRAY, ref.TextureRef);
+
+					textureDistanceFieldGeometryProgram->Get(TextureMaskUniforms::ColorA) = glm::unpackUnorm4x8(ref.ColorA);
+					textureDistanceFieldGeometryProgram->Get(TextureMaskUniforms::ColorB) = glm::unpackUnorm4x8(ref.ColorB);
+
+					render();
+					break;
+				}
+				case CommandType::Line:
+				{
+					if (currentType != CommandType::Line)
+					{
+						currentType = CommandType::Line;
+						lineGeometryProgram->Use();
+					}
+
+					lineGeometryProgram->Get(LineUniforms::Width) = ref.Width;
+					lineGeometryProgram->Get(LineUniforms::ColorA) = glm::unpackUnorm4x8(ref.ColorA);
+					lineGeometryProgram->Get(LineUniforms::ColorB) = glm::unpackUnorm4x8(ref.ColorB);
+
 					currentBuffer->Render(ref.GeometryRef);
 					break;
 				}
@@ -278,9 +477,13 @@ namespace kodogl
 					break;
 #endif
 			}
+
+			if (fullFrame && ref.Scissored)
+				gl::Disable(gl::SCISSOR_TEST);
 		}
 
 		gl::Disable(gl::SCISSOR_TEST);
+		gl::BlendFunc(gl::SRC_ALPHA, gl::ONE_MINUS_SRC_ALPHA);
 
 		//
 		// Switch to default frame buffer.
@@ -25,25 +25,36 @@ namespace kodogl
 		SizeChangedCallback sizeChangedCallback;
 
 		std::vector<DrawingReference> commandVector;
+		// Atlases of the text drawn in this frame, uploaded before drawing.
+		std::vector<Atlas*> atlasesOfFrame;
 		std::vector<std::unique_ptr<WindowContext>> drawingContexts;
 
 		std::unique_ptr<ShaderProgram> frameBufferProgram;
 		std::unique_ptr<ShaderProgram> basicGeometryProgram;
 		std::unique_ptr<ShaderProgram> textureGeometryProgram;
 		std::unique_ptr<ShaderProgram> textureMaskGeometryProgram;
+		std::unique_ptr<ShaderProgram> textureDistanceFieldGeometryProgram;
+		std::unique_ptr<ShaderProgram> lineGeometryProgram;
 		std::unique_ptr<VertexBuffer<Vertex2f2f>> frameBufferGeometry;
 		std::unique_ptr<VertexBuffer<Vertex2f1f>> basicGeometryBuffer;
-		std::unique_ptr<VertexBuffer<Vertex2f2f1f>> textureGeometryBuffer;
+		std::unique_ptr<VertexBuffer<Vertex2f3f1f>> textureGeometryBuffer;
+		std::unique_ptr<LineBuffer> lineGeometryBuffer;
 
 		glm::vec4 area;
 		glm::mat4x4 projection;
 		glm::uint32 idOfFrameBuffer;
 		glm::uint32 idOfFrameBufferTexture;
 
+		void Scissor( const glm::vec4& contextArea ) const;
+
 	public:
 
 		GLFWwindow* GLFWPointer() { return glfwPointer; }
 
+		//
+		// Size of the frame buffer in pixels.
+		glm::vec2 FrameBufferSize() const { return glm::vec2( area.z, area.w ); }
+
 		Window( GLFWwindow* glfwWindow );
 
 		WindowContext* AddContext( std::unique_ptr<WindowContext> context )
@@ -4,14 +4,24 @@
 #include "VertexBuffer.hpp"
 
 #include "Window.hpp"
+#include "Series.hpp"
+#include "TextView.hpp"
+#include "LineLayout.hpp"
+#include "NumberGlyphs.hpp"
+#include "Texture.h"
+
+#include <cfloat>
+#include <xmmintrin.h>
 
 namespace kodogl
 {
 	WindowContext::WindowContext(Window* window) :
 		Modified(false),
 		area(glm::vec4(1, 1, 11, 11)),
+		window(*window),
 		dynamicColoredGeometry(*window->basicGeometryBuffer),
 		texturedGeometry(*window->textureGeometryBuffer),
+		lineGeometry(*window->lineGeometryBuffer),
 		cmdVector(window->commandVector)
 	{
 
@@ -37,6 +47,9 @@ namespace kodogl
 	{
 		Modified = false;
 		currentLayer = 0;
+		mappedBrush = nullptr;
+		textFont = nullptr;
+		textVertices.clear();
 	}
 
 	void WindowContext::PushLayer()
@@ -52,50 +65,246 @@ namespace kodogl
 		}
 	}
 
-	void WindowContext::DrawQuads(glm::vec4* quads, int quadsLength, const Brush* brush)
+	glm::vec4 WindowContext::ClipArea() const
 	{
-		Modified = true;
+		auto frameBufferSize = window.FrameBufferSize();
 
-		switch (brush->Type)
+		return glm::vec4(glm::max(area.x, 0.0f), glm::max(area.y, 0.0f),
+						 glm::min(area.z, frameBufferSize.x), glm::min(area.w, frameBufferSize.y));
+	}
+
+	bool WindowContext::Clip(const glm::vec4& quad, ClippedQuad& clipped) const
+	{
+		auto clip = ClipArea();
+
+		clipped.Quad = Transform(quad);
+		clipped.Clipped = glm::vec4(glm::max(clipped.Quad.x, clip.x), glm::max(clipped.Quad.y, clip.y),
+									glm::min(clipped.Quad.z, clip.z), glm::min(clipped.Quad.w, clip.w));
+
+		return clipped.Clipped.x < clipped.Clipped.z && clipped.Clipped.y < clipped.Clipped.w;
+	}
+
+	glm::uint32 WindowContext::CullQuads(const glm::vec4* quads, int quadsLength, glm::vec4& bounds)
+	{
+		clippedQuads.clear();
+
+		auto clip = ClipArea();
+
+		if (clip.x >= clip.z || clip.y >= clip.w)
+			return 0;
+
+		clippedQuads.reserve(quadsLength);
+
+		// Lanes are (L, T, R, B), _mm_set_ps takes them in reverse.
+		const auto offset = _mm_set_ps(area.y, area.x, area.y, area.x);
+		const auto clipMin = _mm_set_ps(clip.y, clip.x, clip.y, clip.x);
+		const auto clipMax = _mm_set_ps(clip.w, clip.z, clip.w, clip.z);
+
+		auto boundsMin = _mm_set1_ps(FLT_MAX);
+		auto boundsMax = _mm_set1_ps(-FLT_MAX);
+
+		for (auto i = 0; i < quadsLength; i++)
 		{
-			case BrushType::Linear:
-			{
-				static std::array<Vertex2f1f, 4> vertices;
+			auto quad = _mm_add_ps(_mm_loadu_ps(&quads[i].x), offset);
+			auto clipped = _mm_min_ps(_mm_max_ps(quad, clipMin), clipMax);
 
-				const auto* colorBrush = reinterpret_cast<const ColorBrush*>(brush);
+			// Visible only if L < R and T < B after clamping to the clip area.
+			auto rightBottom = _mm_movehl_ps(clipped, clipped);
 
-				glm::uint32 vI;
-				glm::uint32 iI;
-				glm::uint32 quadsId = dynamicColoredGeometry.AllocateQuads(quadsLength, &vI, &iI);
+			if ((_mm_movemask_ps(_mm_cmplt_ps(clipped, rightBottom)) & 3) != 3)
+				continue;
 
-				for (auto i = 0; i < quadsLength; i++)
-				{
-					auto transformedQuad = Transform(quads[i]);
+			boundsMin = _mm_min_ps(boundsMin, clipped);
+			boundsMax = _mm_max_ps(boundsMax, clipped);
 
-					vertices[0] = Vertex2f1f{ transformedQuad.x, transformedQuad.y, colorBrush->Weights.x };
-					vertices[1] = Vertex2f1f{ transformedQuad.x, transformedQuad.w, colorBrush->Weights.y };
-					vertices[2] = Vertex2f1f{ transformedQuad.z, transformedQuad.w, colorBrush->Weights.z };
-					vertices[3] = Vertex2f1f{ transformedQuad.z, transformedQuad.y, colorBrush->Weights.w };
+			ClippedQuad clippedQuad;
+			_mm_storeu_ps(&clippedQuad.Quad.x, quad);
+			_mm_storeu_ps(&clippedQuad.Clipped.x, clipped);
+			clippedQuads.push_back(clippedQuad);
+		}
 
-					dynamicColoredGeometry.PushQuadTo(vI, iI, i, vertices);
-				}
+		glm::vec4 minimum, maximum;
+		_mm_storeu_ps(&minimum.x, boundsMin);
+		_mm_storeu_ps(&maximum.x, boundsMax);
+		bounds = glm::vec4(minimum.x, minimum.y, maximum.z, maximum.w);
 
-				DrawingReference ref;
-				ref.Layer = currentLayer;
-				ref.GeometryRef = quadsId;
-				ref.TextureRef = 0;
-				ref.Type = CommandType::Color;
-				ref.ColorA = colorBrush->ColorA;
-				ref.ColorB = colorBrush->ColorB;
-				ref.Context = this;
-				ref.Buffer = &dynamicColoredGeometry;
-				cmdVector.emplace_back(ref);
+		return static_cast<glm::uint32>(clippedQuads.size());
+	}
+
+	//
+	// The part of a quad that survived clipping, as fractions (u0, v0, u1, v1) of the quad.
+	//
+	static glm::vec4 ClippedFraction(const glm::vec4& quad, const glm::vec4& clipped)
+	{
+		if (clipped == quad)
+			return glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+
+		auto size = glm::vec2(quad.z - quad.x, quad.w - quad.y);
+
+		return glm::vec4((clipped.x - quad.x) / size.x, (clipped.y - quad.y) / size.y,
+						 (clipped.z - quad.x) / size.x, (clipped.w - quad.y) / size.y);
+	}
+
+	//
+	// Brush weights (LT, LB, RB, RT) interpolated over the clipped fraction of a quad.
+	//
+	static glm::vec4 ClippedWeights(const glm::vec4& weights, const glm::vec4& fraction)
+	{
+		auto weight = [&weights](float_t u, float_t v)
+		{
+			return glm::mix(glm::mix(weights.x, weights.w, u), glm::mix(weights.y, weights.z, u), v);
+		};
+
+		return glm::vec4(weight(fraction.x, fraction.y), weight(fraction.x, fraction.w),
+						 weight(fraction.z, fraction.w), weight(fraction.z, fraction.y));
+	}
+
+	//
+	// Fill the vertices of a colored quad, interpolating the brush weights over the part that survived clipping.
+	//
+	static void ColoredQuad(const ColorBrush* colorBrush, const glm::vec4& quad, const glm::vec4& clipped, std::array<Vertex2f1f, 4>& vertices)
+	{
+		auto weights = ClippedWeights(colorBrush->Weights, ClippedFraction(quad, clipped));
+
+		vertices[0] = Vertex2f1f{ clipped.x, clipped.y, weights.x };
+		vertices[1] = Vertex2f1f{ clipped.x, clipped.w, weights.y };
+		vertices[2] = Vertex2f1f{ clipped.z, clipped.w, weights.z };
+		vertices[3] = Vertex2f1f{ clipped.z, clipped.y, weights.w };
+	}
+
+	//
+	// Fill the vertices of a textured quad. The texture region (L, T, R, B) and weights follow the part that survived clipping.
+	//
+	static void TexturedQuad(const glm::vec4& region, glm::float32 layer, const glm::vec4& weights, const glm::vec4& quad, const glm::vec4& clipped, std::array<Vertex2f3f1f, 4>& vertices)
+	{
+		auto fraction = ClippedFraction(quad, clipped);
+		auto clippedWeights = ClippedWeights(weights, fraction);
+
+		auto s0 = glm::mix(region.x, region.z, fraction.x);
+		auto t0 = glm::mix(region.y, region.w, fraction.y);
+		auto s1 = glm::mix(region.x, region.z, fraction.z);
+		auto t1 = glm::mix(region.y, region.w, fraction.w);
+
+		vertices[0] = Vertex2f3f1f{ clipped.x, clipped.y, s0, t0, layer, clippedWeights.x };
+		vertices[1] = Vertex2f3f1f{ clipped.x, clipped.w, s0, t1, layer, clippedWeights.y };
+		vertices[2] = Vertex2f3f1f{ clipped.z, clipped.w, s1, t1, layer, clippedWeights.z };
+		vertices[3] = Vertex2f3f1f{ clipped.z, clipped.y, s1, t0, layer, clippedWeights.w };
+	}
+
+	void WindowContext::DrawColoredQuads(const ClippedQuad* quads, glm::uint32 quadsLength, const glm::vec4& bounds, const ColorBrush* colorBrush)
+	{
+		static std::array<Vertex2f1f, 4> vertices;
+
+		glm::uint32 vI;
+		glm::uint32 iI;
+		glm::uint32 quadsId = dynamicColoredGeometry.AllocateQuads(quadsLength, &vI, &iI);
+
+		for (glm::uint32 i = 0; i < quadsLength; i++)
+		{
+			ColoredQuad(colorBrush, quads[i].Quad, quads[i].Clipped, vertices);
+			dynamicColoredGeometry.PushQuadTo(vI, iI, i, vertices);
+		}
+
+		DrawingReference ref;
+		ref.Layer = currentLayer;
+		ref.GeometryRef = quadsId;
+		ref.TextureRef = 0;
+		ref.Type = CommandType::Color;
+		ref.ColorA = colorBrush->ColorA;
+		ref.ColorB = colorBrush->ColorB;
+		ref.Context = this;
+		ref.Buffer = &dynamicColoredGeometry;
+		ref.Bounds = bounds;
+		cmdVector.emplace_back(ref);
+	}
+
+	void WindowContext::DrawTexturedQuads(const ClippedQuad* quads, glm::uint32 quadsLength, const glm::vec4& bounds, const Brush* brush)
+	{
+		static std::array<Vertex2f3f1f, 4> vertices;
+
+		const Texture* texture;
+		glm::vec4 weights;
+		glm::uint32 colorA, colorB;
+
+		if (brush->Type == BrushType::TextureMask)
+		{
+			const auto* maskBrush = reinterpret_cast<const TextureMaskBrush*>(brush);
+			texture = maskBrush->Mask;
+			weights = maskBrush->Weights;
+			colorA = maskBrush->ColorA;
+			colorB = maskBrush->ColorB;
+		}
+		else
+		{
+			texture = reinterpret_cast<const TextureBrush*>(brush)->Texture;
+			weights = glm::vec4(0.0f);
+			colorA = colorB = 0xFFFFFFFF;
+		}
+
+		texture->Touch();
+
+		//
+		// Draw a flat placeholder until the texture has been decoded and uploaded.
+		//
+		if (!texture->Ready())
+		{
+			static const ColorBrush placeholderBrush(glm::vec4(0.5f, 0.5f, 0.5f, 0.25f));
+
+			DrawColoredQuads(quads, quadsLength, bounds, &placeholderBrush);
+			return;
+		}
+
+		auto region = texture->Region();
+		auto layer = static_cast<glm::float32>(texture->Layer());
+
+		glm::uint32 vI;
+		glm::uint32 iI;
+		glm::uint32 quadsId = texturedGeometry.AllocateQuads(quadsLength, &vI, &iI);
+
+		for (glm::uint32 i = 0; i < quadsLength; i++)
+		{
+			TexturedQuad(region, layer, weights, quads[i].Quad, quads[i].Clipped, vertices);
+			texturedGeometry.PushQuadTo(vI, iI, i, vertices);
+		}
+
+		DrawingReference ref;
+		ref.Layer = currentLayer;
+		ref.GeometryRef = quadsId;
+		ref.TextureRef = texture->Name();
+		ref.Type = brush->Type == BrushType::TextureMask ? CommandType::TextureMask : CommandType::Texture;
+		ref.ColorA = colorA;
+		ref.ColorB = colorB;
+		ref.Context = this;
+		ref.Buffer = &texturedGeometry;
+		ref.Bounds = bounds;
+		cmdVector.emplace_back(ref);
+	}
+
+	void WindowContext::DrawQuads(glm::vec4* quads, int quadsLength, const Brush* brush)
+	{
+		Modified = true;
+
+		switch (brush->Type)
+		{
+			case BrushType::Linear:
+			{
+				glm::vec4 bounds;
+				auto visibleLength = CullQuads(quads, quadsLength, bounds);
+
+				if (visibleLength > 0)
+					DrawColoredQuads(clippedQuads.data(), visibleLength, bounds, reinterpret_cast<const ColorBrush*>(brush));
 				break;
 			}
 			case BrushType::Texture:
-				break;
 			case BrushType::TextureMask:
+			{
+				glm::vec4 bounds;
+				auto visibleLength = CullQuads(quads, quadsLength, bounds);
+
+				if (visibleLength > 0)
+					DrawTexturedQuads(clippedQuads.data(), visibleLength, bounds, brush);
 				break;
+			}
 		}
 	}
 
@@ -103,19 +312,19 @@ namespace kodogl
 	{
 		Modified = true;
 
+		ClippedQuad clippedQuad;
+
+		if (!Clip(quad, clippedQuad))
+			return;
+
 		switch (brush->Type)
 		{
 			case BrushType::Linear:
 			{
 				const auto* colorBrush = reinterpret_cast<const ColorBrush*>(brush);
 
-				auto transformedQuad = Transform(quad);
-
 				static std::array<Vertex2f1f, 4> vertices;
-				vertices[0] = Vertex2f1f{ transformedQuad.x, transformedQuad.y, colorBrush->Weights.x };
-				vertices[1] = Vertex2f1f{ transformedQuad.x, transformedQuad.w, colorBrush->Weights.y };
-				vertices[2] = Vertex2f1f{ transformedQuad.z, transformedQuad.w, colorBrush->Weights.z };
-				vertices[3] = Vertex2f1f{ transformedQuad.z, transformedQuad.y, colorBrush->Weights.w };
+				ColoredQuad(colorBrush, clippedQuad.Quad, clippedQuad.Clipped, vertices);
 
 				auto quadId = dynamicColoredGeometry.PushQuad(vertices);
 
@@ -128,13 +337,344 @@ namespace kodogl
 				ref.ColorB = colorBrush->ColorB;
 				ref.Context = this;
 				ref.Buffer = &dynamicColoredGeometry;
+				ref.Bounds = clippedQuad.Clipped;
 				cmdVector.emplace_back(ref);
 				break;
 			}
 			case BrushType::Texture:
-				break;
 			case BrushType::TextureMask:
+				DrawTexturedQuads(&clippedQuad, 1, clippedQuad.Clipped, brush);
 				break;
 		}
 	}
-}
\ No newline at end of file
+
+	void WindowContext::DrawLineStrip(const glm::vec2* points, int pointsLength, glm::float32 width, const Brush* brush)
+	{
+		if (pointsLength < 2 || brush->Type != BrushType::Linear)
+			return;
+
+		Modified = true;
+
+		const auto* colorBrush = reinterpret_cast<const ColorBrush*>(brush);
+
+		glm::vec4 bounds;
+		auto stripId = lineGeometry.PushStrip(points, pointsLength, glm::vec2(area.x, area.y), bounds);
+
+		// Account for the line width, including mitered joints.
+		bounds += glm::vec4(-2.0f, -2.0f, 2.0f, 2.0f) * width;
+
+		DrawingReference ref;
+		ref.Layer = currentLayer;
+		ref.GeometryRef = stripId;
+		ref.TextureRef = 0;
+		ref.Type = CommandType::Line;
+		ref.ColorA = colorBrush->ColorA;
+		ref.ColorB = colorBrush->ColorB;
+		ref.Context = this;
+		ref.Buffer = &lineGeometry;
+		ref.Bounds = bounds;
+		ref.Width = width;
+		// Lines aren't clipped on the CPU.
+		ref.Scissored = true;
+		cmdVector.emplace_back(ref);
+	}
+
+	void WindowContext::DrawSeries(Series& series, const glm::dvec2& xRange, const glm::vec2& yRange, glm::float32 width, const Brush* brush)
+	{
+		auto areaWidth = area.z - area.x;
+		auto areaHeight = area.w - area.y;
+
+		if (areaWidth <= 0.0f || xRange.y <= xRange.x || yRange.y == yRange.x)
+			return;
+
+		const auto& samples = series.Decimate(xRange.x, xRange.y, static_cast<glm::uint32>(glm::ceil(areaWidth)));
+
+		auto scaleX = static_cast<double_t>(areaWidth) / (xRange.y - xRange.x);
+		auto scaleY = -areaHeight / (yRange.y - yRange.x);
+
+		seriesPoints.resize(samples.size());
+
+		// Indices are made relative to the range before they're floats, so those of long series keep apart.
+		for (size_t i = 0; i < samples.size(); i++)
+		{
+			auto x = (static_cast<double_t>(samples[i].Index) - xRange.x) * scaleX;
+			seriesPoints[i] = glm::vec2(static_cast<glm::float32>(x), (samples[i].Value - yRange.x) * scaleY + areaHeight);
+		}
+
+		DrawLineStrip(seriesPoints.data(), static_cast<int>(seriesPoints.size()), width, brush);
+	}
+
+	glm::vec4* WindowContext::MapQuads(int quadsLength, const Brush* brush)
+	{
+		if (mappedBrush != nullptr)
+			throw kodogl::exception("WindowContext: MapQuads called while another mapping is pending.");
+
+		// The staging area keeps its capacity, so steady-state mapping doesn't allocate.
+		mappedQuads.resize(quadsLength);
+		mappedBrush = brush;
+
+		return mappedQuads.data();
+	}
+
+	void WindowContext::CommitQuads()
+	{
+		if (mappedBrush == nullptr)
+			return;
+
+		DrawQuads(mappedQuads.data(), static_cast<int>(mappedQuads.size()), mappedBrush);
+
+		mappedBrush = nullptr;
+	}
+
+	void WindowContext::BeginText(const AtlasFont& font, const Brush* brush)
+	{
+		if (textFont != nullptr)
+			throw kodogl::exception("WindowContext: BeginText called while another batch of text is pending.");
+
+		Modified = true;
+
+		if (brush->Type == BrushType::Texture)
+		{
+			textWeights = glm::vec4(0.0f);
+			textColorA = textColorB = 0xFFFFFFFF;
+		}
+		else
+		{
+			// Color and texture mask brushes lend their colors; the mask of the latter is the glyphs.
+			const auto* colorBrush = reinterpret_cast<const ColorBrush*>(brush);
+			textWeights = colorBrush->Weights;
+			textColorA = colorBrush->ColorA;
+			textColorB = colorBrush->ColorB;
+		}
+
+		// The staging area keeps its capacity, so steady-state text doesn't allocate.
+		textVertices.clear();
+		textFont = &font;
+		textBounds = glm::vec4(FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX);
+	}
+
+	void WindowContext::PushText(const TextRun& run, const glm::vec4& bounds, TextAligment xAlign, TextAligment yAlign)
+	{
+		if (textFont == nullptr)
+			return;
+
+		auto origin = run.Origin(bounds, xAlign, yAlign) + glm::vec2(area.x, area.y);
+
+		// The brush spans the run, from the top of its highest glyph.
+		auto box = glm::vec4(origin.x, origin.y - run.Ascent, origin.x + glm::max(run.Dimensions.x, 1.0f), origin.y - run.Ascent + glm::max(run.Dimensions.y, 1.0f));
+
+		PushGlyphs(run.Vertices.data(), run.Vertices.size(), origin, box);
+	}
+
+	void WindowContext::PushNumber(NumberGlyphs& glyphs, const NumberText& text, const glm::vec4& bounds, TextAligment xAlign, TextAligment yAlign, float_t size)
+	{
+		if (textFont == nullptr)
+			return;
+
+		if (&glyphs.Font() != textFont)
+			throw kodogl::exception("WindowContext: PushNumber called with glyphs of another font than the batch's.");
+
+		Vertex2f3f1f glyphVertices[NumberText::MaxLength * 4];
+		glm::vec2 dimensions;
+
+		auto countOfVertices = glyphs.Layout(text, bounds, xAlign, yAlign, size, glyphVertices, &dimensions);
+
+		if (countOfVertices == 0)
+			return;
+
+		// The glyphs are laid out within bounds; the brush spans them, from the top of the highest.
+		auto origin = glm::vec2(area.x, area.y);
+		auto top = FLT_MAX;
+
+		for (size_t i = 0; i < countOfVertices; i += 4)
+			top = glm::min(top, glyphVertices[i].Vertex.y);
+
+		auto left = glyphVertices[0].Vertex.x + origin.x;
+		auto box = glm::vec4(left, top + origin.y, left + glm::max(dimensions.x, 1.0f), top + origin.y + glm::max(dimensions.y, 1.0f));
+
+		PushGlyphs(glyphVertices, countOfVertices, origin, box);
+	}
+
+	void WindowContext::PushGlyphs(const Vertex2f3f1f* glyphVertices, size_t countOfVertices, const glm::vec2& origin, const glm::vec4& box)
+	{
+		std::array<Vertex2f3f1f, 4> vertices;
+
+		auto clip = ClipArea();
+		auto uniform = textWeights == glm::vec4(textWeights.x);
+
+		for (size_t i = 0; i + 3 < countOfVertices; i += 4)
+		{
+			const auto* glyph = &glyphVertices[i];
+
+			auto quad = glm::vec4(glyph[0].Vertex + origin, glyph[2].Vertex + origin);
+			auto clipped = glm::vec4(glm::max(quad.x, clip.x), glm::max(quad.y, clip.y),
+									 glm::min(quad.z, clip.z), glm::min(quad.w, clip.w));
+
+			if (clipped.x >= clipped.z || clipped.y >= clipped.w)
+				continue;
+
+			textBounds = glm::vec4(glm::min(textBounds.x, clipped.x), glm::min(textBounds.y, clipped.y),
+								   glm::max(textBounds.z, clipped.z), glm::max(textBounds.w, clipped.w));
+
+			//
+			// Glyphs within the clip area, drawn with a single color, are copied as they are.
+			//
+			if (uniform && clipped == quad)
+			{
+				for (auto v = 0; v < 4; v++)
+				{
+					textVertices.push_back(glyph[v]);
+					textVertices.back().Vertex += origin;
+					textVertices.back().Weight = textWeights.x;
+				}
+
+				continue;
+			}
+
+			auto region = glm::vec4(glyph[0].Texture.x, glyph[0].Texture.y, glyph[2].Texture.x, glyph[2].Texture.y);
+			auto weights = uniform ? glm::vec4(textWeights.x) : ClippedWeights(textWeights, ClippedFraction(box, quad));
+
+			TexturedQuad(region, glyph[0].Texture.z, weights, quad, clipped, vertices);
+			textVertices.insert(textVertices.end(), vertices.begin(), vertices.end());
+		}
+	}
+
+	void WindowContext::UseAtlas(Atlas& atlas)
+	{
+		if (std::find(window.atlasesOfFrame.begin(), window.atlasesOfFrame.end(), &atlas) == window.atlasesOfFrame.end())
+			window.atlasesOfFrame.push_back(&atlas);
+	}
+
+	void WindowContext::CommitText()
+	{
+		if (textFont == nullptr)
+			return;
+
+		auto& atlas = textFont->atlas;
+		auto quadsLength = static_cast<glm::uint32>(textVertices.size() / 4);
+
+		if (quadsLength > 0)
+		{
+			glm::uint32 vI;
+			glm::uint32 iI;
+			glm::uint32 quadsId = texturedGeometry.AllocateQuads(quadsLength, &vI, &iI);
+
+			for (glm::uint32 i = 0; i < quadsLength; i++)
+				texturedGeometry.PushQuadTo(vI, iI, i, &textVertices[i * 4]);
+
+			UseAtlas(atlas);
+
+			DrawingReference ref;
+			ref.Layer = currentLayer;
+			ref.GeometryRef = quadsId;
+			ref.TextureRef = atlas.Name();
+			ref.GlyphAtlas = &atlas;
+			ref.Type = textFont->DistanceField ? CommandType::TextureDistanceField : CommandType::TextureMask;
+			ref.ColorA = textColorA;
+			ref.ColorB = textColorB;
+			ref.Context = this;
+			ref.Buffer = &texturedGeometry;
+			ref.Bounds = textBounds;
+			cmdVector.emplace_back(ref);
+		}
+
+		textFont = nullptr;
+		textVertices.clear();
+	}
+
+	void WindowContext::DrawTextRun(const AtlasFont& font, const TextRun& run, const glm::vec4& bounds, TextAligment xAlign, TextAligment yAlign, const Brush* brush)
+	{
+		BeginText(font, brush);
+		PushText(run, bounds, xAlign, yAlign);
+		CommitText();
+	}
+
+	void WindowContext::DrawNumber(NumberGlyphs& glyphs, const NumberText& text, const glm::vec4& bounds, TextAligment xAlign, TextAligment yAlign, float_t size, const Brush* brush)
+	{
+		BeginText(glyphs.Font(), brush);
+		PushNumber(glyphs, text, bounds, xAlign, yAlign, size);
+		CommitText();
+	}
+
+	void WindowContext::DrawTextView(TextView& view, const glm::dvec2& scroll, const Brush* brush)
+	{
+		auto clip = ClipArea();
+
+		if (clip.x >= clip.z || clip.y >= clip.w)
+			return;
+
+		// Lines are placed in double precision; at float precision the lines of a large file would overlap.
+		auto lineHeight = static_cast<double_t>(view.LineHeight());
+		auto top = scroll.y + (clip.y - area.y);
+		auto bottom = scroll.y + (clip.w - area.y);
+
+		auto first = static_cast<size_t>(glm::max(0.0, glm::floor(top / lineHeight)));
+		auto last = static_cast<size_t>(glm::max(0.0, glm::ceil(bottom / lineHeight)));
+
+		const auto& lines = view.Layout(first, last);
+
+		BeginText(view.Font(), brush);
+
+		for (const auto& line : lines)
+		{
+			auto baseline = static_cast<float_t>(static_cast<double_t>(line.Index) * lineHeight - scroll.y) + view.Ascender();
+			auto left = static_cast<float_t>(-scroll.x);
+
+			PushText(line.Run, glm::vec4(left, baseline - line.Run.Ascent, area.z - area.x, area.w - area.y), TextAligment::Near, TextAligment::Near);
+		}
+
+		CommitText();
+	}
+
+	void WindowContext::DrawLineLayout(LineLayout& layout, const Brush* brush)
+	{
+		auto clip = ClipArea();
+
+		if (clip.x >= clip.z || clip.y >= clip.w)
+			return;
+
+		Modified = true;
+
+		// Quads are patched before the buffer is uploaded, and only when the context moved or lines were laid out again.
+		layout.Origin(glm::vec2(area.x, area.y));
+		layout.Refresh();
+
+		if (layout.Empty())
+			return;
+
+		auto top = area.y + layout.Position().y - layout.Ascender();
+		auto bottom = top + static_cast<float_t>(layout.CountOfLines()) * layout.LineHeight();
+		auto bounds = glm::vec4(clip.x, glm::max(top, clip.y), clip.z, glm::min(bottom, clip.w));
+
+		if (bounds.y >= bounds.w)
+			return;
+
+		//
+		// Glyphs are written once with a weight of 1, so the brush lends a single color, that of its top left corner.
+		//
+		glm::uint32 color = 0xFFFFFFFF;
+
+		if (brush->Type != BrushType::Texture)
+		{
+			const auto* colorBrush = reinterpret_cast<const ColorBrush*>(brush);
+			color = glm::packUnorm4x8(glm::mix(glm::unpackUnorm4x8(colorBrush->ColorA), glm::unpackUnorm4x8(colorBrush->ColorB), colorBrush->Weights.x));
+		}
+
+		auto& atlas = layout.Font().atlas;
+		UseAtlas(atlas);
+
+		DrawingReference ref;
+		ref.Layer = currentLayer;
+		ref.GeometryRef = DrawingReference::WholeBuffer;
+		ref.TextureRef = atlas.Name();
+		ref.GlyphAtlas = &atlas;
+		ref.Type = layout.Font().DistanceField ? CommandType::TextureDistanceField : CommandType::TextureMask;
+		ref.ColorA = color;
+		ref.ColorB = color;
+		ref.Context = this;
+		ref.Buffer = &layout.Buffer();
+		ref.Bounds = bounds;
+		ref.Scissored = true;
+		cmdVector.emplace_back(ref);
+	}
+}
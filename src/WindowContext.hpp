@@ -1,21 +1,75 @@
 #pragma once
 
 #include "Windows.hpp"
+#include "TextRun.hpp"
 
 namespace kodogl
 {
+	class Window;
+	class Series;
+	class TextView;
+	class LineLayout;
+	class NumberGlyphs;
+	struct NumberText;
+
 	class WindowContext
 	{
 		friend class Window;
 
+		//
+		// A quad in window coordinates together with its visible part.
+		//
+		struct ClippedQuad
+		{
+			glm::vec4 Quad;
+			glm::vec4 Clipped;
+		};
+
 		glm::vec4 area;
 
+		Window& window;
+
 		GLubyte currentLayer = 0;
 
 		VertexBuffer<Vertex2f1f>& dynamicColoredGeometry;
-		VertexBuffer<Vertex2f2f1f>& texturedGeometry;
+		VertexBuffer<Vertex2f3f1f>& texturedGeometry;
+		LineBuffer& lineGeometry;
 		std::vector<DrawingReference>& cmdVector;
 
+		// Context-owned staging area handed out by MapQuads, expanded by CommitQuads.
+		std::vector<glm::vec4> mappedQuads;
+		const Brush* mappedBrush = nullptr;
+
+		// Scratch storage for the quads surviving culling.
+		std::vector<ClippedQuad> clippedQuads;
+		// Scratch storage for decimated series points.
+		std::vector<glm::vec2> seriesPoints;
+
+		// Text batched by BeginText, in window coordinates, drawn by CommitText.
+		std::vector<Vertex2f3f1f> textVertices;
+		const AtlasFont* textFont = nullptr;
+		glm::vec4 textWeights;
+		glm::uint32 textColorA;
+		glm::uint32 textColorB;
+		glm::vec4 textBounds;
+
+		glm::vec4 ClipArea() const;
+		bool Clip( const glm::vec4& quad, ClippedQuad& clipped ) const;
+		glm::uint32 CullQuads( const glm::vec4* quads, int quadsLength, glm::vec4& bounds );
+
+		void DrawColoredQuads( const ClippedQuad* quads, glm::uint32 quadsLength, const glm::vec4& bounds, const ColorBrush* colorBrush );
+		void DrawTexturedQuads( const ClippedQuad* quads, glm::uint32 quadsLength, const glm::vec4& bounds, const Brush* brush );
+
+		//
+		// Add the quads of glyphs at origin to the batch of text, clipped, with the brush spanning box.
+		//
+		void PushGlyphs( const Vertex2f3f1f* glyphVertices, size_t countOfVertices, const glm::vec2& origin, const glm::vec4& box );
+
+		//
+		// Have the glyphs rasterized into an atlas uploaded before the frame is drawn.
+		//
+		void UseAtlas( Atlas& atlas );
+
 	public:
 
 		bool Modified;
@@ -34,5 +88,50 @@ namespace kodogl
 
 		void DrawQuads( glm::vec4* quads, int quadsLength, const Brush* brush );
 		void DrawQuad( const glm::vec4& quad, const Brush* brush );
+		void DrawLineStrip( const glm::vec2* points, int pointsLength, glm::float32 width, const Brush* brush );
+
+		//
+		// Draw the samples of a series within (xFrom, xTo) and (yFrom, yTo) as a line strip spanning the area.
+		// X is in sample indices, in double so those of long series stay apart; the series is decimated to the pixel columns of the area.
+		//
+		void DrawSeries( Series& series, const glm::dvec2& xRange, const glm::vec2& yRange, glm::float32 width, const Brush* brush );
+
+		//
+		// Map a region of the context for the caller to write quadsLength quads into.
+		// The quads are drawn with the brush when CommitQuads is called.
+		//
+		glm::vec4* MapQuads( int quadsLength, const Brush* brush );
+		void CommitQuads();
+
+		//
+		// Start a batch of text drawn with a font and the colors of a brush. The runs pushed until CommitText
+		// share a single command, so text of a font and brush is drawn at once.
+		//
+		void BeginText( const AtlasFont& font, const Brush* brush );
+		//
+		// Add a run laid out with the font of the batch, aligned within bounds (left, top, right, bottom) of the context.
+		//
+		void PushText( const TextRun& run, const glm::vec4& bounds, TextAligment xAlign, TextAligment yAlign );
+		//
+		// Add a formatted number laid out with glyphs of the font of the batch, without a run, e.g. axis labels and readouts
+		// that change every frame. Size is the size to draw the number at, 0 for the size of the font.
+		//
+		void PushNumber( NumberGlyphs& glyphs, const NumberText& text, const glm::vec4& bounds, TextAligment xAlign, TextAligment yAlign, float_t size );
+		void CommitText();
+
+		void DrawTextRun( const AtlasFont& font, const TextRun& run, const glm::vec4& bounds, TextAligment xAlign, TextAligment yAlign, const Brush* brush );
+		void DrawNumber( NumberGlyphs& glyphs, const NumberText& text, const glm::vec4& bounds, TextAligment xAlign, TextAligment yAlign, float_t size, const Brush* brush );
+
+		//
+		// Draw the lines of a text view crossing the clip area, the area showing the text from scroll (x, y) in pixels on.
+		// Lines still visible since the last draw aren't laid out again.
+		//
+		void DrawTextView( TextView& view, const glm::dvec2& scroll, const Brush* brush );
+
+		//
+		// Draw a line layout at its position within the area, scissored to it. The layout's own buffer is drawn as it
+		// is, so a frame uploads only the quads edited since the last one. A gradient brush lends a single color.
+		//
+		void DrawLineLayout( LineLayout& layout, const Brush* brush );
 	};
 }
@@ -12,12 +12,18 @@ namespace kodogl
 		Color = 1,
 		Texture = 2,
 		TextureMask = 4,
+		Line = 8,
+		TextureDistanceField = 16,
 	};
 
 	class WindowContext;
+	class Atlas;
 
 	struct DrawingReference
 	{
+		// GeometryRef of commands drawing their whole buffer; items of buffers have keys from 1 on.
+		static constexpr glm::uint32 WholeBuffer = 0;
+
 		glm::uint32 GeometryRef;
 		glm::uint8 Layer;
 
@@ -31,16 +37,47 @@ namespace kodogl
 
 		glm::uint32 TextureRef;
 
+		// Atlas of text commands, which texture is only known once the glyphs of the frame are uploaded.
+		Atlas* GlyphAtlas;
+
+		// Bounding box of the command's geometry, in window coordinates. Unbounded unless set, so it's never culled.
+		glm::vec4 Bounds;
+
+		// Width of the geometry, for line commands.
+		glm::float32 Width;
+
+		// Whether the geometry isn't clipped on the CPU, so it's scissored to the area of its context.
+		bool Scissored;
+
 		DrawingReference() :
 			GeometryRef( 0 ),
 			TextureRef( 0 ),
+			GlyphAtlas( nullptr ),
 			Layer( 0 ),
 			Type( CommandType::None ),
 			Context( nullptr ),
 			Buffer( nullptr ),
 			ColorA( 0 ),
-			ColorB( 0 )
+			ColorB( 0 ),
+			Bounds( -FLT_MAX, -FLT_MAX, FLT_MAX, FLT_MAX ),
+			Width( 0.0f ),
+			Scissored( false )
+		{
+		}
+
+		//
+		// Indicates whether or not the other command draws with the same state, so the two can be drawn at once.
+		//
+		bool SharesState( const DrawingReference& other ) const
 		{
+			return Layer == other.Layer &&
+				Type == other.Type &&
+				Buffer == other.Buffer &&
+				TextureRef == other.TextureRef &&
+				ColorA == other.ColorA &&
+				ColorB == other.ColorB &&
+				Width == other.Width &&
+				Scissored == other.Scissored;
 		}
 
 		//
@@ -58,7 +95,7 @@ namespace kodogl
 			{
 				if (Type == other.Type)
 				{
-					if (Type == CommandType::Texture || Type == CommandType::TextureMask)
+					if ((Type == CommandType::Texture || Type == CommandType::TextureMask || Type == CommandType::TextureDistanceField) && TextureRef != other.TextureRef)
 					{
 						return TextureRef < other.TextureRef;
 					}
@@ -7,7 +7,15 @@
 #include "Shaders.hpp"
 #include "Shader.hpp"
 #include "Texture.h"
+#include "TextureManager.hpp"
 #include "Brush.hpp"
+#include "Series.hpp"
+#include "Atlas.hpp"
+#include "TextRun.hpp"
+#include "TextView.hpp"
+#include "LineLayout.hpp"
+#include "NumberGlyphs.hpp"
+#include "Benchmarks.hpp"
 
 #include "WindowContext.hpp"
 #include "Window.hpp"
@@ -18,8 +26,19 @@ using namespace kodogl;
 
 std::unique_ptr<Texture> tex;
 
+TextureManager textureManager;
+TextRunCache textRunCache;
+// Scratch storage for text converted from UTF-16.
+std::string utf8Text;
+
+std::vector<std::unique_ptr<AtlasLoader>> atlasLoaders;
+std::vector<std::unique_ptr<Atlas>> atlases;
+
 std::vector<std::unique_ptr<Brush>> brushes;
-std::vector<std::unique_ptr<Texture>> textures;
+std::vector<std::unique_ptr<Series>> series;
+std::vector<std::unique_ptr<TextView>> textViews;
+std::vector<std::unique_ptr<LineLayout>> lineLayouts;
+std::vector<std::unique_ptr<NumberGlyphs>> numberGlyphs;
 std::vector<std::unique_ptr<Window>> windows;
 
 typedef void(*KodoGLErrorCallback)(const char*);
@@ -97,6 +116,25 @@ void OnWindowSizeChanged(GLFWwindow* glfwWindow, int32_t width, int32_t height)
 	ToWindow(glfwWindow)->OnSizeChanged(width, height);
 }
 
+//
+// Alignment of text within its bounds: horizontal in the two low bits, vertical in the next two (0 near, 1 mid, 2 far).
+//
+static TextAligment HorizontalAlignment(int alignment) { return static_cast<TextAligment>(glm::clamp(alignment & 3, 0, 2)); }
+static TextAligment VerticalAlignment(int alignment) { return static_cast<TextAligment>(glm::clamp((alignment >> 2) & 3, 0, 2)); }
+
+//
+// Byte column of a line of a layout, of a column in UTF-16 code units.
+//
+static size_t Utf8Column(const LineLayout& layout, int line, int column)
+{
+	auto offset = Utf8Offset(layout.Text(static_cast<size_t>(line)), static_cast<size_t>(glm::max(0, column)));
+
+	if (offset == std::string::npos)
+		throw kodogl::exception("Column " + std::to_string(column) + " is out of range of line " + std::to_string(line) + ".");
+
+	return offset;
+}
+
 #define EXPORT __declspec(dllexport)
 
 extern "C"
@@ -118,6 +156,8 @@ extern "C"
 
 	EXPORT void KodoGLTerminate()
 	{
+		textureManager.Stop();
+
 		for (auto& window : windows)
 		{
 			glfwDestroyWindow(window->GLFWPointer());
@@ -221,8 +261,17 @@ extern "C"
 
 	EXPORT int KodoGLWindowShouldClose(Window* window) { return glfwWindowShouldClose(window->GLFWPointer()); }
 	EXPORT void KodoGLWindowDestroy(Window* window) { glfwDestroyWindow(window->GLFWPointer()); }
-	EXPORT void KodoGLWindowFrameBegin(Window* window) { window->BeginFrame(); }
-	EXPORT void KodoGLWindowFrameEnd(Window* window) { window->EndFrame(); }
+	EXPORT void KodoGLWindowFrameBegin(Window* window)
+	{
+		textureManager.BeginFrame();
+		window->BeginFrame();
+	}
+
+	EXPORT void KodoGLWindowFrameEnd(Window* window)
+	{
+		window->EndFrame();
+		textureManager.EndFrame();
+	}
 
 	// --------------------------------------------------------------------------------
 	//
@@ -240,19 +289,634 @@ extern "C"
 	EXPORT void KodoGLDrawingContextSetArea(WindowContext* ctx, glm::vec4 bounds) { ctx->Area(bounds); }
 	EXPORT void KodoGLDrawingContextDrawQuads(WindowContext* ctx, glm::vec4* quads, int quadsLength, Brush* brush) { ctx->DrawQuads(quads, quadsLength, brush); }
 	EXPORT void KodoGLDrawingContextDrawQuad(WindowContext* ctx, glm::vec4 quad, Brush* brush) { ctx->DrawQuad(quad, brush); }
+	EXPORT void KodoGLDrawingContextDrawLineStrip(WindowContext* ctx, const glm::vec2* points, int pointsLength, float width, Brush* brush) { ctx->DrawLineStrip(points, pointsLength, width, brush); }
+	EXPORT void KodoGLDrawingContextDrawSeries(WindowContext* ctx, Series* series, double xFrom, double xTo, float yFrom, float yTo, float width, Brush* brush)
+	{
+		ctx->DrawSeries(*series, glm::dvec2(xFrom, xTo), glm::vec2(yFrom, yTo), width, brush);
+	}
+
+
+	//
+	// Map a region for quadsLength quads, drawn with the brush by CommitQuads. Null when there are no quads to map,
+	// or when a region is mapped already and not committed.
+	//
+	EXPORT glm::vec4* KodoGLDrawingContextMapQuads(WindowContext* ctx, int quadsLength, Brush* brush)
+	{
+		if (quadsLength <= 0)
+			return nullptr;
+
+		try
+		{
+			return ctx->MapQuads(quadsLength, brush);
+		}
+		catch (const std::exception& e)
+		{
+			if (kodoglError)
+				kodoglError(e.what());
+
+			return nullptr;
+		}
+	}
+
+	EXPORT void KodoGLDrawingContextCommitQuads(WindowContext* ctx) { ctx->CommitQuads(); }
 	EXPORT void KodoGLDrawingContextPopLayer(WindowContext* ctx) { ctx->PopLayer(); }
 	EXPORT void KodoGLDrawingContexPushLayer(WindowContext* ctx) { ctx->PushLayer(); }
 
+	//
+	// Draw UTF-16 text, as C# holds it, laid out with a font and aligned within bounds. Runs laid out before are reused.
+	//
+	EXPORT void KodoGLDrawingContextDrawText(WindowContext* ctx, const AtlasFont* font, const char16_t* text, int textLength, glm::vec4 bounds, int alignment, Brush* brush)
+	{
+		try
+		{
+			utf8Text.clear();
+			AppendUtf8(text, static_cast<size_t>(glm::max(0, textLength)), utf8Text);
+
+			const auto& run = textRunCache.Get(*font, utf8Text);
+			ctx->DrawTextRun(*font, run, bounds, HorizontalAlignment(alignment), VerticalAlignment(alignment), brush);
+		}
+		catch (const std::exception& e)
+		{
+			if (kodoglError)
+				kodoglError(e.what());
+		}
+	}
+
+	//
+	// Draw UTF-8 text; text that isn't valid UTF-8 is reported and not drawn.
+	//
+	EXPORT void KodoGLDrawingContextDrawTextUtf8(WindowContext* ctx, const AtlasFont* font, const char* text, int textLength, glm::vec4 bounds, int alignment, Brush* brush)
+	{
+		try
+		{
+			const auto& run = textRunCache.Get(*font, text, static_cast<size_t>(glm::max(0, textLength)));
+			ctx->DrawTextRun(*font, run, bounds, HorizontalAlignment(alignment), VerticalAlignment(alignment), brush);
+		}
+		catch (const std::exception& e)
+		{
+			if (kodoglError)
+				kodoglError(e.what());
+		}
+	}
+
+	//
+	// Draw UTF-16 texts, one after another in text, each within its bounds, as a single command.
+	//
+	EXPORT void KodoGLDrawingContextDrawTexts(WindowContext* ctx, const AtlasFont* font, const char16_t* text, const int* textLengths, const glm::vec4* bounds, int textsLength, int alignment, Brush* brush)
+	{
+		try
+		{
+			ctx->BeginText(*font, brush);
+
+			for (auto i = 0; i < textsLength; i++)
+			{
+				auto textLength = static_cast<size_t>(glm::max(0, textLengths[i]));
+
+				utf8Text.clear();
+				AppendUtf8(text, textLength, utf8Text);
+				text += textLength;
+
+				ctx->PushText(textRunCache.Get(*font, utf8Text), bounds[i], HorizontalAlignment(alignment), VerticalAlignment(alignment));
+			}
+
+			ctx->CommitText();
+		}
+		catch (const std::exception& e)
+		{
+			// Draw the texts pushed so far, so the batch doesn't stay pending.
+			ctx->CommitText();
+
+			if (kodoglError)
+				kodoglError(e.what());
+		}
+	}
+
+	EXPORT void KodoGLDrawingContextDrawTextView(WindowContext* ctx, TextView* view, double scrollX, double scrollY, Brush* brush)
+	{
+		try
+		{
+			ctx->DrawTextView(*view, glm::dvec2(scrollX, scrollY), brush);
+		}
+		catch (const std::exception& e)
+		{
+			ctx->CommitText();
+
+			if (kodoglError)
+				kodoglError(e.what());
+		}
+	}
+
+	//
+	// Draw a number formatted with a format (fixed, scientific, engineering) and digits of precision after the decimal mark.
+	//
+	EXPORT void KodoGLDrawingContextDrawNumber(WindowContext* ctx, NumberGlyphs* glyphs, double value, int format, int precision, char16_t decimalMark, glm::vec4 bounds, int alignment, float size, Brush* brush)
+	{
+		try
+		{
+			if (!NumberGlyphs::DecimalMark(decimalMark))
+				throw kodogl::exception("The decimal mark of a number must be '.' or ','.");
+
+			auto text = NumberGlyphs::Format(value, static_cast<NumberFormat>(glm::clamp(format, 0, 2)), precision, static_cast<char>(decimalMark));
+			ctx->DrawNumber(*glyphs, text, bounds, HorizontalAlignment(alignment), VerticalAlignment(alignment), size, brush);
+		}
+		catch (const std::exception& e)
+		{
+			ctx->CommitText();
+
+			if (kodoglError)
+				kodoglError(e.what());
+		}
+	}
+
+	//
+	// Draw a whole number, e.g. a count or an index, with all its digits.
+	//
+	EXPORT void KodoGLDrawingContextDrawInteger(WindowContext* ctx, NumberGlyphs* glyphs, long long value, glm::vec4 bounds, int alignment, float size, Brush* brush)
+	{
+		try
+		{
+			auto text = NumberGlyphs::Format(static_cast<int64_t>(value));
+			ctx->DrawNumber(*glyphs, text, bounds, HorizontalAlignment(alignment), VerticalAlignment(alignment), size, brush);
+		}
+		catch (const std::exception& e)
+		{
+			ctx->CommitText();
+
+			if (kodoglError)
+				kodoglError(e.what());
+		}
+	}
+
+	EXPORT void KodoGLDrawingContextDrawLineLayout(WindowContext* ctx, LineLayout* layout, Brush* brush)
+	{
+		try
+		{
+			ctx->DrawLineLayout(*layout, brush);
+		}
+		catch (const std::exception& e)
+		{
+			if (kodoglError)
+				kodoglError(e.what());
+		}
+	}
+
 	// --------------------------------------------------------------------------------
 	//
 	// Texture exports.
 	//
 	// --------------------------------------------------------------------------------
 
+	//
+	// Block compress textures created from now on (BC4 for opacity, BC7 for colors), caching them in the directory.
+	// An empty directory compresses without caching; null turns compression off.
+	//
+	EXPORT void KodoGLTextureSetCompression(const char* cacheDirectory)
+	{
+		if (cacheDirectory != nullptr)
+			textureManager.Compression(std::make_shared<TextureCompressor>(cacheDirectory));
+		else
+			textureManager.Compression(nullptr);
+	}
+
+	//
+	// Limit the GPU memory used by textures, evicting those drawn least recently. 0 removes the limit.
+	//
+	EXPORT void KodoGLTextureSetBudget(long long bytes) { textureManager.Budget(static_cast<size_t>(glm::max(0ll, bytes))); }
+	EXPORT long long KodoGLTextureGetResidentSize() { return static_cast<long long>(textureManager.ResidentSize()); }
+
+	//
+	// Load a texture from a file, or from an image in memory. Null if it can't be decoded.
+	//
 	EXPORT Texture* KodoGLTextureCreate(const char* filename, int opacityOnly)
 	{
-		textures.emplace_back(std::make_unique<Texture>(filename, opacityOnly > 0));
-		return textures.back().get();
+		try
+		{
+			return textureManager.Create(filename, opacityOnly > 0);
+		}
+		catch (const std::exception& e)
+		{
+			if (kodoglError)
+				kodoglError(e.what());
+
+			return nullptr;
+		}
+	}
+
+	EXPORT Texture* KodoGLTextureCreateFromMemory(const void* data, int size, int opacityOnly)
+	{
+		try
+		{
+			if (data == nullptr || size <= 0)
+				throw TextureException("An image in memory must have data.");
+
+			return textureManager.Create(data, static_cast<size_t>(size), opacityOnly > 0);
+		}
+		catch (const std::exception& e)
+		{
+			if (kodoglError)
+				kodoglError(e.what());
+
+			return nullptr;
+		}
+	}
+
+	//
+	// Start loading a texture on a worker; see KodoGLTextureIsReady. Null if the load can't be queued.
+	//
+	EXPORT Texture* KodoGLTextureCreateAsync(const char* filename, int opacityOnly)
+	{
+		try
+		{
+			return textureManager.CreateAsync(filename, opacityOnly > 0);
+		}
+		catch (const std::exception& e)
+		{
+			if (kodoglError)
+				kodoglError(e.what());
+
+			return nullptr;
+		}
+	}
+
+	EXPORT void KodoGLTextureDestroy(Texture* texture) { textureManager.Destroy(texture); }
+
+	//
+	// 1 when the texture is ready, 0 while it is loading (or evicted) and -1 if loading failed.
+	//
+	EXPORT int KodoGLTextureIsReady(Texture* texture)
+	{
+		switch (texture->State())
+		{
+			case TextureState::Ready:
+				return 1;
+			case TextureState::Failed:
+				return -1;
+			default:
+				return 0;
+		}
+	}
+
+	// --------------------------------------------------------------------------------
+	//
+	// Text exports.
+	//
+	// --------------------------------------------------------------------------------
+
+	//
+	// Limit the number of laid out text runs kept for reuse, dropping those drawn least recently.
+	//
+	EXPORT void KodoGLTextCacheSetCapacity(int runs) { textRunCache.Capacity(static_cast<size_t>(glm::max(1, runs))); }
+	EXPORT long long KodoGLTextCacheGetHits() { return static_cast<long long>(textRunCache.Hits()); }
+	EXPORT long long KodoGLTextCacheGetMisses() { return static_cast<long long>(textRunCache.Misses()); }
+
+	// --------------------------------------------------------------------------------
+	//
+	// Atlas exports.
+	//
+	// --------------------------------------------------------------------------------
+
+	//
+	// Start loading fonts into an atlas of pages of the specified size, cached in a directory unless it's null or empty.
+	//
+	EXPORT AtlasLoader* KodoGLAtlasLoaderCreate(int width, int height, const char* cacheDirectory)
+	{
+		atlasLoaders.emplace_back(std::make_unique<AtlasLoader>(static_cast<size_t>(width), static_cast<size_t>(height), true, cacheDirectory != nullptr ? cacheDirectory : ""));
+		return atlasLoaders.back().get();
+	}
+
+	//
+	// Load a font file, or the embedded Patua One when the filename is null, returning its name within the atlas, or -1.
+	// The charset is rasterized up front, other glyphs on first use.
+	//
+	EXPORT int KodoGLAtlasLoaderLoadFont(AtlasLoader* loader, const char* filename, float size, const char* charset, int distanceField)
+	{
+		try
+		{
+			std::string chars = charset != nullptr ? charset : "";
+
+			if (filename == nullptr)
+			{
+				return static_cast<int>(distanceField
+										? loader->LoadDistanceField(PatuaOneDotTTF, sizeof(PatuaOneDotTTF), size, chars)
+										: loader->Load(PatuaOneDotTTF, sizeof(PatuaOneDotTTF), size, chars));
+			}
+
+			return static_cast<int>(distanceField
+									? loader->LoadDistanceField(std::string(filename), size, chars)
+									: loader->Load(std::string(filename), size, chars));
+		}
+		catch (const std::exception& e)
+		{
+			if (kodoglError)
+				kodoglError(e.what());
+
+			return -1;
+		}
+	}
+
+	//
+	// Finish the atlas of a loader, which is destroyed. Null if the fonts couldn't be rasterized.
+	//
+	EXPORT Atlas* KodoGLAtlasLoaderFinish(AtlasLoader* loader)
+	{
+		auto found = std::find_if(atlasLoaders.begin(), atlasLoaders.end(), [loader](const std::unique_ptr<AtlasLoader>& l) { return l.get() == loader; });
+
+		if (found == atlasLoaders.end())
+			return nullptr;
+
+		std::unique_ptr<Atlas> atlas;
+
+		try
+		{
+			atlas = loader->Finish();
+		}
+		catch (const std::exception& e)
+		{
+			if (kodoglError)
+				kodoglError(e.what());
+		}
+
+		atlasLoaders.erase(found);
+
+		if (!atlas)
+			return nullptr;
+
+		atlases.emplace_back(std::move(atlas));
+		return atlases.back().get();
+	}
+
+	//
+	// A font of an atlas by the name KodoGLAtlasLoaderLoadFont returned for it. Null if the atlas has no such font.
+	//
+	EXPORT const AtlasFont* KodoGLAtlasGetFont(Atlas* atlas, int font)
+	{
+		try
+		{
+			if (font < 0)
+				throw AtlasException("Font " + std::to_string(font) + " isn't in the atlas.");
+
+			return &atlas->Get(static_cast<GLuint>(font));
+		}
+		catch (const std::exception& e)
+		{
+			if (kodoglError)
+				kodoglError(e.what());
+
+			return nullptr;
+		}
+	}
+
+	//
+	// Limit the memory used by the pages of an atlas, clearing those drawn least recently. 0 removes the limit.
+	//
+	EXPORT void KodoGLAtlasSetBudget(Atlas* atlas, long long bytes) { atlas->Budget(static_cast<size_t>(glm::max(0ll, bytes))); }
+
+	// --------------------------------------------------------------------------------
+	//
+	// Series exports.
+	//
+	// --------------------------------------------------------------------------------
+
+	//
+	// Create a series from a copy of the values. Null if the length is negative.
+	//
+	EXPORT Series* KodoGLSeriesCreate(const float* values, int valuesLength)
+	{
+		try
+		{
+			if (valuesLength < 0 || (values == nullptr && valuesLength > 0))
+				throw kodogl::exception("A series must have a length that isn't negative.");
+
+			series.emplace_back(std::make_unique<Series>(values, static_cast<size_t>(valuesLength)));
+			return series.back().get();
+		}
+		catch (const std::exception& e)
+		{
+			if (kodoglError)
+				kodoglError(e.what());
+
+			return nullptr;
+		}
+	}
+
+	//
+	// Replace the values of a series. A negative length is reported and leaves the values as they are.
+	//
+	EXPORT void KodoGLSeriesUpdate(Series* s, const float* values, int valuesLength)
+	{
+		try
+		{
+			if (valuesLength < 0 || (values == nullptr && valuesLength > 0))
+				throw kodogl::exception("A series must have a length that isn't negative.");
+
+			s->Update(values, static_cast<size_t>(valuesLength));
+		}
+		catch (const std::exception& e)
+		{
+			if (kodoglError)
+				kodoglError(e.what());
+		}
+	}
+
+	// --------------------------------------------------------------------------------
+	//
+	// Text view exports.
+	//
+	// --------------------------------------------------------------------------------
+
+	//
+	// Open a UTF-8 text file in a view, its lines indexed in the background. Null if the file can't be mapped, e.g. when it's missing or empty.
+	//
+	EXPORT TextView* KodoGLTextViewCreate(const char* filename, const AtlasFont* font, float size)
+	{
+		try
+		{
+			auto view = std::make_unique<TextView>(filename, *font, size);
+
+			if (!view->IsOpen())
+				throw kodogl::exception(std::string("Can't open ") + filename + ".");
+
+			textViews.emplace_back(std::move(view));
+			return textViews.back().get();
+		}
+		catch (const std::exception& e)
+		{
+			if (kodoglError)
+				kodoglError(e.what());
+
+			return nullptr;
+		}
+	}
+
+	EXPORT void KodoGLTextViewDestroy(TextView* view)
+	{
+		auto found = std::find_if(textViews.begin(), textViews.end(), [view](const std::unique_ptr<TextView>& v) { return v.get() == view; });
+
+		if (found != textViews.end())
+			textViews.erase(found);
+	}
+
+	//
+	// Lines indexed so far, and whether all are; -1 when the view can't be queried.
+	//
+	EXPORT long long KodoGLTextViewCountOfLines(TextView* view)
+	{
+		try
+		{
+			return static_cast<long long>(view->CountOfLines());
+		}
+		catch (const std::exception& e)
+		{
+			if (kodoglError)
+				kodoglError(e.what());
+
+			return -1;
+		}
+	}
+
+	EXPORT int KodoGLTextViewIndexed(TextView* view)
+	{
+		try
+		{
+			return view->Indexed() ? 1 : 0;
+		}
+		catch (const std::exception& e)
+		{
+			if (kodoglError)
+				kodoglError(e.what());
+
+			return -1;
+		}
+	}
+
+	EXPORT float KodoGLTextViewLineHeight(TextView* view) { return view->LineHeight(); }
+
+	// --------------------------------------------------------------------------------
+	//
+	// Number glyph exports.
+	//
+	// --------------------------------------------------------------------------------
+
+	//
+	// The glyphs numbers are drawn with in a font, looked up once rather than per number.
+	//
+	EXPORT NumberGlyphs* KodoGLNumberGlyphsCreate(const AtlasFont* font)
+	{
+		try
+		{
+			if (font == nullptr)
+				throw kodogl::exception("Number glyphs need a font.");
+
+			numberGlyphs.emplace_back(std::make_unique<NumberGlyphs>(*font));
+			return numberGlyphs.back().get();
+		}
+		catch (const std::exception& e)
+		{
+			if (kodoglError)
+				kodoglError(e.what());
+
+			return nullptr;
+		}
+	}
+
+	EXPORT void KodoGLNumberGlyphsDestroy(NumberGlyphs* glyphs)
+	{
+		auto found = std::find_if(numberGlyphs.begin(), numberGlyphs.end(), [glyphs](const std::unique_ptr<NumberGlyphs>& g) { return g.get() == glyphs; });
+
+		if (found != numberGlyphs.end())
+			numberGlyphs.erase(found);
+	}
+
+	// --------------------------------------------------------------------------------
+	//
+	// Line layout exports.
+	//
+	// --------------------------------------------------------------------------------
+
+	//
+	// Lay out UTF-16 text for editing, the pen starting at (x, y) within the area it's drawn in. Size is the size to draw
+	// the text at, 0 for the size of the font. Creates a vertex buffer, so the GL context of a window must be current.
+	//
+	EXPORT LineLayout* KodoGLLineLayoutCreate(const AtlasFont* font, const char16_t* text, int textLength, float x, float y, float size)
+	{
+		try
+		{
+			utf8Text.clear();
+			AppendUtf8(text, static_cast<size_t>(glm::max(0, textLength)), utf8Text);
+
+			lineLayouts.emplace_back(std::make_unique<LineLayout>(utf8Text, *font, glm::vec2(x, y), size));
+			return lineLayouts.back().get();
+		}
+		catch (const std::exception& e)
+		{
+			if (kodoglError)
+				kodoglError(e.what());
+
+			return nullptr;
+		}
+	}
+
+	EXPORT void KodoGLLineLayoutDestroy(LineLayout* layout)
+	{
+		auto found = std::find_if(lineLayouts.begin(), lineLayouts.end(), [layout](const std::unique_ptr<LineLayout>& l) { return l.get() == layout; });
+
+		if (found != lineLayouts.end())
+			lineLayouts.erase(found);
+	}
+
+	EXPORT int KodoGLLineLayoutCountOfLines(LineLayout* layout) { return static_cast<int>(layout->CountOfLines()); }
+
+	//
+	// Edits of a layout; columns are in UTF-16 code units. Edits out of range are reported and leave the text as it is.
+	//
+	EXPORT void KodoGLLineLayoutInsert(LineLayout* layout, int line, int column, const char16_t* text, int textLength)
+	{
+		try
+		{
+			auto byteColumn = Utf8Column(*layout, line, column);
+
+			utf8Text.clear();
+			AppendUtf8(text, static_cast<size_t>(glm::max(0, textLength)), utf8Text);
+
+			layout->Insert(static_cast<size_t>(line), byteColumn, utf8Text);
+		}
+		catch (const std::exception& e)
+		{
+			if (kodoglError)
+				kodoglError(e.what());
+		}
+	}
+
+	EXPORT void KodoGLLineLayoutAppend(LineLayout* layout, const char16_t* text, int textLength)
+	{
+		try
+		{
+			utf8Text.clear();
+			AppendUtf8(text, static_cast<size_t>(glm::max(0, textLength)), utf8Text);
+
+			layout->Append(utf8Text);
+		}
+		catch (const std::exception& e)
+		{
+			if (kodoglError)
+				kodoglError(e.what());
+		}
+	}
+
+	EXPORT void KodoGLLineLayoutErase(LineLayout* layout, int line, int column, int endLine, int endColumn)
+	{
+		try
+		{
+			auto byteColumn = Utf8Column(*layout, line, column);
+			auto endByteColumn = Utf8Column(*layout, endLine, endColumn);
+
+			layout->Erase(static_cast<size_t>(line), byteColumn, static_cast<size_t>(endLine), endByteColumn);
+		}
+		catch (const std::exception& e)
+		{
+			if (kodoglError)
+				kodoglError(e.what());
+		}
 	}
 
 	// --------------------------------------------------------------------------------
@@ -274,6 +938,73 @@ extern "C"
 		brushes.emplace_back(std::move(newBrush));
 		return brushes.back().get();
 	}
+
+	EXPORT Brush* KodoGLBrushCreateTexture(Texture* texture)
+	{
+		auto newBrush = std::make_unique<TextureBrush>(texture);
+		brushes.emplace_back(std::move(newBrush));
+		return brushes.back().get();
+	}
+
+	EXPORT Brush* KodoGLBrushCreateTextureMask(Texture* mask, glm::vec4 color)
+	{
+		auto newBrush = std::make_unique<TextureMaskBrush>(mask, color);
+		brushes.emplace_back(std::move(newBrush));
+		return brushes.back().get();
+	}
+
+	// --------------------------------------------------------------------------------
+	//
+	// Benchmark exports.
+	//
+	// --------------------------------------------------------------------------------
+
+	//
+	// Pack glyphs of random sizes into a page of the glyph atlas; see BenchmarkPacking. Returns the number of glyphs packed,
+	// their packing time, efficiency and the nodes of the skyline at most, or -1 on failure.
+	//
+	EXPORT int KodoGLBenchmarkPacking(int countOfGlyphs, int sizeOfPage, int sortedByHeight, double* seconds, double* efficiency, int* mostNodes)
+	{
+		try
+		{
+			auto result = BenchmarkPacking(static_cast<size_t>(glm::max(0, countOfGlyphs)), static_cast<size_t>(glm::max(3, sizeOfPage)), sortedByHeight != 0);
+
+			*seconds = result.Seconds;
+			*efficiency = result.Efficiency;
+			*mostNodes = static_cast<int>(result.MostNodes);
+			return static_cast<int>(result.Packed);
+		}
+		catch (const std::exception& e)
+		{
+			if (kodoglError)
+				kodoglError(e.what());
+
+			return -1;
+		}
+	}
+
+	//
+	// Seconds to convert an image of random pixels with 1-4 channels to the opacity or to RGBA, as the texture loader does,
+	// on average over a number of repeats; -1 on failure.
+	//
+	EXPORT double KodoGLBenchmarkConversion(int width, int height, int channels, int onlyOpacity, int repeats)
+	{
+		try
+		{
+			if (width <= 0 || height <= 0 || channels < 1 || channels > 4)
+				throw kodogl::exception("An image to convert must have a size and 1 to 4 channels.");
+
+			return BenchmarkConversion(static_cast<glm::uint32>(width), static_cast<glm::uint32>(height), static_cast<glm::uint32>(channels),
+				onlyOpacity != 0 ? gl::R8 : gl::RGBA8, static_cast<glm::uint32>(glm::max(1, repeats)));
+		}
+		catch (const std::exception& e)
+		{
+			if (kodoglError)
+				kodoglError(e.what());
+
+			return -1.0;
+		}
+	}
 }
 
 BOOL WINAPI DllMain(HINSTANCE hinstDLL, DWORD fdwReason, LPVOID lpReserved)
@@ -9,6 +9,7 @@
 #include <memory>
 #include <unordered_map>
 #include <cassert>
+#include <cfloat>
 
 #pragma comment (lib, "opengl32")
 #include <gl_core_4_4.hpp>